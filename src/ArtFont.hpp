@@ -2,7 +2,7 @@
  * \file    	ArtFont.hpp
  * \author  	XY0797
  * \date    	2024.8.6
- * \brief		定义AC、WA、TLE、MLE、Start Failed的艺术字
+ * \brief		定义AC、WA、TLE、MLE、OLE、Start Failed的艺术字
  */
 #ifndef _XY0797_ARTFONT
 #define _XY0797_ARTFONT 1
@@ -43,6 +43,15 @@ const std::string artMLE
       " / /|_/ // /__ / _/  \n"
       "/_/  /_//____//___/  ";
 
+// 紫色字体
+const std::string artOLE
+    = "\x1b[1;35;49m"
+      "  ____   __    ____\n"
+      " / __ \\ / /   / __/\n"
+      "/ /_/ // /__ / _/  \n"
+      "\\____//____//___/  "
+      "\x1b[0m";
+
 // 蓝色字体
 const std::string artStartFailed
     = "\x1b[1;34;49m"
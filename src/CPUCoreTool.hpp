@@ -0,0 +1,108 @@
+/**
+ * \file    	CPUCoreTool.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		获取CPU物理核心信息，为并行评测分配核心
+ */
+#ifndef _XY0797_CPUCORETOOL
+#define _XY0797_CPUCORETOOL 1
+
+#include <set>
+#include <vector>
+#include <thread>
+#include <string>
+#include <fstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+namespace cpucore {
+	// 检测每个物理核心的第一个逻辑CPU序号，只应由getPhysicalCoreCPUs调用
+	std::vector<int> detectPhysicalCoreCPUs() {
+		std::vector<int> coreCPUs;
+#ifdef _WIN32
+		DWORD len = 0;
+		GetLogicalProcessorInformation(NULL, &len);
+		std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infoList(
+		    len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) + 1);
+		if (len != 0 && GetLogicalProcessorInformation(infoList.data(), &len)) {
+			infoList.resize(len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+			for (const auto& e : infoList) {
+				if (e.Relationship != RelationProcessorCore) {
+					continue;
+				}
+				// 取掩码最低位对应的逻辑CPU
+				for (int i = 0; i < 64; ++i) {
+					if ((static_cast<unsigned long long>(e.ProcessorMask) >> i) & 1ull) {
+						coreCPUs.push_back(i);
+						break;
+					}
+				}
+			}
+		}
+#else
+		// 读取sysfs中的拓扑信息，同一(物理封装, 核心)只取第一个逻辑CPU
+		// 只考虑本进程允许使用的逻辑CPU
+		cpu_set_t allowedSet;
+		CPU_ZERO(&allowedSet);
+		if (sched_getaffinity(0, sizeof(allowedSet), &allowedSet) == 0) {
+			std::set<std::pair<long long, long long>> coreSet;
+			for (int i = 0; i < CPU_SETSIZE; ++i) {
+				if (!CPU_ISSET(i, &allowedSet)) {
+					continue;
+				}
+				std::string topoPath = "/sys/devices/system/cpu/cpu"
+				                       + std::to_string(i) + "/topology/";
+				long long packageID = -1, coreID = -1;
+				std::ifstream packageFile(topoPath + "physical_package_id");
+				std::ifstream coreFile(topoPath + "core_id");
+				if (!(packageFile >> packageID) || !(coreFile >> coreID)) {
+					// 读取失败，当作单独的核心
+					packageID = -1;
+					coreID = i;
+				}
+				if (coreSet.insert(std::make_pair(packageID, coreID)).second) {
+					coreCPUs.push_back(i);
+				}
+			}
+		}
+#endif
+		if (coreCPUs.empty()) {
+			// 获取失败，把每个逻辑CPU当作一个物理核心
+			int cnt = static_cast<int>(std::thread::hardware_concurrency());
+			for (int i = 0; i < cnt || i == 0; ++i) {
+				coreCPUs.push_back(i);
+			}
+		}
+		return coreCPUs;
+	}
+
+	// 获取每个物理核心的第一个逻辑CPU序号
+	// 超线程的兄弟逻辑CPU不会出现在结果中
+	// 各评测线程会同时首次调用，借助静态局部变量的线程安全初始化只检测一次
+	const std::vector<int>& getPhysicalCoreCPUs() {
+		static const std::vector<int> coreCPUs = detectPhysicalCoreCPUs();
+		return coreCPUs;
+	}
+
+	// 默认的并行评测线程数：物理核心数-1，至少为1
+	// 留出一个核心给评测程序自身的读写线程
+	int getDefaultWorkerCnt() {
+		int cnt = static_cast<int>(getPhysicalCoreCPUs().size()) - 1;
+		return cnt < 1 ? 1 : cnt;
+	}
+
+	// 获取第workerID个评测线程应绑定的逻辑CPU序号
+	// 多于一个物理核心时跳过第一个核心，线程数超过核心数时循环分配
+	int getWorkerCPU(int workerID) {
+		const std::vector<int>& coreCPUs = getPhysicalCoreCPUs();
+		if (coreCPUs.size() == 1) {
+			return coreCPUs[0];
+		}
+		return coreCPUs[1 + workerID % (coreCPUs.size() - 1)];
+	}
+}
+
+#endif /* _XY0797_CPUCORETOOL */
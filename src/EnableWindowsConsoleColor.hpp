@@ -7,9 +7,13 @@
 #ifndef _XY0797_ENABLEWINDOWSCONSOLECOLOR
 #define _XY0797_ENABLEWINDOWSCONSOLECOLOR 1
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
+// POSIX下的终端默认支持彩色显示，直接返回true
 bool EnableWindowsConsoleColor() {
+#ifdef _WIN32
 	HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
 	if (hOut == INVALID_HANDLE_VALUE) {
 		return false;
@@ -25,6 +29,7 @@ bool EnableWindowsConsoleColor() {
 		return false;
 	}
 
+#endif
 	return true;
 }
 
@@ -0,0 +1,369 @@
+/**
+ * \file    	JudgeOptions.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		解析命令行选项，交互式输入之外的评测配置都在这里
+ */
+#ifndef _XY0797_JUDGEOPTIONS
+#define _XY0797_JUDGEOPTIONS 1
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <exception>
+#include <cstdlib>
+
+// 未指定--worker-token时读取令牌的环境变量，避免令牌出现在进程的命令行中
+const char* const WORKER_TOKEN_ENV = "LOCALOJ_WORKER_TOKEN";
+
+// 样例的执行顺序，显示顺序总是按文件名排序
+enum JudgeOrder {
+	// 按文件名顺序
+	ORDER_NAME,
+	// 上一次未通过的样例优先，尽快得知修改是否有效
+	ORDER_FAILED_FIRST,
+	// 输入文件大的样例优先(最长处理时间优先)，缩短并行评测的总用时
+	ORDER_LPT
+};
+
+struct JudgeOptions {
+	// 并行评测的线程数，0表示默认值(物理核心数-1)
+	int workerCnt = 0;
+	// 是否把待测程序绑定到各个评测线程的核心
+	bool pinCPU = true;
+	// 是否在程序运行期间比较输出，确定WA后立即结束程序
+	bool isStreamCmp = true;
+	// 输出限制(MB)
+	long long outputLimitMB = 256;
+	// 内存限制(MB)，0表示不限制
+	long long memoryLimitMB = 0;
+	// 基准测试模式下每个样例计时的运行次数，0表示不进行基准测试
+	int benchRuns = 0;
+	// 基准测试模式下每个样例计时前的预热运行次数
+	int benchWarmup = 1;
+	// A/B对比模式下的新程序路径，为空表示不进行对比
+	std::string abExePath;
+	// 是否通过管道写入输入，否则直接把输入文件作为待测程序的标准输入
+	bool isPipeInput = false;
+	// 是否统计硬件性能计数器
+	bool isPerf = false;
+	// checker(特判程序)的路径，为空则使用内置的比较
+	std::string checkerPath;
+	// checker插件(动态库)的路径，为空则不使用插件
+	std::string checkerLibPath;
+	// 是否按单词比较，忽略空白字符的差异
+	bool isTokenCmp = false;
+	// 按单词比较时浮点数的绝对误差与相对误差
+	double absEps = 0;
+	double relEps = 0;
+	// 是否使用标准答案摘要索引，摘要一致时不读取标准答案
+	bool isDigest = false;
+	// 重复上一次的评测时是否不使用缓存的结果，重新评测全部样例
+	bool isForce = false;
+	// 样例的执行顺序
+	JudgeOrder judgeOrder = ORDER_NAME;
+	// WA时是否按行对齐列出各处差异，需要完整的输出，因此不进行流式比较
+	bool isLineDiff = false;
+	// 守护进程监听的本地套接字路径(Windows下为命名管道名)，为空表示交互式评测
+	std::string daemonPath;
+	// 作为分布式评测的评测机时监听的地址，为空表示不作为评测机
+	std::string workerListenAddr;
+	// 分布式评测时各评测机的地址，为空表示在本机评测
+	std::vector<std::string> workerAddrList;
+	// 评测机与协调端共用的令牌，分布式评测时必须指定
+	std::string workerToken;
+};
+
+JudgeOptions m_Options;
+
+// 打印命令行选项说明
+void printJudgeOptionsHelp() {
+	std::cout << "命令行选项：" << std::endl
+	          << "  -j N         并行评测的线程数，默认为物理核心数-1" << std::endl
+	          << "  --no-pin     不把待测程序绑定到固定核心" << std::endl
+	          << "  --no-stream  程序结束后再比较输出，不提前结束WA的程序" << std::endl
+	          << "  --ol N       输出限制(MB)，默认256" << std::endl
+	          << "  --ml N       内存限制(MB)，默认不限制" << std::endl
+	          << "  --bench N    基准测试模式，每个样例计时运行N次并统计" << std::endl
+	          << "  --warmup N   基准测试模式下计时前的预热次数，默认1" << std::endl
+	          << "  --ab EXE     A/B对比模式，交替运行输入的程序(A)与EXE(B)并比较用时" << std::endl
+	          << "               运行次数由--bench指定，默认10" << std::endl
+	          << "  --pipe-input 通过管道写入输入，不直接把输入文件交给程序" << std::endl
+	          << "               压缩的输入(.gz与.zip中的文件)总是边解压边通过管道写入" << std::endl
+	          << "  --perf       统计每个样例的硬件性能计数器" << std::endl
+	          << "  --checker EXE 使用testlib兼容的checker判定结果" << std::endl
+	          << "  --checker-lib LIB 在评测进程内加载checker插件判定结果" << std::endl
+	          << "  --token      按单词比较，忽略空白字符的差异" << std::endl
+	          << "  --abs-eps E  按单词比较时浮点数的绝对误差" << std::endl
+	          << "  --rel-eps E  按单词比较时浮点数的相对误差" << std::endl
+	          << "  --digest     使用测试集目录下的标准答案摘要索引，输出摘要一致时不读取标准答案" << std::endl
+	          << "  --order P    样例的执行顺序，显示顺序不变：name按文件名(默认)，" << std::endl
+	          << "               failed上一次未通过的优先，lpt输入文件大的优先" << std::endl
+	          << "  --force      重复上一次的评测时不使用缓存的结果，重新评测全部样例" << std::endl
+	          << "  --line-diff  WA时按行对齐列出各处差异，包含--no-stream" << std::endl
+	          << "  --daemon PATH 作为守护进程运行，在本地套接字PATH(Windows下为命名管道)上" << std::endl
+	          << "               接收JSON评测任务，每行一个，各样例的结果完成后立即返回" << std::endl
+	          << "               例如：{\"id\":\"1\",\"tests\":\"data\",\"exe\":\"a.exe\",\"timeLimit\":1000}" << std::endl
+	          << "  --worker ADDR 作为分布式评测的评测机运行，在ADDR(主机:端口)上接受协调端的连接" << std::endl
+	          << "               只写端口时只接受本机的连接，允许其它主机连接请写0.0.0.0:端口" << std::endl
+	          << "  --workers ADDR,ADDR,... 由这些评测机评测样例，本机只负责分配与汇总" << std::endl
+	          << "               评测机失联时其样例自动改由其它评测机评测" << std::endl
+	          << "  --worker-token T 评测机与协调端共用的令牌，--worker与--workers都必须指定" << std::endl
+	          << "               也可以通过环境变量" << WORKER_TOKEN_ENV << "指定" << std::endl
+	          << "               评测机会运行协调端发来的任意程序，且令牌与文件都以明文传输，" << std::endl
+	          << "               其端口只能在可信的网络中开放，不能暴露在公网上" << std::endl
+	          << "  -h, --help   显示本说明" << std::endl;
+}
+
+// 解析命令行选项到m_Options，失败时返回false并把原因写在errMsg里面
+// 遇到-h时返回false且errMsg为空
+bool parseJudgeOptions(int argc, char* argv[], std::string& errMsg) {
+	errMsg.clear();
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			return false;
+		} else if (arg == "-j") {
+			if (i + 1 >= argc) {
+				errMsg = "-j 缺少线程数";
+				return false;
+			}
+			try {
+				m_Options.workerCnt = std::stoi(argv[++i]);
+			} catch (const std::exception& e) {
+				errMsg = "-j 的线程数无效";
+				return false;
+			}
+			if (m_Options.workerCnt < 1) {
+				errMsg = "-j 的线程数至少为1";
+				return false;
+			}
+		} else if (arg == "--no-pin") {
+			m_Options.pinCPU = false;
+		} else if (arg == "--no-stream") {
+			m_Options.isStreamCmp = false;
+		} else if (arg == "--pipe-input") {
+			m_Options.isPipeInput = true;
+		} else if (arg == "--perf") {
+			m_Options.isPerf = true;
+		} else if (arg == "--ol") {
+			if (i + 1 >= argc) {
+				errMsg = "--ol 缺少输出限制";
+				return false;
+			}
+			try {
+				m_Options.outputLimitMB = std::stoll(argv[++i]);
+			} catch (const std::exception& e) {
+				errMsg = "--ol 的输出限制无效";
+				return false;
+			}
+			if (m_Options.outputLimitMB < 1) {
+				errMsg = "--ol 的输出限制至少为1";
+				return false;
+			}
+		} else if (arg == "--bench" || arg == "--warmup") {
+			if (i + 1 >= argc) {
+				errMsg = arg + " 缺少次数";
+				return false;
+			}
+			int cnt;
+			try {
+				cnt = std::stoi(argv[++i]);
+			} catch (const std::exception& e) {
+				errMsg = arg + " 的次数无效";
+				return false;
+			}
+			if (arg == "--bench") {
+				if (cnt < 2) {
+					errMsg = "--bench 的次数至少为2";
+					return false;
+				}
+				m_Options.benchRuns = cnt;
+			} else {
+				if (cnt < 0) {
+					errMsg = "--warmup 的次数不能为负数";
+					return false;
+				}
+				m_Options.benchWarmup = cnt;
+			}
+		} else if (arg == "--ab") {
+			if (i + 1 >= argc) {
+				errMsg = "--ab 缺少程序路径";
+				return false;
+			}
+			m_Options.abExePath = argv[++i];
+		} else if (arg == "--order") {
+			if (i + 1 >= argc) {
+				errMsg = "--order 缺少调度策略";
+				return false;
+			}
+			std::string orderStr = argv[++i];
+			if (orderStr == "name") {
+				m_Options.judgeOrder = ORDER_NAME;
+			} else if (orderStr == "failed") {
+				m_Options.judgeOrder = ORDER_FAILED_FIRST;
+			} else if (orderStr == "lpt") {
+				m_Options.judgeOrder = ORDER_LPT;
+			} else {
+				errMsg = "--order 的调度策略只能是name、failed或lpt";
+				return false;
+			}
+		} else if (arg == "--force") {
+			m_Options.isForce = true;
+		} else if (arg == "--line-diff") {
+			m_Options.isLineDiff = true;
+		} else if (arg == "--daemon") {
+			if (i + 1 >= argc) {
+				errMsg = "--daemon 缺少监听路径";
+				return false;
+			}
+			m_Options.daemonPath = argv[++i];
+		} else if (arg == "--worker") {
+			if (i + 1 >= argc) {
+				errMsg = "--worker 缺少监听地址";
+				return false;
+			}
+			m_Options.workerListenAddr = argv[++i];
+		} else if (arg == "--workers") {
+			if (i + 1 >= argc) {
+				errMsg = "--workers 缺少评测机地址";
+				return false;
+			}
+			std::string addrListStr = argv[++i];
+			size_t pos = 0;
+			while (pos <= addrListStr.size()) {
+				size_t end = addrListStr.find(',', pos);
+				if (end == std::string::npos) {
+					end = addrListStr.size();
+				}
+				if (end > pos) {
+					m_Options.workerAddrList.push_back(addrListStr.substr(pos, end - pos));
+				}
+				pos = end + 1;
+			}
+			if (m_Options.workerAddrList.empty()) {
+				errMsg = "--workers 缺少评测机地址";
+				return false;
+			}
+		} else if (arg == "--worker-token") {
+			if (i + 1 >= argc) {
+				errMsg = "--worker-token 缺少令牌";
+				return false;
+			}
+			m_Options.workerToken = argv[++i];
+		} else if (arg == "--digest") {
+			m_Options.isDigest = true;
+		} else if (arg == "--token") {
+			m_Options.isTokenCmp = true;
+		} else if (arg == "--abs-eps" || arg == "--rel-eps") {
+			if (i + 1 >= argc) {
+				errMsg = arg + " 缺少误差";
+				return false;
+			}
+			double eps;
+			try {
+				eps = std::stod(argv[++i]);
+			} catch (const std::exception& e) {
+				errMsg = arg + " 的误差无效";
+				return false;
+			}
+			if (!(eps >= 0)) {
+				errMsg = arg + " 的误差不能为负数";
+				return false;
+			}
+			(arg == "--abs-eps" ? m_Options.absEps : m_Options.relEps) = eps;
+			m_Options.isTokenCmp = true;
+		} else if (arg == "--checker") {
+			if (i + 1 >= argc) {
+				errMsg = "--checker 缺少checker路径";
+				return false;
+			}
+			m_Options.checkerPath = argv[++i];
+		} else if (arg == "--checker-lib") {
+			if (i + 1 >= argc) {
+				errMsg = "--checker-lib 缺少插件路径";
+				return false;
+			}
+			m_Options.checkerLibPath = argv[++i];
+		} else if (arg == "--ml") {
+			if (i + 1 >= argc) {
+				errMsg = "--ml 缺少内存限制";
+				return false;
+			}
+			try {
+				m_Options.memoryLimitMB = std::stoll(argv[++i]);
+			} catch (const std::exception& e) {
+				errMsg = "--ml 的内存限制无效";
+				return false;
+			}
+			if (m_Options.memoryLimitMB < 1) {
+				errMsg = "--ml 的内存限制至少为1";
+				return false;
+			}
+		} else {
+			errMsg = "未知的选项：" + arg;
+			return false;
+		}
+	}
+	if (!m_Options.checkerPath.empty() && !m_Options.checkerLibPath.empty()) {
+		errMsg = "--checker 与 --checker-lib 不能同时使用";
+		return false;
+	}
+	if (m_Options.isDigest && (m_Options.isTokenCmp || !m_Options.checkerPath.empty()
+	                           || !m_Options.checkerLibPath.empty())) {
+		errMsg = "--digest 只能用于逐行比较，不能与按单词比较或checker同时使用";
+		return false;
+	}
+	if (m_Options.isLineDiff && (m_Options.isTokenCmp || !m_Options.checkerPath.empty()
+	                             || !m_Options.checkerLibPath.empty())) {
+		errMsg = "--line-diff 只能用于逐行比较，不能与按单词比较或checker同时使用";
+		return false;
+	}
+	if (!m_Options.daemonPath.empty() && (m_Options.benchRuns > 0
+	                                      || !m_Options.abExePath.empty() || m_Options.isDigest)) {
+		errMsg = "--daemon 不能与--bench、--ab或--digest同时使用";
+		return false;
+	}
+	// 评测机只按协调端发来的配置评测，协调端只能转发不依赖本机文件的配置
+	bool hasLocalOnlyOption = m_Options.benchRuns > 0 || !m_Options.abExePath.empty()
+	                          || m_Options.isPerf || m_Options.isDigest
+	                          || !m_Options.checkerPath.empty()
+	                          || !m_Options.checkerLibPath.empty();
+	// 评测机也不接受比较方式与各项限制，这些选项都必须保持默认值
+	const JudgeOptions defaultOptions;
+	bool hasJudgeConfigOption = m_Options.isStreamCmp != defaultOptions.isStreamCmp
+	                            || m_Options.outputLimitMB != defaultOptions.outputLimitMB
+	                            || m_Options.memoryLimitMB != defaultOptions.memoryLimitMB
+	                            || m_Options.benchWarmup != defaultOptions.benchWarmup
+	                            || m_Options.isPipeInput != defaultOptions.isPipeInput
+	                            || m_Options.isTokenCmp != defaultOptions.isTokenCmp
+	                            || m_Options.absEps != defaultOptions.absEps
+	                            || m_Options.relEps != defaultOptions.relEps
+	                            || m_Options.isForce != defaultOptions.isForce
+	                            || m_Options.judgeOrder != defaultOptions.judgeOrder
+	                            || m_Options.isLineDiff != defaultOptions.isLineDiff;
+	if (!m_Options.workerListenAddr.empty() && (hasLocalOnlyOption || hasJudgeConfigOption
+	        || !m_Options.daemonPath.empty() || !m_Options.workerAddrList.empty())) {
+		errMsg = "--worker 只能与-j、--no-pin、--worker-token同时使用，评测配置由协调端指定";
+		return false;
+	}
+	if (!m_Options.workerAddrList.empty() && (hasLocalOnlyOption
+	        || !m_Options.daemonPath.empty())) {
+		errMsg = "--workers 不能与--bench、--ab、--perf、--digest、--checker、--checker-lib"
+		         "或--daemon同时使用";
+		return false;
+	}
+	if (m_Options.workerToken.empty()) {
+		const char* envToken = std::getenv(WORKER_TOKEN_ENV);
+		m_Options.workerToken = envToken == NULL ? "" : envToken;
+	}
+	if ((!m_Options.workerListenAddr.empty() || !m_Options.workerAddrList.empty())
+	        && m_Options.workerToken.empty()) {
+		errMsg = std::string("分布式评测必须通过--worker-token或环境变量")
+		         + WORKER_TOKEN_ENV + "指定令牌";
+		return false;
+	}
+	return true;
+}
+
+#endif /* _XY0797_JUDGEOPTIONS */
@@ -0,0 +1,359 @@
+/**
+ * \file    	AnsDigest.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		标准答案摘要及其索引，摘要一致即可判定AC，不需要读取标准答案
+ */
+#ifndef _XY0797_ANSDIGEST
+#define _XY0797_ANSDIGEST 1
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include "../WindowsFileSysTool.hpp"
+#include "TestStringCmp.hpp"
+
+// 按XXH64算法实现的64位流式哈希，可以分任意多段输入
+class StreamHash64 {
+private:
+	static const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+	static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+	static const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+	static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+	static const uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+	// 4路累加器，每次处理32字节
+	uint64_t m_acc[4] = { PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1 };
+
+	// 不足32字节的部分
+	unsigned char m_buffer[32];
+	size_t m_bufferLen = 0;
+
+	// 已输入的总字节数
+	uint64_t m_total = 0;
+
+	static uint64_t rotl(uint64_t x, int r) {
+		return (x << r) | (x >> (64 - r));
+	}
+
+	static uint64_t read64(const void* p) {
+		uint64_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	static uint64_t read32(const void* p) {
+		uint32_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	static uint64_t round(uint64_t acc, uint64_t input) {
+		return rotl(acc + input * PRIME2, 31) * PRIME1;
+	}
+
+	static uint64_t mergeRound(uint64_t h, uint64_t acc) {
+		return (h ^ round(0, acc)) * PRIME1 + PRIME4;
+	}
+
+	// 处理连续的32字节块，返回处理到的位置
+	const unsigned char* consumeStripes(const unsigned char* p, const unsigned char* end) {
+		uint64_t a0 = m_acc[0], a1 = m_acc[1], a2 = m_acc[2], a3 = m_acc[3];
+		while (end - p >= 32) {
+			a0 = round(a0, read64(p));
+			a1 = round(a1, read64(p + 8));
+			a2 = round(a2, read64(p + 16));
+			a3 = round(a3, read64(p + 24));
+			p += 32;
+		}
+		m_acc[0] = a0;
+		m_acc[1] = a1;
+		m_acc[2] = a2;
+		m_acc[3] = a3;
+		return p;
+	}
+
+public:
+	void update(const char* data, size_t len) {
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+		const unsigned char* end = p + len;
+		m_total += len;
+		if (m_bufferLen > 0) {
+			size_t fillLen = std::min(len, sizeof(m_buffer) - m_bufferLen);
+			memcpy(m_buffer + m_bufferLen, p, fillLen);
+			m_bufferLen += fillLen;
+			p += fillLen;
+			if (m_bufferLen < sizeof(m_buffer)) {
+				return;
+			}
+			consumeStripes(m_buffer, m_buffer + sizeof(m_buffer));
+			m_bufferLen = 0;
+		}
+		p = consumeStripes(p, end);
+		memcpy(m_buffer, p, end - p);
+		m_bufferLen = end - p;
+	}
+
+	// 取得哈希值，不影响后续输入
+	uint64_t digest() const {
+		uint64_t h;
+		if (m_total >= 32) {
+			h = rotl(m_acc[0], 1) + rotl(m_acc[1], 7) + rotl(m_acc[2], 12) + rotl(m_acc[3], 18);
+			for (uint64_t acc : m_acc) {
+				h = mergeRound(h, acc);
+			}
+		} else {
+			h = m_acc[2] + PRIME5;
+		}
+		h += m_total;
+		const unsigned char* p = m_buffer;
+		const unsigned char* end = m_buffer + m_bufferLen;
+		for (; end - p >= 8; p += 8) {
+			h = rotl(h ^ round(0, read64(p)), 27) * PRIME1 + PRIME4;
+		}
+		if (end - p >= 4) {
+			h = rotl(h ^ (read32(p) * PRIME1), 23) * PRIME2 + PRIME3;
+			p += 4;
+		}
+		for (; p < end; ++p) {
+			h = rotl(h ^ (*p * PRIME5), 11) * PRIME1;
+		}
+		h ^= h >> 33;
+		h *= PRIME2;
+		h ^= h >> 29;
+		h *= PRIME3;
+		h ^= h >> 32;
+		return h;
+	}
+};
+
+// 标准答案摘要：规范化后内容的哈希值与行数
+// 规范化与compareAnsStr的判定规则一致：\r\n与\r视为\n，去除行末空格，每行以\n结尾
+// 因此两段文本的摘要相同等价于compareAnsStr判定一致(不计哈希冲突)
+struct AnsDigest {
+	uint64_t hash = 0;
+	long long lineCnt = 0;
+
+	bool operator==(const AnsDigest& o) const {
+		return hash == o.hash && lineCnt == o.lineCnt;
+	}
+
+	bool operator!=(const AnsDigest& o) const {
+		return !(*this == o);
+	}
+};
+
+// 流式计算文本的摘要，可以在任意位置断开输入
+class AnsDigestBuilder {
+private:
+	StreamHash64 m_hash;
+
+	// 行内暂缓的空格数，之后出现非空格字符才计入
+	size_t m_pendingSpaceCnt = 0;
+
+	// 当前行是否已经开始(读取到了字符)
+	bool m_isLineStarted = false;
+
+	// 上一段以\r结尾，下一段开头的\n属于同一个换行
+	bool m_isPendingCR = false;
+
+	long long m_lineCnt = 0;
+
+	// 处理当前行中的一段字符
+	void onLineData(const char* p, size_t len) {
+		m_isLineStarted = true;
+		const char* contentEnd = p + len;
+		while (contentEnd > p && contentEnd[-1] == ' ') {
+			--contentEnd;
+		}
+		if (contentEnd > p) {
+			static const char SPACES[] = "                                ";
+			while (m_pendingSpaceCnt > 0) {
+				size_t cnt = std::min(m_pendingSpaceCnt, sizeof(SPACES) - 1);
+				m_hash.update(SPACES, cnt);
+				m_pendingSpaceCnt -= cnt;
+			}
+			m_hash.update(p, contentEnd - p);
+		}
+		m_pendingSpaceCnt += p + len - contentEnd;
+	}
+
+	// 处理一个换行
+	void onLineEnd() {
+		m_hash.update("\n", 1);
+		m_pendingSpaceCnt = 0;
+		m_isLineStarted = false;
+		++m_lineCnt;
+	}
+
+public:
+	void feed(const char* data, size_t len) {
+		const char* p = data;
+		const char* end = data + len;
+		if (m_isPendingCR && p < end) {
+			m_isPendingCR = false;
+			if (*p == '\n') {
+				++p;
+			}
+		}
+		while (p < end) {
+			const char* lineEnd = findLineEnd(p, end);
+			if (lineEnd > p) {
+				onLineData(p, lineEnd - p);
+			}
+			if (lineEnd == end) {
+				break;
+			}
+			if (*lineEnd == '\r') {
+				if (lineEnd + 1 == end) {
+					m_isPendingCR = true;
+				} else if (lineEnd[1] == '\n') {
+					++lineEnd;
+				}
+			}
+			onLineEnd();
+			p = lineEnd + 1;
+		}
+	}
+
+	// 全部输入后调用，没有换行结尾的最后一行也算一行
+	AnsDigest finish() {
+		if (m_isLineStarted) {
+			onLineEnd();
+		}
+		AnsDigest digest;
+		digest.hash = m_hash.digest();
+		digest.lineCnt = m_lineCnt;
+		return digest;
+	}
+};
+
+// 计算整段文本的摘要
+AnsDigest calcAnsDigest(std::string_view text) {
+	AnsDigestBuilder builder;
+	builder.feed(text.data(), text.size());
+	return builder.finish();
+}
+
+// 标准答案摘要索引文件的文件名，保存在测试集所在目录下
+const char* const ANS_DIGEST_INDEX_NAME = "localoj_digest.txt";
+
+// 标准答案摘要索引
+// 按文件名记录各标准答案的大小、修改时间与摘要，大小或修改时间变化后记录失效
+// 失效或缺失的记录由评测时读取标准答案后补上，评测结束后统一保存
+// 可在多个线程中同时查询与更新
+class AnsDigestIndex {
+private:
+	struct Entry {
+		long long fileSize;
+		long long modifyTime;
+		AnsDigest digest;
+	};
+
+	std::string m_indexPath;
+
+	std::unordered_map<std::string, Entry> m_entries;
+
+	// 是否有未保存的更新
+	bool m_isDirty = false;
+
+	mutable std::mutex m_mutex;
+
+public:
+	AnsDigestIndex() = default;
+	AnsDigestIndex(const AnsDigestIndex&) = delete;
+	AnsDigestIndex& operator=(const AnsDigestIndex&) = delete;
+
+	/*
+	 *	读取索引文件，文件不存在时得到空的索引，格式有误的行被忽略
+	 *  每行依次为：文件大小 修改时间 哈希值(十六进制) 行数 文件名
+	 */
+	void load(const std::string& indexPath) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_indexPath = indexPath;
+		m_entries.clear();
+		m_isDirty = false;
+		std::ifstream fin(indexPath);
+		std::string lineStr;
+		while (std::getline(fin, lineStr)) {
+			std::istringstream lineIn(lineStr);
+			Entry entry;
+			std::string name;
+			if (lineIn >> entry.fileSize >> entry.modifyTime >> std::hex >> entry.digest.hash
+			        >> std::dec >> entry.digest.lineCnt && lineIn.get() == ' '
+			        && std::getline(lineIn, name) && !name.empty()) {
+				m_entries[name] = entry;
+			}
+		}
+	}
+
+	bool isLoaded() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return !m_indexPath.empty();
+	}
+
+	/*
+	 *	查询标准答案的摘要，记录缺失或已失效时返回false
+	 */
+	bool find(const std::string& ansFilePath, AnsDigest& digest) const {
+		long long fileSize, modifyTime;
+		if (!winfs::getFileSizeAndTime(ansFilePath, fileSize, modifyTime)) {
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_entries.find(winfs::getFileNameWithExten(ansFilePath));
+		if (it == m_entries.end() || it->second.fileSize != fileSize
+		        || it->second.modifyTime != modifyTime) {
+			return false;
+		}
+		digest = it->second.digest;
+		return true;
+	}
+
+	/*
+	 *	记录标准答案当前内容的摘要
+	 */
+	void update(const std::string& ansFilePath, const AnsDigest& digest) {
+		Entry entry;
+		if (!winfs::getFileSizeAndTime(ansFilePath, entry.fileSize, entry.modifyTime)) {
+			return;
+		}
+		entry.digest = digest;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries[winfs::getFileNameWithExten(ansFilePath)] = entry;
+		m_isDirty = true;
+	}
+
+	/*
+	 *	有更新时写回索引文件，返回是否成功，没有更新时直接返回true
+	 */
+	bool save() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_isDirty) {
+			return true;
+		}
+		std::ofstream fout(m_indexPath);
+		if (!fout.is_open()) {
+			return false;
+		}
+		for (const auto& e : m_entries) {
+			fout << e.second.fileSize << ' ' << e.second.modifyTime << ' '
+			     << std::hex << e.second.digest.hash << std::dec << ' '
+			     << e.second.digest.lineCnt << ' ' << e.first << '\n';
+		}
+		fout.close();
+		if (!fout) {
+			return false;
+		}
+		m_isDirty = false;
+		return true;
+	}
+};
+
+#endif /* _XY0797_ANSDIGEST */
@@ -0,0 +1,137 @@
+/**
+ * \file    	BenchStats.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		基准测试的统计工具，对多次运行的耗时计算稳健的统计量与显著性
+ */
+#ifndef _XY0797_BENCHSTATS
+#define _XY0797_BENCHSTATS 1
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+// 相对标准差超过该值时认为波动过大，结果不可信
+const double BENCH_UNSTABLE_CV = 0.1;
+
+// 一组样本的统计量，单位与样本相同
+struct SampleStats {
+	// 样本数
+	size_t cnt = 0;
+	long long min = 0;
+	long long median = 0;
+	// 95百分位数(最近秩法)
+	long long p95 = 0;
+	double mean = 0;
+	// 样本标准差
+	double stddev = 0;
+
+	// 相对标准差(变异系数)
+	double getCV() const {
+		return mean > 0 ? stddev / mean : 0;
+	}
+
+	// 波动是否过大
+	bool isUnstable() const {
+		return getCV() > BENCH_UNSTABLE_CV;
+	}
+};
+
+// 计算一组样本的统计量
+SampleStats calcSampleStats(std::vector<long long> samples) {
+	SampleStats res;
+	res.cnt = samples.size();
+	if (samples.empty()) {
+		return res;
+	}
+	std::sort(samples.begin(), samples.end());
+	size_t n = samples.size();
+	res.min = samples.front();
+	if (n % 2) {
+		res.median = samples[n / 2];
+	} else {
+		res.median = (samples[n / 2 - 1] + samples[n / 2]) / 2;
+	}
+	size_t p95Rank = static_cast<size_t>(std::ceil(0.95 * static_cast<double>(n)));
+	res.p95 = samples[std::max(p95Rank, static_cast<size_t>(1)) - 1];
+	double sum = 0;
+	for (long long e : samples) {
+		sum += static_cast<double>(e);
+	}
+	res.mean = sum / static_cast<double>(n);
+	if (n > 1) {
+		double sqSum = 0;
+		for (long long e : samples) {
+			double d = static_cast<double>(e) - res.mean;
+			sqSum += d * d;
+		}
+		res.stddev = std::sqrt(sqSum / static_cast<double>(n - 1));
+	}
+	return res;
+}
+
+// Mann-Whitney U检验(正态近似，含结值修正)，返回两组样本分布相同的双侧p值
+// 不假设耗时服从正态分布，少量离群值不会影响结论
+double calcMannWhitneyP(const std::vector<long long>& a, const std::vector<long long>& b) {
+	size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+	if (n1 == 0 || n2 == 0) {
+		return 1;
+	}
+	// 合并排序后计算秩，相同的值取平均秩
+	std::vector<std::pair<long long, int>> all;
+	all.reserve(n);
+	for (long long e : a) {
+		all.push_back(std::make_pair(e, 0));
+	}
+	for (long long e : b) {
+		all.push_back(std::make_pair(e, 1));
+	}
+	std::sort(all.begin(), all.end());
+	double rankSumA = 0, tieSum = 0;
+	for (size_t i = 0; i < n;) {
+		size_t j = i;
+		while (j < n && all[j].first == all[i].first) {
+			++j;
+		}
+		double avgRank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2;
+		for (size_t k = i; k < j; ++k) {
+			if (all[k].second == 0) {
+				rankSumA += avgRank;
+			}
+		}
+		double t = static_cast<double>(j - i);
+		tieSum += t * t * t - t;
+		i = j;
+	}
+	double dn1 = static_cast<double>(n1), dn2 = static_cast<double>(n2);
+	double dn = static_cast<double>(n);
+	double u = rankSumA - dn1 * (dn1 + 1) / 2;
+	double mu = dn1 * dn2 / 2;
+	double sigma2 = dn1 * dn2 / 12 * ((dn + 1) - tieSum / (dn * (dn - 1)));
+	if (sigma2 <= 0) {
+		return 1;
+	}
+	double z = (std::fabs(u - mu) - 0.5) / std::sqrt(sigma2);
+	if (z <= 0) {
+		return 1;
+	}
+	return std::erfc(z / std::sqrt(2.0));
+}
+
+// 显著性标记：p<0.001为***，p<0.01为**，p<0.05为*，否则为空
+std::string getSignificanceMark(double pValue) {
+	if (pValue < 0.001) {
+		return "***";
+	}
+	if (pValue < 0.01) {
+		return "**";
+	}
+	if (pValue < 0.05) {
+		return "*";
+	}
+	return "";
+}
+
+#endif /* _XY0797_BENCHSTATS */
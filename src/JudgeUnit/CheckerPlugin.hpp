@@ -0,0 +1,122 @@
+/**
+ * \file    	CheckerPlugin.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		以动态库形式加载的checker插件，在评测进程内直接调用
+ */
+#ifndef _XY0797_CHECKERPLUGIN
+#define _XY0797_CHECKERPLUGIN 1
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+/*
+ *	插件需要导出以下C接口：
+ *  extern "C" int localoj_check(LocalOJView input, LocalOJView output, LocalOJView answer,
+ *                               char* msg, size_t msgSize);
+ *  input、output、answer分别为输入、待测程序的输出与标准答案，数据不以\0结尾
+ *  msg为评测信息的缓冲区，插件最多写入msgSize字节(含结尾的\0)，不写入则信息为空
+ *  返回值与testlib相同：0为AC，1为WA，2为格式错误，3为评测数据或checker有误，7为部分正确
+ *  评测线程会同时调用该函数，插件必须是线程安全的
+ */
+extern "C" {
+	struct LocalOJView {
+		const char* data;
+		size_t len;
+	};
+
+	typedef int (*LocalOJCheckFunc)(LocalOJView input, LocalOJView output,
+	                                LocalOJView answer, char* msg, size_t msgSize);
+}
+
+// 插件导出的函数名
+const char* const CHECKER_PLUGIN_SYMBOL = "localoj_check";
+
+// 评测信息缓冲区的大小(字节)
+const size_t CHECKER_PLUGIN_MSG_SIZE = 4096;
+
+class CheckerPlugin {
+private:
+#ifdef _WIN32
+	HMODULE m_hModule = NULL;
+#else
+	void* m_handle = NULL;
+#endif
+
+	LocalOJCheckFunc m_checkFunc = nullptr;
+
+public:
+	CheckerPlugin() = default;
+	CheckerPlugin(const CheckerPlugin&) = delete;
+	CheckerPlugin& operator=(const CheckerPlugin&) = delete;
+
+	// 插件在评测进程结束前一直保持加载
+	~CheckerPlugin() {
+#ifdef _WIN32
+		if (m_hModule != NULL) {
+			FreeLibrary(m_hModule);
+		}
+#else
+		if (m_handle != NULL) {
+			dlclose(m_handle);
+		}
+#endif
+	}
+
+	/*
+	 *	加载插件，失败时返回false并把原因写在errMsg里面
+	 */
+	bool load(const std::string& libPath, std::string& errMsg) {
+#ifdef _WIN32
+		m_hModule = LoadLibraryA(libPath.c_str());
+		if (m_hModule == NULL) {
+			errMsg = "无法加载checker插件，错误代码" + std::to_string(GetLastError());
+			return false;
+		}
+		m_checkFunc = reinterpret_cast<LocalOJCheckFunc>(
+		                  GetProcAddress(m_hModule, CHECKER_PLUGIN_SYMBOL));
+#else
+		// 路径不含/时dlopen会按库搜索路径查找，因此补上./
+		std::string pathStr = libPath.find('/') == std::string::npos ? "./" + libPath : libPath;
+		m_handle = dlopen(pathStr.c_str(), RTLD_NOW | RTLD_LOCAL);
+		if (m_handle == NULL) {
+			errMsg = std::string("无法加载checker插件：") + dlerror();
+			return false;
+		}
+		m_checkFunc = reinterpret_cast<LocalOJCheckFunc>(dlsym(m_handle, CHECKER_PLUGIN_SYMBOL));
+#endif
+		if (m_checkFunc == nullptr) {
+			errMsg = std::string("checker插件没有导出") + CHECKER_PLUGIN_SYMBOL + "函数";
+			return false;
+		}
+		return true;
+	}
+
+	bool isLoaded() const {
+		return m_checkFunc != nullptr;
+	}
+
+	/*
+	 *	调用插件检查输出，返回testlib约定的返回值，插件写入的信息保存在msg里面
+	 */
+	int check(std::string_view input, std::string_view output,
+	          std::string_view answer, std::string& msg) const {
+		char msgBuffer[CHECKER_PLUGIN_MSG_SIZE];
+		msgBuffer[0] = 0;
+		int exitCode = m_checkFunc(LocalOJView{ input.data(), input.size() },
+		                           LocalOJView{ output.data(), output.size() },
+		                           LocalOJView{ answer.data(), answer.size() },
+		                           msgBuffer, sizeof(msgBuffer));
+		msgBuffer[sizeof(msgBuffer) - 1] = 0;
+		msg = msgBuffer;
+		return exitCode;
+	}
+};
+
+#endif /* _XY0797_CHECKERPLUGIN */
@@ -2,382 +2,189 @@
  * \file    	ConsoleOJ.hpp
  * \author  	XY0797
  * \date    	2024.8.6
- * \brief		用于评测控制台程序的工具类
+ * \brief		用于评测控制台程序的工具类，按平台选择Windows或POSIX实现
  */
 #ifndef _XY0797_CONSOLEOJ
 #define _XY0797_CONSOLEOJ 1
 
-#include <iostream>
-#include <shared_mutex>
-#include <thread>
-#include <chrono>
+#include <atomic>
 #include <string>
-#include <windows.h>
+#include <algorithm>
+#include <functional>
+
+// 每次读取输出时至少预留的空间
+const size_t OUTPUT_READ_CHUNK = 64 * 1024;
+
+// 通过输入来源函数写入时，每次取得输入的最大长度
+const size_t INPUT_WRITE_CHUNK = 64 * 1024;
+
+// 进程正常退出后，等待后代进程释放输出管道的最长时间(ms)
+const long long OUTPUT_DRAIN_WAIT = 500;
+
+// 真实时间到达时间限制后，检查程序是否被阻塞的间隔(ms)
+const long long IDLE_CHECK_INTERVAL = 100;
+
+// 一个检查间隔内CPU时间的最小增长(us)，低于该值视为程序被阻塞
+const long long MIN_CPU_PROGRESS_US = 1000;
+
+// 真实时间上限是时间限制的多少倍
+const long long MAX_WALL_TIME_RATIO = 40;
+
+// 性能计数器，无法获取的项为-1
+struct PerfCounters {
+	// 执行的指令数
+	long long instructions = -1;
+	// CPU周期数
+	long long cycles = -1;
+	// 缓存未命中次数
+	long long cacheMisses = -1;
+	// 分支预测失败次数
+	long long branchMisses = -1;
+	// 缺页次数
+	long long pageFaults = -1;
+	// 上下文切换次数
+	long long contextSwitches = -1;
+};
 
-// 安全关闭句柄
-void Clhandle_s(HANDLE& hd) {
-	if (hd != INVALID_HANDLE_VALUE) {
-		CloseHandle(hd);
-		hd = INVALID_HANDLE_VALUE;
-	}
-}
+// 单次运行的资源统计
+struct RunStats {
+	// 所有线程与子进程消耗的CPU时间(us)
+	long long cpuTimeUs = 0;
+	// 从程序开始执行到退出的真实时间(us)
+	long long wallTimeUs = 0;
+	// 峰值内存(字节)，无法获取时为0
+	long long peakMemory = 0;
+	// 性能计数器，未启用统计时全部为-1
+	PerfCounters perf;
+};
 
-// 文件时间转毫秒
-long long fileTime2ms(const FILETIME& fileTime) {
-	ULARGE_INTEGER Uint;
-	Uint.LowPart = fileTime.dwLowDateTime;
-	Uint.HighPart = fileTime.dwHighDateTime;
-	return (Uint.QuadPart / 10000ull);
+// 内存超限的错误信息
+std::string getMemoryLimitMsg(long long memoryLimit) {
+	return "内存超限！内存使用超过了" + std::to_string(memoryLimit / 1024 / 1024) + "MB";
 }
 
-class ConsoleOJ {
+// 输出收集器，与平台无关
+// 负责输出缓冲区、输出限制与输出处理函数，只在监视线程中读写缓冲区
+class OutputCollector {
 private:
-	// 可执行文件路径、工作目录、命令行参数
-	std::string m_programPath;
-	std::string m_workingDirectory;
-
-	// 进程信息读写锁，多线程访问时的线程安全
-	std::shared_mutex m_rwProcMutex;
-
-	// 读取输出的句柄
-	HANDLE m_outputPipeRead = INVALID_HANDLE_VALUE;
-
-	// 写入数据的句柄
-	HANDLE m_inputPipeWrite = INVALID_HANDLE_VALUE;
+	// 输出文本内容
+	std::string m_output;
 
-	// 写入数据，保证输入期间不被析构
-	const char* m_inputCStr = nullptr;
-	DWORD m_inputCStrLen = 0;
+	// 输出处理函数，为空则把输出保存到m_output
+	std::function<bool(const char*, size_t)> m_sink;
 
-	// 是否已经启动
-	bool isLaunched = false;
+	// 输出限制(字节)，小于0表示不限制
+	long long m_limit = -1;
 
-	// 析构事件同步对象
-	HANDLE m_hExitEvent = INVALID_HANDLE_VALUE;
+	// 本次已读取的输出总量
+	long long m_total = 0;
 
-	// 将要析构标志位
-	bool m_willExit = false;
+	// 本次预留空间之前的输出长度
+	size_t m_preparedSize = 0;
 
-	// 监视线程对象
-	std::thread m_checkProcThread;
+	// 是否输出超限
+	std::atomic<bool> m_isLimitExceeded{false};
 
-	// 写输入文本线程对象
-	std::thread m_WriteStrThread;
+public:
+	void setLimit(long long limit) {
+		m_limit = limit;
+	}
 
-	// 输出文本内容
-	std::string m_output;
+	long long getLimit() const {
+		return m_limit;
+	}
 
-	// 监视线程
-	static void CheckProcThread(ConsoleOJ* const classthis) {
-		classthis->m_output = "";
-		bool onemoretime = true;
-		while (classthis->isLaunched || onemoretime) {
-			if (!classthis->isLaunched) {
-				onemoretime = false;
-			}
-			DWORD availableBytes;
-			DWORD bytesRead;
-			classthis->m_rwProcMutex.lock();
-			PeekNamedPipe(classthis->m_outputPipeRead, NULL, 0, NULL,
-			              &availableBytes, NULL);
-			if (availableBytes > 0) {
-				char* outputBuffer = new char[availableBytes + 1];
-				if (!ReadFile(classthis->m_outputPipeRead, outputBuffer,
-				              availableBytes, &bytesRead, NULL)) {
-					delete[] outputBuffer;
-					classthis->m_rwProcMutex.unlock();
-					return;
-				}
-				outputBuffer[bytesRead] = '\0';
-				classthis->m_output += std::string(outputBuffer);
-				delete[] outputBuffer;
-			}
-			classthis->m_rwProcMutex.unlock();
-			WaitForSingleObject(classthis->m_hExitEvent, 10);
-			if (classthis->m_willExit) {
-				return;
-			}
-		}
+	void setSink(std::function<bool(const char*, size_t)> sink) {
+		m_sink = std::move(sink);
 	}
 
-	static void WriteStrThread(ConsoleOJ* const classthis) {
-		DWORD bytesWritten;
-		WriteFile(classthis->m_inputPipeWrite, classthis->m_inputCStr,
-		          classthis->m_inputCStrLen, &bytesWritten, NULL);
+	// 开始新的一次收集，接管buffer的空间
+	void start(std::string& buffer) {
+		m_output.swap(buffer);
+		m_output.clear();
+		m_total = 0;
+		m_isLimitExceeded = false;
 	}
 
-public:
-	/*
-	 *	构造时传入：exe文件路径
-	 */
-	explicit ConsoleOJ(const std::string& programPath) : m_programPath(programPath) {
-		// 处理工作目录
-		size_t found = programPath.find_last_of("/\\");
-		if (found != std::string::npos) {
-			this->m_workingDirectory = programPath.substr(0, found);
-		} else {
-			this->m_workingDirectory.clear();
+	// 结束收集，把输出交给buffer，isKeep为false时只交还空间
+	void finish(std::string& buffer, bool isKeep) {
+		if (!isKeep) {
+			m_output.clear();
 		}
-		// 创建事件对象
-		m_hExitEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		buffer.swap(m_output);
+		m_output.clear();
 	}
 
-	~ConsoleOJ() {
-		// 析构
-		m_willExit = true;
-		SetEvent(m_hExitEvent);
-		if (isLaunched) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	// 为下一次读取预留OUTPUT_READ_CHUNK字节的空间，返回写入位置
+	// 数据直接读入缓冲区末尾，不经过临时缓冲区，可以包含\0
+	char* prepare() {
+		m_preparedSize = m_output.size();
+		// 容量按倍数增长
+		if (m_output.capacity() < m_preparedSize + OUTPUT_READ_CHUNK) {
+			m_output.reserve(std::max(m_output.capacity() * 2,
+			                          m_preparedSize + OUTPUT_READ_CHUNK));
 		}
-		// 关闭事件同步对象句柄
-		CloseHandle(m_hExitEvent);
+		m_output.resize(m_preparedSize + OUTPUT_READ_CHUNK);
+		return &m_output[m_preparedSize];
 	}
 
-	/*
-	 *	启动进程，返回目标程序是否在时限内成功运行
-	 *  输入文本[in]：将压入目标程序输入流的文本，为空则不输入文本
-	 *  时间限制[in]：单位毫秒，必须是100ms的倍数，否则向上取整到100ms的倍数
-	 *  输出文本[out]：返回程序输出流中的文本
-	 *  时间花费[out]：返回程序运行消耗的CPU时间
-	 *  错误信息[out]：返回程序运行失败的原因
-	 */
-	bool launchAndWait(const std::string& inputstr, long long timelimit,
-	                   std::string& outputstr, long long& timecosted, std::string& errstr) {
-		// 初始化安全标识符，使得管道可被子进程访问
-		SECURITY_ATTRIBUTES securityAttributes;
-		securityAttributes.nLength = sizeof(SECURITY_ATTRIBUTES);
-		securityAttributes.bInheritHandle = TRUE;
-		securityAttributes.lpSecurityDescriptor = NULL;
-		// 管道句柄
-		HANDLE inputPipeRead = INVALID_HANDLE_VALUE;
-		HANDLE inputPipeWrite = INVALID_HANDLE_VALUE;
-		HANDLE outputPipeWrite = INVALID_HANDLE_VALUE;
-		// 初始化进程信息结构体
-		PROCESS_INFORMATION processInfo;
-		ZeroMemory(&processInfo, sizeof(processInfo));
-		try {
-			// 附带安全标识符创建输入管道
-			if (!CreatePipe(&inputPipeRead, &inputPipeWrite, &securityAttributes, 0)) {
-				errstr = "创建输入管道失败！";
-				throw 1;
-			}
-
-			// 附带安全标识符创建输出管道
-			m_rwProcMutex.lock();
-			if (!CreatePipe(&m_outputPipeRead, &outputPipeWrite, &securityAttributes, 0)) {
-				errstr = "创建输出管道失败！";
-				throw 2;
-			}
-			m_rwProcMutex.unlock();
-
-			// 初始化启动信息结构体
-			STARTUPINFOA startupInfo;
-			ZeroMemory(&startupInfo, sizeof(startupInfo));
-			startupInfo.cb = sizeof(startupInfo);
-
-			// 设置输入输出管道，设置使用自定义管道标志位
-			startupInfo.hStdInput = inputPipeRead;
-			startupInfo.hStdOutput = outputPipeWrite;
-			startupInfo.hStdError = outputPipeWrite;
-			startupInfo.dwFlags |= STARTF_USESTDHANDLES;
-
-			// 处理命令行信息
-			std::string commandLine = "\"" + m_programPath + "\"";
-			char* commandLine_c = new char[commandLine.size() + 1];
-			strncpy(commandLine_c, commandLine.c_str(), commandLine.size());
-			commandLine_c[commandLine.size()] = 0;
-
-			// 创建进程
-			const char* workingDirectoryPtr = NULL;
-			if (!m_workingDirectory.empty()) {
-				workingDirectoryPtr = m_workingDirectory.c_str();
-			}
-			if (!CreateProcessA(NULL, commandLine_c, NULL, NULL, TRUE,
-			                    HIGH_PRIORITY_CLASS | CREATE_NO_WINDOW | CREATE_SUSPENDED,
-			                    NULL, workingDirectoryPtr, &startupInfo, &processInfo)) {
-				// 释放命令行文本
-				delete[] commandLine_c;
-				errstr = "创建进程失败！";
-				throw 3;
-			}
-
-			// 释放命令行文本
-			delete[] commandLine_c;
-
-			isLaunched = true;
-
-			// 启动监视线程
-			m_checkProcThread = std::thread(&CheckProcThread, this);
-
-			// 写入测试输入
-			std::string inputWithEOF;
-			if (!inputstr.empty()) {
-				// 不为空才需要真写入数据
-				inputWithEOF = inputstr + static_cast<char>(26);
-				// 异步写入数据
-				m_inputCStr = inputWithEOF.c_str();
-				m_inputCStrLen = static_cast<DWORD>(inputWithEOF.size());
-				m_inputPipeWrite = inputPipeWrite;
-				// 启动数据写入线程
-				m_WriteStrThread = std::thread(&WriteStrThread, this);
-			}
-
-			// 需要等待析构标志句柄与进程句柄
-			HANDLE hWaitHandle[2];
-			hWaitHandle[0] = this->m_hExitEvent;
-			hWaitHandle[1] = processInfo.hProcess;
-
-			// 存储初始CPU周期计数
-			ULONG64 stCycleTime = 0ull;
-			// 最小增长周期1e6
-			const ULONG64 minDCycleTime = 1000000ull;
-
-			// 处理时间限制为100ms的倍数
-			long long timeLimitCnt = timelimit / 100;
-			if (timelimit % 100) {
-				++timeLimitCnt;
-			}
-			timelimit = timeLimitCnt * 100;
-
-			// 最大真实时间花费
-			long long maxRealTimeCost = 40 * timelimit;
-
-			// 继续执行进程
-			ResumeThread(processInfo.hThread);
-
-			// 开始计时
-			auto start = std::chrono::high_resolution_clock::now();
-
-			// 开始等待句柄信号
-			while (1) {
-				// 同时等待两个句柄，只要有一个响应就退出阻塞
-				DWORD waitResult = WaitForMultipleObjects(2, hWaitHandle, FALSE, 100);
-
-				if (m_willExit) {
-					errstr = "类正在析构！";
-					throw 4;
-				} else if (waitResult == WAIT_TIMEOUT) {
-					if (timeLimitCnt == 0) {
-						// 需要判断是不是真TLE了
-						FILETIME creationTime, exitTime, kernelTime, userTime;
-						GetThreadTimes(processInfo.hThread, &creationTime, &exitTime,
-						               &kernelTime, &userTime);
-						timecosted = fileTime2ms(kernelTime) + fileTime2ms(userTime);
-						if (timecosted > timelimit) {
-							errstr = "执行超时！";
-							throw 4;
-						}
-						// 先获取真实时间花费
-						std::chrono::duration<double> timeElapsed =
-						    std::chrono::high_resolution_clock::now() - start;
-						timecosted = std::chrono::duration_cast<std::chrono::milliseconds>
-						             (timeElapsed).count();
-						// 然后判断被阻塞的情况
-						ULONG64 curCycleTime = 0ull;
-						QueryThreadCycleTime(processInfo.hThread, &curCycleTime);
-						if (curCycleTime - stCycleTime < minDCycleTime) {
-							errstr = "程序疑似被阻塞，执行超时！";
-							throw 4;
-						}
-						stCycleTime = curCycleTime;
-						// 再判断真实耗时过大的情况
-						if (timecosted > maxRealTimeCost) {
-							errstr = "评测机负载过大，执行超时！";
-							throw 4;
-						}
-					} else {
-						--timeLimitCnt;
-					}
-				} else {
-					// 说明正常退出了
-					break;
-				}
-			}
-
-			// 程序时限内退出
-
-			// 获取时间
-			FILETIME creationTime, exitTime, kernelTime, userTime;
-			GetThreadTimes(processInfo.hThread, &creationTime, &exitTime,
-			               &kernelTime, &userTime);
-			long long realTimeUsed, CPUTimeUsed;
-			realTimeUsed = fileTime2ms(exitTime) - fileTime2ms(creationTime);
-			if (realTimeUsed < 0) {
-				realTimeUsed = 0;
-			}
-			CPUTimeUsed = fileTime2ms(kernelTime) + fileTime2ms(userTime);
-			if (CPUTimeUsed > realTimeUsed) {
-				timecosted = realTimeUsed;
-			} else {
-				timecosted = CPUTimeUsed;
-			}
-
-			// 获取进程退出代码
-			DWORD exeCode;
-			GetExitCodeProcess(processInfo.hProcess, &exeCode);
-			if (exeCode != 0) {
-				errstr = "程序返回值为" + std::to_string(exeCode) + "！";
-				throw 4;
-			}
-
-			// 获取输出
-			isLaunched = false;
-			m_checkProcThread.join();
-			m_WriteStrThread.join();
-			outputstr = m_output;
-			m_output = "";
-
-			// 关闭管道句柄
-			Clhandle_s(inputPipeWrite);
-			Clhandle_s(inputPipeRead);
-			Clhandle_s(m_outputPipeRead);
-			Clhandle_s(outputPipeWrite);
-
-			// 关闭线程句柄
-			Clhandle_s(processInfo.hThread);
+	// 读取失败，放弃预留的空间
+	void cancel() {
+		m_output.resize(m_preparedSize);
+	}
 
-			// 关闭进程句柄
-			Clhandle_s(processInfo.hProcess);
-			return true;
-		} catch (int errid) {
-			switch (errid) {
-				case 4:
-					// 需要处理写入线程
-					if (!inputstr.empty()) {
-						// 取消IO请求
-						CancelIoEx(m_inputPipeWrite, NULL);
-						// 等待线程结束
-						m_WriteStrThread.join();
-					}
-					// 结束进程
-					TerminateProcess(processInfo.hProcess, 1);
-					// 等待线程
-					isLaunched = false;
-					m_checkProcThread.join();
-					// 关闭线程句柄
-					Clhandle_s(processInfo.hThread);
-					// 关闭进程句柄
-					Clhandle_s(processInfo.hProcess);
-				case 3:
-					// 关闭输出句柄
-					m_rwProcMutex.lock();
-					Clhandle_s(m_outputPipeRead);
-					m_rwProcMutex.unlock();
-					Clhandle_s(outputPipeWrite);
-					break;
-				case 2:
-					// 关闭输出句柄
-					Clhandle_s(m_outputPipeRead);
-					m_rwProcMutex.unlock();
-					Clhandle_s(outputPipeWrite);
-					break;
-			}
-			// 关闭输入句柄
-			Clhandle_s(inputPipeRead);
-			Clhandle_s(inputPipeWrite);
+	// 提交读取到的字节数，返回false表示需要结束目标程序
+	// 设置了输出处理函数时，每读到一段就交给它处理，缓冲区只保留一段的空间
+	// 输出总量超过限制时要求结束目标程序，因此缓冲区最多占用限制加一段的空间
+	bool commit(size_t bytesRead) {
+		m_output.resize(m_preparedSize + bytesRead);
+		m_total += static_cast<long long>(bytesRead);
+		if (m_limit >= 0 && m_total > m_limit) {
+			// 输出超限，已读取的输出不再有用
+			m_output.clear();
+			m_isLimitExceeded = true;
 			return false;
 		}
+		if (m_sink) {
+			bool isContinue = bytesRead == 0
+			                  || m_sink(m_output.data() + m_preparedSize, bytesRead);
+			m_output.resize(m_preparedSize);
+			return isContinue;
+		}
+		return true;
+	}
+
+	bool isLimitExceeded() const {
+		return m_isLimitExceeded;
+	}
+
+	// 输出超限的错误信息
+	std::string getLimitMsg() const {
+		return "输出超限！输出超过了" + std::to_string(m_limit) + "字节";
 	}
 };
 
+/*
+ *	ConsoleOJ在各平台上提供相同的接口：
+ *  explicit ConsoleOJ(const std::string& programPath)
+ *  void setCPUAffinity(int cpuIndex)
+ *  void setOutputLimit(long long outputLimit)
+ *  void setMemoryLimit(long long memoryLimit)
+ *  void setInputFile(const std::string& inputFilePath)
+ *  void setPerfEnabled(bool isEnabled)
+ *  void setArguments(const std::vector<std::string>& arguments)
+ *  void setOutputSink(std::function<bool(const char*, size_t)> sink)
+ *  void setInputSource(std::function<size_t(char*, size_t)> source)
+ *  bool launchAndWait(std::string_view inputstr, long long timelimit,
+ *                     std::string& outputstr, RunStats& stats, std::string& errstr)
+ *  long long getExitCode() const
+ *  以及全局函数：
+ *  bool isMemoryLimitReliable() 内存超限能否判定为MLE
+ */
+#ifdef _WIN32
+#include "ConsoleOJWin.hpp"
+#else
+#include "ConsoleOJPosix.hpp"
+#endif
+
 #endif /* _XY0797_CONSOLEOJ */
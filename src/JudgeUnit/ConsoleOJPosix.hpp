@@ -0,0 +1,1132 @@
+/**
+ * \file    	ConsoleOJPosix.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		用于评测控制台程序的工具类，POSIX(Linux)实现
+ */
+#ifndef _XY0797_CONSOLEOJPOSIX
+#define _XY0797_CONSOLEOJPOSIX 1
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <linux/perf_event.h>
+#include <sys/stat.h>
+#include "ConsoleOJ.hpp"
+
+// 安全关闭文件描述符
+void Clfd_s(int& fd) {
+	if (fd >= 0) {
+		close(fd);
+		fd = -1;
+	}
+}
+
+// timeval转微秒
+long long timeval2us(const timeval& tv) {
+	return static_cast<long long>(tv.tv_sec) * 1000000ll + tv.tv_usec;
+}
+
+// 打开进程的pidfd，用于poll等待进程退出，内核不支持时返回-1
+int openPidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+	return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+	(void)pid;
+	return -1;
+#endif
+}
+
+// 统计性能计数器时，从创建放行管道到父进程关闭其写入端的过程需要串行执行
+// 否则并行评测时子进程会在exec之前继承其它评测的写入端，双方互相等待EOF而永远阻塞
+std::mutex& getGoPipeMutex() {
+	static std::mutex goPipeMutex;
+	return goPipeMutex;
+}
+
+// 忽略SIGPIPE，向已经退出的程序写入输入时只会得到EPIPE，不会结束评测程序
+void ignoreSIGPIPE() {
+	static bool isIgnored = [] {
+		signal(SIGPIPE, SIG_IGN);
+		return true;
+	}();
+	(void)isIgnored;
+}
+
+// 读取进程已消耗的CPU时间(us)，包括所有线程，进程已退出时返回-1
+long long getProcCPUTimeUs(pid_t pid) {
+	clockid_t clockID;
+	timespec ts;
+	if (clock_getcpuclockid(pid, &clockID) != 0 || clock_gettime(clockID, &ts) != 0) {
+		return -1;
+	}
+	return static_cast<long long>(ts.tv_sec) * 1000000ll + ts.tv_nsec / 1000;
+}
+
+// 子进程从评测程序继承的常驻内存的容差(KB)，不超过该值时忽略其影响
+// 否则最大常驻内存要超过继承值加上该值才认为是程序自身的峰值，内核对常驻内存的统计本身也有误差
+const long long INHERITED_RSS_SLACK_KB = 4096;
+
+// 读取/proc/<pid>/status中的峰值常驻内存VmHWM(KB)，失败时返回-1
+// 只调用异步信号安全的函数，fork之后的子进程中也可以使用
+long long readVmHWMKB(const char* statusPath) {
+	int fd = open(statusPath, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return -1;
+	}
+	char buffer[4096];
+	size_t len = 0;
+	while (len < sizeof(buffer)) {
+		ssize_t ret = read(fd, buffer + len, sizeof(buffer) - len);
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		}
+		if (ret <= 0) {
+			break;
+		}
+		len += static_cast<size_t>(ret);
+	}
+	close(fd);
+	const char key[] = "VmHWM:";
+	const size_t keyLen = sizeof(key) - 1;
+	for (size_t i = 0; i + keyLen <= len; i++) {
+		if (i > 0 && buffer[i - 1] != '\n') {
+			continue;
+		}
+		size_t j = 0;
+		while (j < keyLen && buffer[i + j] == key[j]) {
+			j++;
+		}
+		if (j < keyLen) {
+			continue;
+		}
+		size_t pos = i + keyLen;
+		while (pos < len && (buffer[pos] == ' ' || buffer[pos] == '\t')) {
+			pos++;
+		}
+		if (pos >= len || buffer[pos] < '0' || buffer[pos] > '9') {
+			return -1;
+		}
+		long long valueKB = 0;
+		while (pos < len && buffer[pos] >= '0' && buffer[pos] <= '9') {
+			valueKB = valueKB * 10 + (buffer[pos] - '0');
+			pos++;
+		}
+		return valueKB;
+	}
+	return -1;
+}
+
+// 本进程可以使用的逻辑CPU数
+int getAllowedCPUCnt() {
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) != 0) {
+		return 1;
+	}
+	return std::max(CPU_COUNT(&cpuSet), 1);
+}
+
+namespace INTERNAL_cgroup {
+	// 写入cgroup文件
+	bool writeFile(const std::string& filePath, const std::string& content) {
+		int fd = open(filePath.c_str(), O_WRONLY | O_CLOEXEC);
+		if (fd < 0) {
+			return false;
+		}
+		bool isOK = write(fd, content.data(), content.size())
+		            == static_cast<ssize_t>(content.size());
+		close(fd);
+		return isOK;
+	}
+
+	// cgroup的subtree_control中是否已启用memory控制器
+	bool isMemoryEnabled(const std::string& cgroupPath) {
+		std::ifstream fin(cgroupPath + "/cgroup.subtree_control");
+		std::string line;
+		std::getline(fin, line);
+		return line.find("memory") != std::string::npos;
+	}
+
+	/*
+	 *	准备用于创建子cgroup的父cgroup，返回其路径，无法使用时返回空文本
+	 *  cgroup v2不允许有进程的cgroup向子cgroup启用控制器，而评测程序所在的cgroup
+	 *  通常就有进程(评测程序自身)，因此先把评测程序移入叶子cgroup LocalOJ_judge，
+	 *  再在腾空的原cgroup上启用memory控制器
+	 *  原cgroup中还有其它进程时仍然失败，此时把评测程序移回原处
+	 */
+	std::string prepareBasePath() {
+		std::ifstream fin("/proc/self/cgroup");
+		std::string line, basePath;
+		while (std::getline(fin, line)) {
+			if (line.compare(0, 3, "0::") == 0) {
+				basePath = "/sys/fs/cgroup" + line.substr(3);
+				break;
+			}
+		}
+		if (basePath.empty()) {
+			return "";
+		}
+		if (isMemoryEnabled(basePath)
+		        || writeFile(basePath + "/cgroup.subtree_control", "+memory")) {
+			return basePath;
+		}
+		std::string leafPath = basePath + "/LocalOJ_judge";
+		if (mkdir(leafPath.c_str(), 0755) != 0 && errno != EEXIST) {
+			return "";
+		}
+		std::string pidStr = std::to_string(getpid());
+		if (writeFile(leafPath + "/cgroup.procs", pidStr)) {
+			if (writeFile(basePath + "/cgroup.subtree_control", "+memory")) {
+				return basePath;
+			}
+			writeFile(basePath + "/cgroup.procs", pidStr);
+		}
+		// 其它评测程序可能正在使用，删除失败时保留
+		rmdir(leafPath.c_str());
+		return "";
+	}
+
+	// 父cgroup只在第一次使用时准备一次，之后评测程序已不在原来的cgroup中
+	const std::string& getBasePath() {
+		static const std::string basePath = prepareBasePath();
+		return basePath;
+	}
+}
+
+// 能否按cgroup限制内存，不能时只能限制地址空间，超限的内存申请失败后表现为运行错误
+bool isMemoryLimitReliable() {
+	return !INTERNAL_cgroup::getBasePath().empty();
+}
+
+// 为单次运行创建的cgroup v2子cgroup，用于限制内存并统计峰值内存
+// 父cgroup由INTERNAL_cgroup::getBasePath准备，无法启用memory控制器时创建失败
+class MemoryCgroup {
+private:
+	// 子cgroup的目录，为空表示未创建
+	std::string m_path;
+
+	// 读取cgroup文件的第一行
+	std::string readFirstLine(const std::string& fileName) const {
+		std::ifstream fin(m_path + "/" + fileName);
+		std::string line;
+		std::getline(fin, line);
+		return line;
+	}
+
+public:
+	MemoryCgroup() = default;
+	MemoryCgroup(const MemoryCgroup&) = delete;
+	MemoryCgroup& operator=(const MemoryCgroup&) = delete;
+
+	~MemoryCgroup() {
+		remove();
+	}
+
+	// 在准备好的父cgroup下创建子cgroup并设置memory.max，失败时返回false
+	bool create(long long memoryLimit) {
+		using INTERNAL_cgroup::writeFile;
+		static std::atomic<int> cgroupCnt(0);
+		const std::string& basePath = INTERNAL_cgroup::getBasePath();
+		if (basePath.empty()) {
+			return false;
+		}
+		std::string path = basePath + "/LocalOJ_" + std::to_string(getpid())
+		                   + "_" + std::to_string(cgroupCnt++);
+		if (mkdir(path.c_str(), 0755) != 0) {
+			return false;
+		}
+		m_path = path;
+		if (!writeFile(m_path + "/memory.max", std::to_string(memoryLimit))) {
+			remove();
+			return false;
+		}
+		// 不允许使用交换空间绕过限制，内核不支持时忽略
+		writeFile(m_path + "/memory.swap.max", "0");
+		return true;
+	}
+
+	bool isCreated() const {
+		return !m_path.empty();
+	}
+
+	// 子进程写入"0"即可把自己移入该cgroup
+	std::string getProcsPath() const {
+		return m_path + "/cgroup.procs";
+	}
+
+	// 峰值内存(字节)，内核不支持memory.peak时返回-1
+	long long getPeakMemory() const {
+		std::string line = readFirstLine("memory.peak");
+		if (line.empty()) {
+			return -1;
+		}
+		return std::stoll(line);
+	}
+
+	// 是否有进程因内存超限被结束
+	bool isOOMKilled() const {
+		std::ifstream fin(m_path + "/memory.events");
+		std::string key;
+		long long value;
+		while (fin >> key >> value) {
+			if (key == "oom_kill" && value > 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// 删除子cgroup，刚被结束的进程可能还没离开，稍等后重试
+	void remove() {
+		if (m_path.empty()) {
+			return;
+		}
+		for (int i = 0; i < 100 && rmdir(m_path.c_str()) != 0 && errno == EBUSY; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		m_path.clear();
+	}
+};
+
+// 通过perf_event_open统计子进程的硬件性能计数器
+// 计数器在子进程exec时才开始计数，之后创建的线程与子进程也会被统计
+// 为了在perf_event_paranoid为2时也能使用，只统计用户态
+class PerfEventSet {
+private:
+	// 指令数、周期数、缓存未命中、分支预测失败
+	int m_fds[4] = { -1, -1, -1, -1 };
+
+	static int openEvent(pid_t pid, uint64_t config) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.enable_on_exec = 1;
+		attr.inherit = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		return static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, -1, -1,
+		                                PERF_FLAG_FD_CLOEXEC));
+	}
+
+	static long long readEvent(int fd) {
+		uint64_t value;
+		if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) {
+			return -1;
+		}
+		return static_cast<long long>(value);
+	}
+
+public:
+	PerfEventSet() = default;
+	PerfEventSet(const PerfEventSet&) = delete;
+	PerfEventSet& operator=(const PerfEventSet&) = delete;
+
+	~PerfEventSet() {
+		for (int& fd : m_fds) {
+			Clfd_s(fd);
+		}
+	}
+
+	// 为尚未exec的子进程打开计数器，内核或硬件不支持的计数器保持不可用
+	void open(pid_t pid) {
+		m_fds[0] = openEvent(pid, PERF_COUNT_HW_INSTRUCTIONS);
+		m_fds[1] = openEvent(pid, PERF_COUNT_HW_CPU_CYCLES);
+		m_fds[2] = openEvent(pid, PERF_COUNT_HW_CACHE_MISSES);
+		m_fds[3] = openEvent(pid, PERF_COUNT_HW_BRANCH_MISSES);
+	}
+
+	// 读取计数值，子进程退出并被回收后读取即可得到包括所有线程在内的总数
+	void readTo(PerfCounters& perf) const {
+		perf.instructions = readEvent(m_fds[0]);
+		perf.cycles = readEvent(m_fds[1]);
+		perf.cacheMisses = readEvent(m_fds[2]);
+		perf.branchMisses = readEvent(m_fds[3]);
+	}
+};
+
+class ConsoleOJ {
+private:
+	// 可执行文件路径、工作目录
+	std::string m_programPath;
+	std::string m_workingDirectory;
+
+	// 读取输出的文件描述符
+	int m_outputPipeRead = -1;
+
+	// 写入数据的文件描述符，由写输入文本线程关闭
+	int m_inputPipeWrite = -1;
+
+	// 写入数据，保证输入期间不被析构
+	const char* m_inputCStr = nullptr;
+	size_t m_inputCStrLen = 0;
+
+	// 作为标准输入的文件路径，为空则通过管道写入输入文本
+	std::string m_inputFilePath;
+
+	// 输入来源函数，设置后在写入线程中分段取得输入写入管道
+	std::function<size_t(char*, size_t)> m_inputSource;
+
+	// 传给目标程序的命令行参数，不含程序路径本身
+	std::vector<std::string> m_arguments;
+
+	// 上一次运行的退出代码，程序未正常退出时为-1
+	long long m_exitCode = -1;
+
+	// 内存限制(字节)，小于0表示不限制
+	long long m_memoryLimit = -1;
+
+	// 是否统计硬件性能计数器
+	bool m_isPerfEnabled = false;
+
+	// 绑定的逻辑CPU序号，-1表示不绑定
+	int m_cpuIndex = -1;
+
+	// 要求监视线程停止读取的管道，写入一个字节即可唤醒
+	int m_stopPipe[2] = { -1, -1 };
+
+	// 要求结束目标程序的管道，输出处理函数返回false或输出超限时写入一个字节
+	int m_killPipe[2] = { -1, -1 };
+
+	// 等待子进程时使用的定时器
+	int m_timerfd = -1;
+
+	// 监视线程读取结束标志
+	bool m_isReadDone = false;
+	std::mutex m_readDoneMutex;
+	std::condition_variable m_readDoneCV;
+
+	// 监视线程对象
+	std::thread m_checkProcThread;
+
+	// 写输入文本线程对象
+	std::thread m_WriteStrThread;
+
+	// 输出收集器
+	OutputCollector m_collector;
+
+	// 清空通知管道中残留的字节
+	static void drainPipe(int fd) {
+		char buffer[64];
+		while (read(fd, buffer, sizeof(buffer)) > 0) {
+		}
+	}
+
+	// 向通知管道写入一个字节
+	static void notifyPipe(int fd) {
+		char ch = 0;
+		ssize_t ret;
+		do {
+			ret = write(fd, &ch, 1);
+		} while (ret < 0 && errno == EINTR);
+	}
+
+	// 监视线程
+	// 只在有数据到达、管道关闭或被要求停止时唤醒
+	static void CheckProcThread(ConsoleOJ* const classthis) {
+		OutputCollector& collector = classthis->m_collector;
+		pollfd fds[2];
+		fds[0].fd = classthis->m_outputPipeRead;
+		fds[0].events = POLLIN;
+		fds[1].fd = classthis->m_stopPipe[0];
+		fds[1].events = POLLIN;
+		while (1) {
+			fds[0].revents = 0;
+			fds[1].revents = 0;
+			if (poll(fds, 2, -1) < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				break;
+			}
+			if (fds[1].revents != 0) {
+				// 被要求停止
+				break;
+			}
+			if (fds[0].revents == 0) {
+				continue;
+			}
+			char* buffer = collector.prepare();
+			ssize_t bytesRead = read(classthis->m_outputPipeRead, buffer, OUTPUT_READ_CHUNK);
+			if (bytesRead < 0 && errno == EINTR) {
+				collector.cancel();
+				continue;
+			}
+			if (bytesRead <= 0) {
+				// 管道已关闭(EOF)或读取出错
+				collector.cancel();
+				break;
+			}
+			if (!collector.commit(static_cast<size_t>(bytesRead))) {
+				// 输出超限或不再需要后续输出，要求结束目标程序
+				notifyPipe(classthis->m_killPipe[1]);
+				break;
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(classthis->m_readDoneMutex);
+			classthis->m_isReadDone = true;
+		}
+		classthis->m_readDoneCV.notify_all();
+	}
+
+	// 写输入文本线程，写完后关闭管道，目标程序即可读到EOF
+	static void WriteStrThread(ConsoleOJ* const classthis) {
+		if (classthis->m_inputSource) {
+			// 每取得一段就写入一段，输入不需要整个放在内存中
+			std::vector<char> buffer(INPUT_WRITE_CHUNK);
+			size_t len;
+			while ((len = classthis->m_inputSource(buffer.data(), buffer.size())) > 0
+			        && writeAll(classthis->m_inputPipeWrite, buffer.data(), len)) {
+			}
+		} else {
+			writeAll(classthis->m_inputPipeWrite, classthis->m_inputCStr,
+			         classthis->m_inputCStrLen);
+		}
+		Clfd_s(classthis->m_inputPipeWrite);
+	}
+
+	// 把数据全部写入fd，目标程序已经退出或关闭了输入时返回false
+	static bool writeAll(int fd, const char* data, size_t remainLen) {
+		while (remainLen > 0) {
+			ssize_t bytesWritten = write(fd, data, remainLen);
+			if (bytesWritten < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+			data += bytesWritten;
+			remainLen -= static_cast<size_t>(bytesWritten);
+		}
+		return true;
+	}
+
+	// 等待监视线程结束
+	// 超过waitms仍未读到EOF(例如后代进程仍持有管道)就强制停止读取
+	void joinCheckProcThread(long long waitms) {
+		if (!m_checkProcThread.joinable()) {
+			return;
+		}
+		{
+			std::unique_lock<std::mutex> lock(m_readDoneMutex);
+			if (!m_readDoneCV.wait_for(lock, std::chrono::milliseconds(waitms),
+			[this] { return m_isReadDone; })) {
+				notifyPipe(m_stopPipe[1]);
+			}
+		}
+		m_checkProcThread.join();
+	}
+
+	// 峰值内存(字节)，优先使用cgroup的统计，无法获取时为0
+	// rusage中的最大常驻内存包含fork时从评测程序继承的部分，只有继承的很少或明显超过继承值时才可信
+	// 否则使用运行期间采样到的VmHWM，exec之后的VmHWM只统计程序自身
+	static long long getPeakMemory(const MemoryCgroup& cgroup, const rusage& usage,
+	                               long long inheritedRssKB, long long sampledHWMKB) {
+		if (cgroup.isCreated()) {
+			long long peakMemory = cgroup.getPeakMemory();
+			if (peakMemory >= 0) {
+				return peakMemory;
+			}
+		}
+		long long maxRssKB = static_cast<long long>(usage.ru_maxrss);
+		if (inheritedRssKB >= 0 && (inheritedRssKB <= INHERITED_RSS_SLACK_KB
+		                            || maxRssKB > inheritedRssKB + INHERITED_RSS_SLACK_KB)) {
+			return maxRssKB * 1024ll;
+		}
+		return std::max(sampledHWMKB, 0ll) * 1024ll;
+	}
+
+	// 读取性能计数器，缺页与上下文切换次数来自rusage
+	static void readPerfCounters(const PerfEventSet& perfEvents, const rusage& usage,
+	                             PerfCounters& perf) {
+		perfEvents.readTo(perf);
+		perf.pageFaults = usage.ru_minflt + usage.ru_majflt;
+		perf.contextSwitches = usage.ru_nvcsw + usage.ru_nivcsw;
+	}
+
+	// 子进程已退出时结束其进程组中遗留的后代进程，再回收子进程
+	// 先结束再回收：子进程未被回收时进程组号不会被复用，不会误杀无关的进程
+	// 返回是否已回收，status与usage在回收后有效
+	static bool reapChild(pid_t pid, int& status, rusage& usage) {
+		siginfo_t info;
+		memset(&info, 0, sizeof(info));
+		if (waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOHANG | WNOWAIT) != 0
+		        || info.si_pid != pid) {
+			return false;
+		}
+		kill(-pid, SIGKILL);
+		return wait4(pid, &status, 0, &usage) == pid;
+	}
+
+	// 等待子进程退出、要求结束程序或定时器到期
+	// 定时器使用timerfd，精度为微秒，不需要按固定间隔轮询
+	// 返回1表示已退出(遗留的后代进程已结束，子进程已回收，status与usage有效)，2表示要求结束程序，0表示定时器到期
+	int waitChild(pid_t pid, int pidfd, int timerfd, long long timeoutUs,
+	              int& status, rusage& usage) {
+		itimerspec timerSpec;
+		memset(&timerSpec, 0, sizeof(timerSpec));
+		timeoutUs = std::max(timeoutUs, 1ll);
+		timerSpec.it_value.tv_sec = static_cast<time_t>(timeoutUs / 1000000);
+		timerSpec.it_value.tv_nsec = static_cast<long>(timeoutUs % 1000000) * 1000;
+		timerfd_settime(timerfd, 0, &timerSpec, NULL);
+		while (1) {
+			if (reapChild(pid, status, usage)) {
+				return 1;
+			}
+			pollfd fds[3];
+			fds[0].fd = m_killPipe[0];
+			fds[0].events = POLLIN;
+			fds[0].revents = 0;
+			fds[1].fd = timerfd;
+			fds[1].events = POLLIN;
+			fds[1].revents = 0;
+			fds[2].fd = pidfd;
+			fds[2].events = POLLIN;
+			fds[2].revents = 0;
+			// 没有pidfd时以10ms为间隔检查进程状态
+			int pollRet = poll(fds, pidfd >= 0 ? 3 : 2, pidfd >= 0 ? -1 : 10);
+			if (pollRet <= 0) {
+				continue;
+			}
+			// 进程恰好同时退出时优先按退出处理
+			if (fds[0].revents != 0 || fds[1].revents != 0) {
+				if (reapChild(pid, status, usage)) {
+					return 1;
+				}
+			}
+			if (fds[0].revents != 0) {
+				return 2;
+			}
+			if (fds[1].revents != 0) {
+				uint64_t expirations;
+				ssize_t readRet = read(timerfd, &expirations, sizeof(expirations));
+				(void)readRet;
+				return 0;
+			}
+		}
+	}
+
+public:
+	/*
+	 *	构造时传入：可执行文件路径
+	 */
+	explicit ConsoleOJ(const std::string& programPath) : m_programPath(programPath) {
+		// 处理工作目录
+		size_t found = programPath.find_last_of("/\\");
+		if (found != std::string::npos) {
+			this->m_workingDirectory = programPath.substr(0, found);
+		} else {
+			this->m_workingDirectory.clear();
+		}
+		// 创建通知管道
+		if (pipe2(m_stopPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+			m_stopPipe[0] = m_stopPipe[1] = -1;
+		}
+		if (pipe2(m_killPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+			m_killPipe[0] = m_killPipe[1] = -1;
+		}
+		m_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	}
+
+	~ConsoleOJ() {
+		Clfd_s(m_stopPipe[0]);
+		Clfd_s(m_stopPipe[1]);
+		Clfd_s(m_killPipe[0]);
+		Clfd_s(m_killPipe[1]);
+		Clfd_s(m_timerfd);
+	}
+
+	/*
+	 *	设置目标程序绑定的逻辑CPU，-1表示不绑定
+	 *  多个程序并行评测时，绑定到各自的核心可以让计时更稳定
+	 */
+	void setCPUAffinity(int cpuIndex) {
+		if (cpuIndex < 0 || cpuIndex >= CPU_SETSIZE) {
+			m_cpuIndex = -1;
+		} else {
+			m_cpuIndex = cpuIndex;
+		}
+	}
+
+	/*
+	 *	设置输出限制(字节)，小于0表示不限制
+	 *  输出总量超过限制时目标程序会被立即结束，launchAndWait返回false并报告输出超限
+	 */
+	void setOutputLimit(long long outputLimit) {
+		m_collector.setLimit(outputLimit);
+	}
+
+	/*
+	 *	设置内存限制(字节)，小于0表示不限制
+	 *  优先使用cgroup v2的memory.max限制常驻内存，超限的程序被内核结束，launchAndWait报告内存超限
+	 *  评测程序没有可用的cgroup时改用RLIMIT_AS限制地址空间，超限的分配会失败
+	 */
+	void setMemoryLimit(long long memoryLimit) {
+		m_memoryLimit = memoryLimit;
+	}
+
+	/*
+	 *	设置是否统计硬件性能计数器，结果写在运行统计中
+	 *  缺页次数与上下文切换次数总是可以得到，其余计数器需要内核与硬件支持
+	 */
+	void setPerfEnabled(bool isEnabled) {
+		m_isPerfEnabled = isEnabled;
+	}
+
+	/*
+	 *	设置作为标准输入的文件，传入空串则恢复为通过管道写入输入文本
+	 *  设置后目标程序直接以只读方式继承该文件，launchAndWait忽略输入文本
+	 */
+	void setInputFile(const std::string& inputFilePath) {
+		m_inputFilePath = inputFilePath;
+	}
+
+	/*
+	 *	设置传给目标程序的命令行参数，不经过shell，原样传递
+	 */
+	void setArguments(const std::vector<std::string>& arguments) {
+		m_arguments = arguments;
+	}
+
+	/*
+	 *	获取上一次运行的退出代码，程序超时、被结束或未能启动时为-1
+	 *  返回值不为0时launchAndWait返回false，可以通过这里区分程序的返回值与其它错误
+	 */
+	long long getExitCode() const {
+		return m_exitCode;
+	}
+
+	/*
+	 *	设置输出处理函数，传入空函数则恢复为保存输出
+	 *  设置后输出不再保存，每读到一段就在监视线程中调用一次
+	 *  返回false表示不再需要后续输出，目标程序会被立即结束，launchAndWait返回false
+	 */
+	void setOutputSink(std::function<bool(const char*, size_t)> sink) {
+		m_collector.setSink(std::move(sink));
+	}
+
+	/*
+	 *	设置输入来源函数，传入空函数则恢复为写入输入文本
+	 *  设置后launchAndWait忽略输入文本，在写入线程中反复调用source(缓冲区, 容量)
+	 *  取得下一段输入并写入管道，返回0表示输入结束，设置了输入文件时不会被调用
+	 */
+	void setInputSource(std::function<size_t(char*, size_t)> source) {
+		m_inputSource = std::move(source);
+	}
+
+	/*
+	 *	启动进程，返回目标程序是否在时限内成功运行
+	 *  与Windows实现的语义相同，参数说明见ConsoleOJWin.hpp
+	 *  输入文本写完后关闭管道，目标程序读到的是真正的EOF，不附加^Z
+	 *  目标程序在独立的进程组中运行，程序退出或被结束时整个进程组一起结束
+	 *  CPU时间按剩余额度设置timerfd检查，RLIMIT_CPU作为内核侧的兜底限制
+	 */
+	bool launchAndWait(std::string_view inputstr, long long timelimit,
+	                   std::string& outputstr, RunStats& stats, std::string& errstr) {
+		stats = RunStats();
+		m_exitCode = -1;
+		ignoreSIGPIPE();
+		if (m_stopPipe[0] < 0 || m_killPipe[0] < 0 || m_timerfd < 0) {
+			errstr = "创建通知管道失败！";
+			return false;
+		}
+		drainPipe(m_stopPipe[0]);
+		drainPipe(m_killPipe[0]);
+
+		// 所有管道都带O_CLOEXEC，并行评测时不会被其它子进程继承
+		int inputPipe[2] = { -1, -1 };
+		int outputPipe[2] = { -1, -1 };
+		int execErrPipe[2] = { -1, -1 };
+		// 统计性能计数器时，子进程等父进程打开计数器后再exec
+		int goPipe[2] = { -1, -1 };
+		pid_t pid = -1;
+		// 目标程序的进程组，用于结束其遗留的后代进程，进程被回收后置为-1
+		pid_t pgid = -1;
+		// 待测程序可以使用的逻辑CPU
+		int cpuIndex = m_cpuIndex;
+		// 开始计时的时刻
+		std::chrono::steady_clock::time_point start;
+		// 限制内存的cgroup，未创建时使用RLIMIT_AS
+		MemoryCgroup cgroup;
+		bool isLimitAS = false;
+		// 子进程exec之前的峰值常驻内存(KB)，即从评测程序继承的部分，未知时为-1
+		long long inheritedRssKB = -1;
+		// 运行期间采样到的程序自身的峰值常驻内存(KB)，未采样时为-1
+		long long sampledHWMKB = -1;
+		std::string statusPath;
+		// 性能计数器
+		PerfEventSet perfEvents;
+		try {
+			if (!m_inputFilePath.empty()) {
+				// 输入文件直接作为子进程的标准输入，没有写入端
+				inputPipe[0] = open(m_inputFilePath.c_str(), O_RDONLY | O_CLOEXEC);
+				if (inputPipe[0] < 0) {
+					errstr = std::string("打开输入文件失败！") + strerror(errno);
+					throw 1;
+				}
+			} else if (pipe2(inputPipe, O_CLOEXEC) != 0) {
+				errstr = "创建输入管道失败！";
+				throw 1;
+			}
+			if (pipe2(outputPipe, O_CLOEXEC) != 0) {
+				errstr = "创建输出管道失败！";
+				throw 2;
+			}
+			// 子进程exec失败时通过该管道报告errno，exec成功则管道被自动关闭
+			if (pipe2(execErrPipe, O_CLOEXEC) != 0) {
+				errstr = "创建进程失败！";
+				throw 3;
+			}
+			std::unique_lock<std::mutex> goPipeLock(getGoPipeMutex(), std::defer_lock);
+			if (m_isPerfEnabled) {
+				goPipeLock.lock();
+				if (pipe2(goPipe, O_CLOEXEC) != 0) {
+					errstr = "创建进程失败！";
+					throw 3;
+				}
+			}
+
+			// fork之后子进程只能调用异步信号安全的函数，所有字符串需要提前准备
+			std::string exePath = m_programPath;
+			if (!exePath.empty() && exePath[0] != '/') {
+				// 子进程会切换工作目录，相对路径需要先转为绝对路径
+				char cwdBuffer[4096];
+				if (getcwd(cwdBuffer, sizeof(cwdBuffer)) != NULL) {
+					exePath = std::string(cwdBuffer) + "/" + exePath;
+				}
+			}
+			std::vector<char*> argv;
+			argv.push_back(const_cast<char*>(exePath.c_str()));
+			for (const auto& e : m_arguments) {
+				argv.push_back(const_cast<char*>(e.c_str()));
+			}
+			argv.push_back(NULL);
+			const char* workingDirectoryPtr = NULL;
+			if (!m_workingDirectory.empty()) {
+				workingDirectoryPtr = m_workingDirectory.c_str();
+			}
+			// 兜底的CPU时间限制(s)，超过软限制收到SIGXCPU，超过硬限制收到SIGKILL
+			rlimit cpuLimit;
+			cpuLimit.rlim_cur = static_cast<rlim_t>(timelimit / 1000 + 2);
+			cpuLimit.rlim_max = cpuLimit.rlim_cur + 1;
+			// 内存限制
+			std::string cgroupProcsPath;
+			if (m_memoryLimit >= 0 && cgroup.create(m_memoryLimit)) {
+				cgroupProcsPath = cgroup.getProcsPath();
+			}
+			const char* cgroupProcsPathPtr = NULL;
+			if (!cgroupProcsPath.empty()) {
+				cgroupProcsPathPtr = cgroupProcsPath.c_str();
+			}
+			rlimit memoryLimit;
+			memoryLimit.rlim_cur = memoryLimit.rlim_max = static_cast<rlim_t>(m_memoryLimit);
+			isLimitAS = m_memoryLimit >= 0 && cgroupProcsPathPtr == NULL;
+
+			start = std::chrono::steady_clock::now();
+			pid = fork();
+			if (pid < 0) {
+				errstr = "创建进程失败！";
+				throw 3;
+			}
+			if (pid == 0) {
+				// 子进程
+				setpgid(0, 0);
+				dup2(inputPipe[0], STDIN_FILENO);
+				dup2(outputPipe[1], STDOUT_FILENO);
+				dup2(outputPipe[1], STDERR_FILENO);
+				// 恢复默认的信号处理与信号掩码
+				signal(SIGPIPE, SIG_DFL);
+				sigset_t emptySet;
+				sigemptyset(&emptySet);
+				sigprocmask(SIG_SETMASK, &emptySet, NULL);
+				// 绑定CPU，必须在程序开始执行之前
+				if (cpuIndex >= 0) {
+					cpu_set_t cpuSet;
+					CPU_ZERO(&cpuSet);
+					CPU_SET(cpuIndex, &cpuSet);
+					sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+				}
+				setrlimit(RLIMIT_CPU, &cpuLimit);
+				bool isReady = true;
+				if (cgroupProcsPathPtr != NULL) {
+					// 移入限制内存的cgroup，失败则不执行程序
+					int procsFd = open(cgroupProcsPathPtr, O_WRONLY | O_CLOEXEC);
+					isReady = procsFd >= 0 && write(procsFd, "0", 1) == 1;
+				} else if (isLimitAS) {
+					setrlimit(RLIMIT_AS, &memoryLimit);
+				}
+				if (goPipe[0] >= 0) {
+					// 等待父进程打开性能计数器，父进程关闭写入端后即可继续
+					close(goPipe[1]);
+					char ch;
+					while (read(goPipe[0], &ch, 1) < 0 && errno == EINTR) {
+					}
+				}
+				// exec会把当前的峰值常驻内存并入rusage，先报告给父进程以便扣除
+				long long hwmKB = readVmHWMKB("/proc/self/status");
+				ssize_t hwmRet = write(execErrPipe[1], &hwmKB, sizeof(hwmKB));
+				(void)hwmRet;
+				if (isReady && (workingDirectoryPtr == NULL || chdir(workingDirectoryPtr) == 0)) {
+					execv(argv[0], argv.data());
+				}
+				int err = errno;
+				ssize_t ret = write(execErrPipe[1], &err, sizeof(err));
+				(void)ret;
+				_exit(127);
+			}
+			// 父进程也设置一次，避免结束进程组时子进程还没来得及设置
+			setpgid(pid, pid);
+			pgid = pid;
+
+			// 打开性能计数器后放行子进程
+			if (goPipe[1] >= 0) {
+				perfEvents.open(pid);
+			}
+			Clfd_s(goPipe[0]);
+			Clfd_s(goPipe[1]);
+			if (goPipeLock.owns_lock()) {
+				goPipeLock.unlock();
+			}
+
+			// 子进程已经持有管道的另一端，父进程关闭自己的副本
+			// 这样子进程退出后读取端才能收到EOF，写入端也不会被阻塞
+			Clfd_s(inputPipe[0]);
+			Clfd_s(outputPipe[1]);
+			Clfd_s(execErrPipe[1]);
+
+			// 先读取子进程继承的峰值常驻内存，再等待exec的结果
+			size_t hwmLen = 0;
+			long long hwmKB = -1;
+			while (hwmLen < sizeof(hwmKB)) {
+				ssize_t ret = read(execErrPipe[0], reinterpret_cast<char*>(&hwmKB) + hwmLen,
+				                   sizeof(hwmKB) - hwmLen);
+				if (ret < 0 && errno == EINTR) {
+					continue;
+				}
+				if (ret <= 0) {
+					break;
+				}
+				hwmLen += static_cast<size_t>(ret);
+			}
+			inheritedRssKB = hwmLen == sizeof(hwmKB) ? hwmKB : -1;
+			statusPath = "/proc/" + std::to_string(pid) + "/status";
+			int execErr = 0;
+			ssize_t errLen;
+			do {
+				errLen = read(execErrPipe[0], &execErr, sizeof(execErr));
+			} while (errLen < 0 && errno == EINTR);
+			Clfd_s(execErrPipe[0]);
+			if (errLen > 0) {
+				waitpid(pid, NULL, 0);
+				pid = -1;
+				errstr = std::string("创建进程失败！") + strerror(execErr);
+				throw 3;
+			}
+		} catch (int) {
+			Clfd_s(inputPipe[0]);
+			Clfd_s(inputPipe[1]);
+			Clfd_s(outputPipe[0]);
+			Clfd_s(outputPipe[1]);
+			Clfd_s(execErrPipe[0]);
+			Clfd_s(execErrPipe[1]);
+			Clfd_s(goPipe[0]);
+			Clfd_s(goPipe[1]);
+			return false;
+		}
+
+		m_outputPipeRead = outputPipe[0];
+		int pidfd = openPidfd(pid);
+		try {
+			// 启动监视线程
+			m_isReadDone = false;
+			// 接管调用者的输出缓冲区，复用其已分配的空间
+			m_collector.start(outputstr);
+			m_checkProcThread = std::thread(&CheckProcThread, this);
+
+			// 写入测试输入，使用输入文件时没有写入端
+			m_inputPipeWrite = inputPipe[1];
+			if (m_inputPipeWrite >= 0 && (!inputstr.empty() || m_inputSource)) {
+				// 异步写入数据
+				m_inputCStr = inputstr.data();
+				m_inputCStrLen = inputstr.size();
+				// 启动数据写入线程
+				m_WriteStrThread = std::thread(&WriteStrThread, this);
+			} else {
+				// 没有输入，直接关闭
+				Clfd_s(m_inputPipeWrite);
+			}
+
+			// 待测程序可以同时使用的逻辑CPU数，决定CPU时间增长的最快速度
+			int cpuCnt = cpuIndex >= 0 ? 1 : getAllowedCPUCnt();
+			long long timeLimitUs = timelimit * 1000ll;
+			long long lastCPUTimeUs = 0;
+			// 真实时间到达时间限制后才开始检查程序是否被阻塞
+			long long nextIdleCheckUs = timeLimitUs;
+
+			int status = 0;
+			rusage usage;
+			memset(&usage, 0, sizeof(usage));
+			while (1) {
+				// 剩余的CPU额度至少要经过这么长的真实时间才能用完，在那时再检查
+				long long curCPUTimeUs = std::max(getProcCPUTimeUs(pid), 0ll);
+				long long waitUs = std::max((timeLimitUs - curCPUTimeUs) / cpuCnt,
+				                            MIN_CPU_PROGRESS_US);
+				waitUs = std::min(waitUs, nextIdleCheckUs - stats.wallTimeUs);
+				int waitResult = waitChild(pid, pidfd, m_timerfd, waitUs, status, usage);
+				stats.wallTimeUs = std::chrono::duration_cast<std::chrono::microseconds>
+				                   (std::chrono::steady_clock::now() - start).count();
+				if (waitResult == 1) {
+					// 说明进程退出了
+					break;
+				} else if (waitResult == 2) {
+					if (m_collector.isLimitExceeded()) {
+						errstr = m_collector.getLimitMsg();
+					} else {
+						errstr = "输出处理函数要求结束程序！";
+					}
+					throw 4;
+				}
+				// 程序还在运行，采样其自身的峰值常驻内存
+				sampledHWMKB = std::max(sampledHWMKB, readVmHWMKB(statusPath.c_str()));
+				// 需要判断是不是真TLE了
+				curCPUTimeUs = getProcCPUTimeUs(pid);
+				if (curCPUTimeUs < 0) {
+					// 进程刚刚退出，下一次等待时回收
+					continue;
+				}
+				stats.cpuTimeUs = curCPUTimeUs;
+				if (curCPUTimeUs > timeLimitUs) {
+					errstr = "执行超时！";
+					throw 4;
+				}
+				if (stats.wallTimeUs >= nextIdleCheckUs) {
+					nextIdleCheckUs = stats.wallTimeUs + IDLE_CHECK_INTERVAL * 1000ll;
+					// 判断被阻塞的情况
+					if (curCPUTimeUs - lastCPUTimeUs < MIN_CPU_PROGRESS_US) {
+						errstr = "程序疑似被阻塞，执行超时！";
+						throw 4;
+					}
+					lastCPUTimeUs = curCPUTimeUs;
+					// 再判断真实耗时过大的情况
+					if (stats.wallTimeUs > MAX_WALL_TIME_RATIO * timeLimitUs) {
+						errstr = "评测机负载过大，执行超时！";
+						throw 4;
+					}
+				}
+			}
+			// 遗留的后代进程已在回收前结束，输出管道可以尽快收到EOF
+			// 回收后进程组号可能被复用，不能再向其发送信号
+			pid = -1;
+			pgid = -1;
+
+			// 获取时间与内存，rusage包含所有线程与已回收的子进程
+			stats.cpuTimeUs = timeval2us(usage.ru_utime) + timeval2us(usage.ru_stime);
+			stats.peakMemory = getPeakMemory(cgroup, usage, inheritedRssKB, sampledHWMKB);
+			if (m_isPerfEnabled) {
+				readPerfCounters(perfEvents, usage, stats.perf);
+			}
+
+			// 被RLIMIT_CPU结束的进程也会走到这里
+			if (stats.cpuTimeUs > timeLimitUs
+			        || (WIFSIGNALED(status) && WTERMSIG(status) == SIGXCPU)) {
+				errstr = "执行超时！";
+				throw 4;
+			}
+
+			// 被cgroup结束或常驻内存超过限制，没有cgroup时只能依靠RLIMIT_AS
+			if (m_memoryLimit >= 0 && cgroup.isCreated()
+			        && (cgroup.isOOMKilled() || stats.peakMemory > m_memoryLimit)) {
+				errstr = getMemoryLimitMsg(m_memoryLimit);
+				throw 4;
+			}
+
+			// 获取进程退出状态
+			// 使用RLIMIT_AS时超限的分配只会失败，无法与其它运行错误区分
+			if (WIFEXITED(status)) {
+				m_exitCode = WEXITSTATUS(status);
+			}
+			std::string memoryHint = isLimitAS ? "(地址空间受内存限制，可能是申请内存失败)" : "";
+			if (WIFSIGNALED(status)) {
+				errstr = "程序被信号" + std::to_string(WTERMSIG(status)) + "("
+				         + strsignal(WTERMSIG(status)) + ")终止！" + memoryHint;
+				throw 4;
+			}
+			if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+				errstr = "程序返回值为" + std::to_string(WEXITSTATUS(status)) + "！" + memoryHint;
+				// 程序正常退出，读完剩余输出再返回，调用者可能需要按返回值处理输出
+				joinCheckProcThread(OUTPUT_DRAIN_WAIT);
+				throw 4;
+			}
+
+			// 获取输出
+			joinCheckProcThread(OUTPUT_DRAIN_WAIT);
+			if (m_collector.isLimitExceeded()) {
+				// 进程退出后读取剩余输出时才发现超限
+				errstr = m_collector.getLimitMsg();
+				throw 4;
+			}
+			if (m_WriteStrThread.joinable()) {
+				m_WriteStrThread.join();
+			}
+			m_collector.finish(outputstr, true);
+
+			// 关闭管道
+			Clfd_s(m_outputPipeRead);
+			Clfd_s(pidfd);
+			return true;
+		} catch (int) {
+			// 结束整个进程组并回收
+			if (pgid > 0) {
+				kill(-pgid, SIGKILL);
+			}
+			if (pid > 0) {
+				kill(pid, SIGKILL);
+				rusage usage;
+				if (wait4(pid, NULL, 0, &usage) == pid) {
+					stats.cpuTimeUs = timeval2us(usage.ru_utime) + timeval2us(usage.ru_stime);
+					stats.peakMemory = getPeakMemory(cgroup, usage, inheritedRssKB, sampledHWMKB);
+					if (m_isPerfEnabled) {
+						readPerfCounters(perfEvents, usage, stats.perf);
+					}
+				}
+			}
+			// 目标程序结束后写入线程会因EPIPE退出
+			if (m_WriteStrThread.joinable()) {
+				m_WriteStrThread.join();
+			}
+			joinCheckProcThread(0);
+			m_collector.finish(outputstr, false);
+			Clfd_s(m_outputPipeRead);
+			Clfd_s(pidfd);
+			return false;
+		}
+	}
+};
+
+#endif /* _XY0797_CONSOLEOJPOSIX */
@@ -0,0 +1,741 @@
+/**
+ * \file    	ConsoleOJWin.hpp
+ * \author  	XY0797
+ * \date    	2024.8.6
+ * \brief		用于评测控制台程序的工具类，Windows实现
+ */
+#ifndef _XY0797_CONSOLEOJWIN
+#define _XY0797_CONSOLEOJWIN 1
+
+#include <iostream>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <windows.h>
+#include "ConsoleOJ.hpp"
+
+// 安全关闭句柄
+void Clhandle_s(HANDLE& hd) {
+	if (hd != INVALID_HANDLE_VALUE) {
+		CloseHandle(hd);
+		hd = INVALID_HANDLE_VALUE;
+	}
+}
+
+// 文件时间(100ns)转微秒
+long long fileTime2us(const LARGE_INTEGER& fileTime) {
+	return fileTime.QuadPart / 10ll;
+}
+
+// 读取作业对象中所有进程已消耗的CPU时间(us)，包括已经退出的进程
+long long getJobCPUTimeUs(HANDLE hJob) {
+	JOBOBJECT_BASIC_ACCOUNTING_INFORMATION accountingInfo;
+	if (!QueryInformationJobObject(hJob, JobObjectBasicAccountingInformation,
+	                               &accountingInfo, sizeof(accountingInfo), NULL)) {
+		return 0;
+	}
+	return fileTime2us(accountingInfo.TotalUserTime)
+	       + fileTime2us(accountingInfo.TotalKernelTime);
+}
+
+// 读取作业对象中所有进程的缺页次数
+long long getJobPageFaults(HANDLE hJob) {
+	JOBOBJECT_BASIC_ACCOUNTING_INFORMATION accountingInfo;
+	if (!QueryInformationJobObject(hJob, JobObjectBasicAccountingInformation,
+	                               &accountingInfo, sizeof(accountingInfo), NULL)) {
+		return -1;
+	}
+	return accountingInfo.TotalPageFaultCount;
+}
+
+// 读取作业对象中所有进程提交内存的峰值(字节)
+long long getJobPeakMemory(HANDLE hJob) {
+	JOBOBJECT_EXTENDED_LIMIT_INFORMATION limitInfo;
+	if (!QueryInformationJobObject(hJob, JobObjectExtendedLimitInformation,
+	                               &limitInfo, sizeof(limitInfo), NULL)) {
+		return 0;
+	}
+	return static_cast<long long>(limitInfo.PeakJobMemoryUsed);
+}
+
+// 创建限制CPU时间与内存的作业对象，失败时返回INVALID_HANDLE_VALUE
+// 用户态CPU时间达到限制时内核结束作业中的所有进程，关闭作业对象时也会结束遗留的进程
+// 内存限制小于0表示不限制，否则通过hPort接收内存超限的通知
+HANDLE createLimitJob(long long timelimit, long long memoryLimit, HANDLE& hPort) {
+	hPort = INVALID_HANDLE_VALUE;
+	HANDLE hJob = CreateJobObjectA(NULL, NULL);
+	if (hJob == NULL) {
+		return INVALID_HANDLE_VALUE;
+	}
+	JOBOBJECT_EXTENDED_LIMIT_INFORMATION limitInfo;
+	ZeroMemory(&limitInfo, sizeof(limitInfo));
+	limitInfo.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_JOB_TIME
+	        | JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE
+	        | JOB_OBJECT_LIMIT_DIE_ON_UNHANDLED_EXCEPTION;
+	// 限制略大于时间限制，超时与否以统计到的CPU时间为准
+	limitInfo.BasicLimitInformation.PerJobUserTimeLimit.QuadPart =
+	    (timelimit + 1) * 10000ll;
+	if (memoryLimit >= 0) {
+		// 限制的是作业中所有进程提交的内存之和
+		limitInfo.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_JOB_MEMORY;
+		limitInfo.JobMemoryLimit = static_cast<SIZE_T>(memoryLimit);
+	}
+	if (!SetInformationJobObject(hJob, JobObjectExtendedLimitInformation,
+	                             &limitInfo, sizeof(limitInfo))) {
+		CloseHandle(hJob);
+		return INVALID_HANDLE_VALUE;
+	}
+	if (memoryLimit >= 0) {
+		// 分配失败的内存不计入峰值，只能通过完成端口得知是否触及了内存限制
+		hPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+		JOBOBJECT_ASSOCIATE_COMPLETION_PORT portInfo;
+		portInfo.CompletionKey = hJob;
+		portInfo.CompletionPort = hPort;
+		if (hPort == NULL
+		        || !SetInformationJobObject(hJob, JobObjectAssociateCompletionPortInformation,
+		                                    &portInfo, sizeof(portInfo))) {
+			if (hPort != NULL) {
+				CloseHandle(hPort);
+			}
+			hPort = INVALID_HANDLE_VALUE;
+			CloseHandle(hJob);
+			return INVALID_HANDLE_VALUE;
+		}
+	}
+	return hJob;
+}
+
+// 取出完成端口中作业对象的全部通知，返回其中是否有内存超限
+bool isJobMemoryLimitHit(HANDLE hPort) {
+	if (hPort == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	bool isHit = false;
+	DWORD msgID;
+	ULONG_PTR key;
+	LPOVERLAPPED overlapped;
+	while (GetQueuedCompletionStatus(hPort, &msgID, &key, &overlapped, 0)) {
+		if (msgID == JOB_OBJECT_MSG_JOB_MEMORY_LIMIT
+		        || msgID == JOB_OBJECT_MSG_PROCESS_MEMORY_LIMIT) {
+			isHit = true;
+		}
+	}
+	return isHit;
+}
+
+// 作业对象总能限制内存并报告超限
+bool isMemoryLimitReliable() {
+	return true;
+}
+
+// 输出管道的缓冲区大小
+const DWORD OUTPUT_PIPE_BUFFER_SIZE = 64 * 1024;
+
+// 创建管道到创建进程的过程需要串行执行
+// 否则并行评测时子进程会继承其它评测的管道句柄，导致管道迟迟收不到EOF
+std::mutex& getLaunchMutex() {
+	static std::mutex launchMutex;
+	return launchMutex;
+}
+
+class ConsoleOJ {
+private:
+	// 可执行文件路径、工作目录、命令行参数
+	std::string m_programPath;
+	std::string m_workingDirectory;
+
+	// 读取输出的句柄，重叠IO模式
+	HANDLE m_outputPipeRead = INVALID_HANDLE_VALUE;
+
+	// 写入数据的句柄
+	HANDLE m_inputPipeWrite = INVALID_HANDLE_VALUE;
+
+	// 写入数据，保证输入期间不被析构
+	const char* m_inputCStr = nullptr;
+	DWORD m_inputCStrLen = 0;
+
+	// 作为标准输入的文件路径，为空则通过管道写入输入文本
+	std::string m_inputFilePath;
+
+	// 输入来源函数，设置后在写入线程中分段取得输入写入管道
+	std::function<size_t(char*, size_t)> m_inputSource;
+
+	// 传给目标程序的命令行参数，不含程序路径本身
+	std::vector<std::string> m_arguments;
+
+	// 上一次运行的退出代码，程序未正常退出时为-1
+	long long m_exitCode = -1;
+
+	// 内存限制(字节)，小于0表示不限制
+	long long m_memoryLimit = -1;
+
+	// 是否统计性能计数器
+	bool m_isPerfEnabled = false;
+
+	// 是否已经启动
+	bool isLaunched = false;
+
+	// 绑定的逻辑CPU序号，-1表示不绑定
+	int m_cpuIndex = -1;
+
+	// 析构事件同步对象
+	HANDLE m_hExitEvent = INVALID_HANDLE_VALUE;
+
+	// 将要析构标志位
+	bool m_willExit = false;
+
+	// 要求监视线程停止读取的事件
+	HANDLE m_hStopReadEvent = INVALID_HANDLE_VALUE;
+
+	// 监视线程读取结束的事件
+	HANDLE m_hReadDoneEvent = INVALID_HANDLE_VALUE;
+
+	// 监视线程对象
+	std::thread m_checkProcThread;
+
+	// 写输入文本线程对象
+	std::thread m_WriteStrThread;
+
+	// 输出收集器
+	OutputCollector m_collector;
+
+	// 要求结束目标程序的事件，输出处理函数返回false或输出超限时触发
+	HANDLE m_hKillEvent = INVALID_HANDLE_VALUE;
+
+	// 监视线程
+	// 只在有数据到达、管道关闭或被要求停止时唤醒
+	static void CheckProcThread(ConsoleOJ* const classthis) {
+		OutputCollector& collector = classthis->m_collector;
+		OVERLAPPED overlapped;
+		ZeroMemory(&overlapped, sizeof(overlapped));
+		overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		HANDLE hWaitHandle[3];
+		hWaitHandle[0] = overlapped.hEvent;
+		hWaitHandle[1] = classthis->m_hStopReadEvent;
+		hWaitHandle[2] = classthis->m_hExitEvent;
+		while (1) {
+			char* buffer = collector.prepare();
+			DWORD bytesRead = 0;
+			ResetEvent(overlapped.hEvent);
+			BOOL isOK = ReadFile(classthis->m_outputPipeRead, buffer,
+			                     static_cast<DWORD>(OUTPUT_READ_CHUNK), &bytesRead,
+			                     &overlapped);
+			bool isStop = false;
+			if (!isOK && GetLastError() == ERROR_IO_PENDING) {
+				DWORD waitResult = WaitForMultipleObjects(3, hWaitHandle, FALSE, INFINITE);
+				if (waitResult != WAIT_OBJECT_0) {
+					// 被要求停止，取消读取请求
+					isStop = true;
+					CancelIoEx(classthis->m_outputPipeRead, &overlapped);
+				}
+				isOK = GetOverlappedResult(classthis->m_outputPipeRead, &overlapped,
+				                           &bytesRead, TRUE);
+			}
+			if (!isOK) {
+				// 管道已关闭(EOF)或读取被取消
+				collector.cancel();
+				break;
+			}
+			if (!collector.commit(bytesRead)) {
+				// 输出超限或不再需要后续输出，要求结束目标程序
+				SetEvent(classthis->m_hKillEvent);
+				break;
+			}
+			if (isStop) {
+				break;
+			}
+		}
+		CloseHandle(overlapped.hEvent);
+		SetEvent(classthis->m_hReadDoneEvent);
+	}
+
+	// 等待监视线程结束
+	// 超过waitms仍未读到EOF(例如后代进程仍持有管道)就强制停止读取
+	void joinCheckProcThread(long long waitms) {
+		if (!m_checkProcThread.joinable()) {
+			return;
+		}
+		if (WaitForSingleObject(m_hReadDoneEvent, static_cast<DWORD>(waitms)) != WAIT_OBJECT_0) {
+			SetEvent(m_hStopReadEvent);
+		}
+		m_checkProcThread.join();
+	}
+
+	// 创建输出管道
+	// 读取端是父进程使用的重叠IO命名管道，不可继承；写入端可被子进程继承
+	bool createOutputPipe(HANDLE& outputPipeWrite, SECURITY_ATTRIBUTES& securityAttributes) {
+		static std::atomic<unsigned long> pipeCnt(0);
+		std::string pipeName = "\\\\.\\pipe\\LocalOJ_"
+		                       + std::to_string(GetCurrentProcessId()) + "_"
+		                       + std::to_string(pipeCnt++);
+		m_outputPipeRead = CreateNamedPipeA(pipeName.c_str(),
+		                                    PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED
+		                                    | FILE_FLAG_FIRST_PIPE_INSTANCE,
+		                                    PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT
+		                                    | PIPE_REJECT_REMOTE_CLIENTS,
+		                                    1, OUTPUT_PIPE_BUFFER_SIZE,
+		                                    OUTPUT_PIPE_BUFFER_SIZE, 0, NULL);
+		if (m_outputPipeRead == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		outputPipeWrite = CreateFileA(pipeName.c_str(), GENERIC_WRITE, 0,
+		                              &securityAttributes, OPEN_EXISTING,
+		                              FILE_ATTRIBUTE_NORMAL, NULL);
+		if (outputPipeWrite == INVALID_HANDLE_VALUE) {
+			Clhandle_s(m_outputPipeRead);
+			return false;
+		}
+		return true;
+	}
+
+	static void WriteStrThread(ConsoleOJ* const classthis) {
+		DWORD bytesWritten;
+		if (classthis->m_inputSource) {
+			// 每取得一段就写入一段，输入不需要整个放在内存中
+			std::vector<char> buffer(INPUT_WRITE_CHUNK);
+			size_t len;
+			while ((len = classthis->m_inputSource(buffer.data(), buffer.size())) > 0) {
+				if (!WriteFile(classthis->m_inputPipeWrite, buffer.data(),
+				               static_cast<DWORD>(len), &bytesWritten, NULL)) {
+					return;
+				}
+			}
+		} else if (!WriteFile(classthis->m_inputPipeWrite, classthis->m_inputCStr,
+		                      classthis->m_inputCStrLen, &bytesWritten, NULL)) {
+			return;
+		}
+		// 输入文本之后单独写入^Z，不需要为此复制一份输入文本
+		const char ctrlZ = static_cast<char>(26);
+		WriteFile(classthis->m_inputPipeWrite, &ctrlZ, 1, &bytesWritten, NULL);
+	}
+
+public:
+	/*
+	 *	构造时传入：exe文件路径
+	 */
+	explicit ConsoleOJ(const std::string& programPath) : m_programPath(programPath) {
+		// 处理工作目录
+		size_t found = programPath.find_last_of("/\\");
+		if (found != std::string::npos) {
+			this->m_workingDirectory = programPath.substr(0, found);
+		} else {
+			this->m_workingDirectory.clear();
+		}
+		// 创建事件对象
+		m_hExitEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		m_hStopReadEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		m_hReadDoneEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		m_hKillEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	}
+
+	~ConsoleOJ() {
+		// 析构
+		m_willExit = true;
+		SetEvent(m_hExitEvent);
+		if (isLaunched) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+		// 关闭事件同步对象句柄
+		CloseHandle(m_hExitEvent);
+		CloseHandle(m_hStopReadEvent);
+		CloseHandle(m_hReadDoneEvent);
+		CloseHandle(m_hKillEvent);
+	}
+
+	/*
+	 *	设置目标程序绑定的逻辑CPU，-1表示不绑定
+	 *  多个程序并行评测时，绑定到各自的核心可以让计时更稳定
+	 */
+	void setCPUAffinity(int cpuIndex) {
+		if (cpuIndex < 0 || cpuIndex >= 64) {
+			m_cpuIndex = -1;
+		} else {
+			m_cpuIndex = cpuIndex;
+		}
+	}
+
+	/*
+	 *	设置输出限制(字节)，小于0表示不限制
+	 *  输出总量超过限制时目标程序会被立即结束，launchAndWait返回false并报告输出超限
+	 */
+	void setOutputLimit(long long outputLimit) {
+		m_collector.setLimit(outputLimit);
+	}
+
+	/*
+	 *	设置内存限制(字节)，小于0表示不限制
+	 *  限制的是作业中所有进程提交的内存之和，超过限制的分配会失败，launchAndWait报告内存超限
+	 */
+	void setMemoryLimit(long long memoryLimit) {
+		m_memoryLimit = memoryLimit;
+	}
+
+	/*
+	 *	设置是否统计性能计数器，结果写在运行统计中
+	 *  Windows下只能通过作业对象得到缺页次数，其余计数器不可用
+	 */
+	void setPerfEnabled(bool isEnabled) {
+		m_isPerfEnabled = isEnabled;
+	}
+
+	/*
+	 *	设置作为标准输入的文件，传入空串则恢复为通过管道写入输入文本
+	 *  设置后目标程序直接以只读方式继承该文件，launchAndWait忽略输入文本
+	 *  评测程序不需要读取和复制输入，目标程序也可以对标准输入定位或映射
+	 */
+	void setInputFile(const std::string& inputFilePath) {
+		m_inputFilePath = inputFilePath;
+	}
+
+	/*
+	 *	设置传给目标程序的命令行参数，每个参数都会加上双引号
+	 */
+	void setArguments(const std::vector<std::string>& arguments) {
+		m_arguments = arguments;
+	}
+
+	/*
+	 *	获取上一次运行的退出代码，程序超时、被结束或未能启动时为-1
+	 *  返回值不为0时launchAndWait返回false，可以通过这里区分程序的返回值与其它错误
+	 */
+	long long getExitCode() const {
+		return m_exitCode;
+	}
+
+	/*
+	 *	设置输出处理函数，传入空函数则恢复为保存输出
+	 *  设置后输出不再保存，每读到一段就在监视线程中调用一次
+	 *  返回false表示不再需要后续输出，目标程序会被立即结束，launchAndWait返回false
+	 */
+	void setOutputSink(std::function<bool(const char*, size_t)> sink) {
+		m_collector.setSink(std::move(sink));
+	}
+
+	/*
+	 *	设置输入来源函数，传入空函数则恢复为写入输入文本
+	 *  设置后launchAndWait忽略输入文本，在写入线程中反复调用source(缓冲区, 容量)
+	 *  取得下一段输入并写入管道，返回0表示输入结束，设置了输入文件时不会被调用
+	 */
+	void setInputSource(std::function<size_t(char*, size_t)> source) {
+		m_inputSource = std::move(source);
+	}
+
+	/*
+	 *	启动进程，返回目标程序是否在时限内成功运行
+	 *  输入文本[in]：将压入目标程序输入流的文本，为空则不输入文本，设置了输入文件时忽略
+	 *  时间限制[in]：单位毫秒，限制的是所有线程与子进程的CPU时间之和
+	 *  输出文本[out]：返回程序输出流中的文本，原有内容会被丢弃，但其缓冲区会被复用
+	 *  运行统计[out]：返回程序消耗的CPU时间、真实时间与峰值内存，运行失败时也会填写
+	 *  错误信息[out]：返回程序运行失败的原因
+	 */
+	bool launchAndWait(std::string_view inputstr, long long timelimit,
+	                   std::string& outputstr, RunStats& stats, std::string& errstr) {
+		stats = RunStats();
+		m_exitCode = -1;
+		// 初始化安全标识符，使得管道可被子进程访问
+		SECURITY_ATTRIBUTES securityAttributes;
+		securityAttributes.nLength = sizeof(SECURITY_ATTRIBUTES);
+		securityAttributes.bInheritHandle = TRUE;
+		securityAttributes.lpSecurityDescriptor = NULL;
+		// 管道句柄
+		HANDLE inputPipeRead = INVALID_HANDLE_VALUE;
+		HANDLE inputPipeWrite = INVALID_HANDLE_VALUE;
+		HANDLE outputPipeWrite = INVALID_HANDLE_VALUE;
+		// 作业对象，用于限制与统计CPU时间和内存
+		HANDLE hJob = INVALID_HANDLE_VALUE;
+		// 接收作业对象内存超限通知的完成端口
+		HANDLE hJobPort = INVALID_HANDLE_VALUE;
+		// 初始化进程信息结构体
+		PROCESS_INFORMATION processInfo;
+		ZeroMemory(&processInfo, sizeof(processInfo));
+		try {
+			// 从创建管道到父进程关闭子进程端句柄的整个过程中持有锁
+			std::lock_guard<std::mutex> launchLock(getLaunchMutex());
+
+			if (!m_inputFilePath.empty()) {
+				// 以可继承的只读句柄打开输入文件，直接作为子进程的标准输入
+				inputPipeRead = CreateFileA(m_inputFilePath.c_str(), GENERIC_READ,
+				                            FILE_SHARE_READ, &securityAttributes,
+				                            OPEN_EXISTING,
+				                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+				                            NULL);
+				if (inputPipeRead == INVALID_HANDLE_VALUE) {
+					errstr = "打开输入文件失败！";
+					throw 1;
+				}
+			} else {
+				// 附带安全标识符创建输入管道
+				if (!CreatePipe(&inputPipeRead, &inputPipeWrite, &securityAttributes, 0)) {
+					errstr = "创建输入管道失败！";
+					throw 1;
+				}
+				// 父进程使用的一端不可被继承
+				SetHandleInformation(inputPipeWrite, HANDLE_FLAG_INHERIT, 0);
+			}
+
+			// 创建输出管道
+			if (!createOutputPipe(outputPipeWrite, securityAttributes)) {
+				errstr = "创建输出管道失败！";
+				throw 2;
+			}
+
+			// 创建作业对象
+			hJob = createLimitJob(timelimit, m_memoryLimit, hJobPort);
+			if (hJob == INVALID_HANDLE_VALUE) {
+				errstr = "创建作业对象失败！";
+				throw 3;
+			}
+
+			// 初始化启动信息结构体
+			STARTUPINFOA startupInfo;
+			ZeroMemory(&startupInfo, sizeof(startupInfo));
+			startupInfo.cb = sizeof(startupInfo);
+
+			// 设置输入输出管道，设置使用自定义管道标志位
+			startupInfo.hStdInput = inputPipeRead;
+			startupInfo.hStdOutput = outputPipeWrite;
+			startupInfo.hStdError = outputPipeWrite;
+			startupInfo.dwFlags |= STARTF_USESTDHANDLES;
+
+			// 处理命令行信息
+			std::string commandLine = "\"" + m_programPath + "\"";
+			for (const auto& e : m_arguments) {
+				commandLine += " \"" + e + "\"";
+			}
+			char* commandLine_c = new char[commandLine.size() + 1];
+			strncpy(commandLine_c, commandLine.c_str(), commandLine.size());
+			commandLine_c[commandLine.size()] = 0;
+
+			// 创建进程
+			const char* workingDirectoryPtr = NULL;
+			if (!m_workingDirectory.empty()) {
+				workingDirectoryPtr = m_workingDirectory.c_str();
+			}
+			if (!CreateProcessA(NULL, commandLine_c, NULL, NULL, TRUE,
+			                    HIGH_PRIORITY_CLASS | CREATE_NO_WINDOW | CREATE_SUSPENDED,
+			                    NULL, workingDirectoryPtr, &startupInfo, &processInfo)) {
+				// 释放命令行文本
+				delete[] commandLine_c;
+				errstr = "创建进程失败！";
+				throw 3;
+			}
+
+			// 释放命令行文本
+			delete[] commandLine_c;
+
+			// 子进程已经持有管道的另一端，父进程关闭自己的副本
+			// 这样子进程退出后读取端才能收到EOF，写入端也不会被阻塞
+			Clhandle_s(inputPipeRead);
+			Clhandle_s(outputPipeWrite);
+		} catch (int errid) {
+			switch (errid) {
+				case 3:
+				case 2:
+					// 关闭输出句柄
+					Clhandle_s(m_outputPipeRead);
+					Clhandle_s(outputPipeWrite);
+					break;
+			}
+			// 关闭输入句柄
+			Clhandle_s(inputPipeRead);
+			Clhandle_s(inputPipeWrite);
+			Clhandle_s(hJob);
+			Clhandle_s(hJobPort);
+			return false;
+		}
+
+		try {
+			isLaunched = true;
+
+			// 启动监视线程
+			ResetEvent(m_hStopReadEvent);
+			ResetEvent(m_hReadDoneEvent);
+			ResetEvent(m_hKillEvent);
+			// 接管调用者的输出缓冲区，复用其已分配的空间
+			m_collector.start(outputstr);
+			m_checkProcThread = std::thread(&CheckProcThread, this);
+
+			// 写入测试输入，使用输入文件时没有写入端
+			if (inputPipeWrite != INVALID_HANDLE_VALUE && (!inputstr.empty() || m_inputSource)) {
+				// 不为空才需要真写入数据
+				// 异步写入数据
+				m_inputCStr = inputstr.data();
+				m_inputCStrLen = static_cast<DWORD>(inputstr.size());
+				m_inputPipeWrite = inputPipeWrite;
+				// 启动数据写入线程
+				m_WriteStrThread = std::thread(&WriteStrThread, this);
+			}
+
+			// 需要等待析构标志句柄、进程句柄与结束程序事件
+			HANDLE hWaitHandle[3];
+			hWaitHandle[0] = this->m_hExitEvent;
+			hWaitHandle[1] = processInfo.hProcess;
+			hWaitHandle[2] = this->m_hKillEvent;
+
+			// 加入作业对象，必须在进程开始执行之前
+			// 作业对象统计所有线程与子进程的CPU时间，并由内核在用户态CPU时间达到限制时结束程序
+			if (!AssignProcessToJobObject(hJob, processInfo.hProcess)) {
+				errstr = "无法将进程加入作业对象！";
+				throw 4;
+			}
+
+			// 绑定CPU，必须在进程开始执行之前
+			if (m_cpuIndex >= 0) {
+				SetProcessAffinityMask(processInfo.hProcess,
+				                       static_cast<DWORD_PTR>(1ull << m_cpuIndex));
+			}
+
+			// 继续执行进程
+			ResumeThread(processInfo.hThread);
+
+			// 开始计时
+			auto start = std::chrono::steady_clock::now();
+
+			// 超时由内核判定，这里只在真实时间到达时间限制后定期检查程序是否被阻塞
+			long long timeLimitUs = timelimit * 1000ll;
+			long long lastCPUTimeUs = 0;
+			DWORD waitms = static_cast<DWORD>(timelimit);
+			while (1) {
+				// 同时等待三个句柄，只要有一个响应就退出阻塞
+				DWORD waitResult = WaitForMultipleObjects(3, hWaitHandle, FALSE, waitms);
+				stats.wallTimeUs = std::chrono::duration_cast<std::chrono::microseconds>
+				                   (std::chrono::steady_clock::now() - start).count();
+
+				if (m_willExit) {
+					errstr = "类正在析构！";
+					throw 4;
+				} else if (waitResult == WAIT_OBJECT_0 + 2) {
+					if (m_collector.isLimitExceeded()) {
+						errstr = m_collector.getLimitMsg();
+					} else {
+						errstr = "输出处理函数要求结束程序！";
+					}
+					throw 4;
+				} else if (waitResult == WAIT_TIMEOUT) {
+					waitms = static_cast<DWORD>(IDLE_CHECK_INTERVAL);
+					stats.cpuTimeUs = getJobCPUTimeUs(hJob);
+					// 内核只限制用户态时间，内核态时间在这里补充判断
+					if (stats.cpuTimeUs > timeLimitUs) {
+						errstr = "执行超时！";
+						throw 4;
+					}
+					// 判断被阻塞的情况
+					if (stats.cpuTimeUs - lastCPUTimeUs < MIN_CPU_PROGRESS_US) {
+						errstr = "程序疑似被阻塞，执行超时！";
+						throw 4;
+					}
+					lastCPUTimeUs = stats.cpuTimeUs;
+					// 再判断真实耗时过大的情况
+					if (stats.wallTimeUs > MAX_WALL_TIME_RATIO * timeLimitUs) {
+						errstr = "评测机负载过大，执行超时！";
+						throw 4;
+					}
+				} else {
+					// 说明进程退出了
+					break;
+				}
+			}
+
+			// 获取时间与内存，作业对象的统计包括所有线程与子进程
+			stats.cpuTimeUs = getJobCPUTimeUs(hJob);
+			stats.peakMemory = getJobPeakMemory(hJob);
+			if (m_isPerfEnabled) {
+				stats.perf.pageFaults = getJobPageFaults(hJob);
+			}
+
+			// 结束遗留的后代进程，使输出管道尽快收到EOF
+			TerminateJobObject(hJob, 1);
+
+			// 被内核因超时结束的进程也会走到这里
+			if (stats.cpuTimeUs > timeLimitUs) {
+				errstr = "执行超时！";
+				throw 4;
+			}
+
+			// 分配内存失败的程序通常会异常退出，因此先于返回值判断
+			if (isJobMemoryLimitHit(hJobPort)) {
+				errstr = getMemoryLimitMsg(m_memoryLimit);
+				throw 4;
+			}
+
+			// 获取进程退出代码
+			DWORD exeCode;
+			GetExitCodeProcess(processInfo.hProcess, &exeCode);
+			m_exitCode = exeCode;
+			if (exeCode != 0) {
+				errstr = "程序返回值为" + std::to_string(exeCode) + "！";
+				// 程序正常退出，读完剩余输出再返回，调用者可能需要按返回值处理输出
+				isLaunched = false;
+				joinCheckProcThread(OUTPUT_DRAIN_WAIT);
+				throw 4;
+			}
+
+			// 获取输出
+			isLaunched = false;
+			joinCheckProcThread(OUTPUT_DRAIN_WAIT);
+			if (m_collector.isLimitExceeded()) {
+				// 进程退出后读取剩余输出时才发现超限
+				errstr = m_collector.getLimitMsg();
+				throw 4;
+			}
+			if (m_WriteStrThread.joinable()) {
+				m_WriteStrThread.join();
+			}
+			m_collector.finish(outputstr, true);
+
+			// 关闭管道句柄
+			Clhandle_s(inputPipeWrite);
+			Clhandle_s(m_outputPipeRead);
+
+			// 关闭线程句柄
+			Clhandle_s(processInfo.hThread);
+
+			// 关闭进程句柄
+			Clhandle_s(processInfo.hProcess);
+
+			// 关闭作业对象
+			Clhandle_s(hJob);
+			Clhandle_s(hJobPort);
+			return true;
+		} catch (int) {
+			// 需要处理写入线程
+			if (m_WriteStrThread.joinable()) {
+				// 取消IO请求
+				CancelIoEx(m_inputPipeWrite, NULL);
+				// 等待线程结束
+				m_WriteStrThread.join();
+			}
+			// 结束作业中的所有进程，进程未能加入作业时单独结束
+			TerminateJobObject(hJob, 1);
+			TerminateProcess(processInfo.hProcess, 1);
+			WaitForSingleObject(processInfo.hProcess, INFINITE);
+			stats.cpuTimeUs = getJobCPUTimeUs(hJob);
+			stats.peakMemory = getJobPeakMemory(hJob);
+			if (m_isPerfEnabled) {
+				stats.perf.pageFaults = getJobPageFaults(hJob);
+			}
+			// 等待线程
+			isLaunched = false;
+			joinCheckProcThread(0);
+			m_collector.finish(outputstr, false);
+			// 关闭线程句柄
+			Clhandle_s(processInfo.hThread);
+			// 关闭进程句柄
+			Clhandle_s(processInfo.hProcess);
+			// 关闭管道句柄
+			Clhandle_s(m_outputPipeRead);
+			Clhandle_s(inputPipeWrite);
+			// 关闭作业对象
+			Clhandle_s(hJob);
+			Clhandle_s(hJobPort);
+			return false;
+		}
+	}
+};
+
+#endif /* _XY0797_CONSOLEOJWIN */
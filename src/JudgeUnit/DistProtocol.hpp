@@ -0,0 +1,164 @@
+/**
+ * \file    	DistProtocol.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		分布式评测中协调端与评测机之间的通信协议
+ */
+#ifndef _XY0797_DISTPROTOCOL
+#define _XY0797_DISTPROTOCOL 1
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <cctype>
+#include <exception>
+#include "Judge.hpp"
+#include "JudgeCache.hpp"
+#include "JsonLine.hpp"
+
+/*
+ *	通信协议：协调端(交互式评测时指定--workers)通过TCP连接各评测机(--worker)
+ *  双方每行发送一个JSON对象，文件内容以原始字节紧跟在描述它的那一行之后
+ *  评测机会运行协调端发来的任意程序，双方必须使用相同的令牌(--worker-token)
+ *  令牌与文件都以明文传输，评测机的端口只能在可信的网络中开放，不能暴露在公网上
+ *  连接建立后：
+ *    协调端在DIST_TIMEOUT_MS内发送 {"op":"hello","token":令牌}
+ *    令牌正确时评测机回复 {"event":"hello","slots":可以同时评测的样例数}，
+ *    否则回复 {"event":"denied","message":原因} 并断开，在此之前评测机不处理其它请求
+ *  评测机：
+ *    每隔DIST_HEARTBEAT_MS发送 {"event":"alive"}，协调端据此发现失联的评测机
+ *  协调端：
+ *    {"op":"judge","seq":请求序号,"exe":程序的哈希,"exeExt":程序的后缀,"in":输入的哈希,
+ *     "ans":答案的哈希,以及addTestConfigFields写入的评测配置}
+ *    {"op":"file","hash":内容的哈希,"ext":文件后缀,"executable":是否为程序,"size":字节数}
+ *      之后紧跟文件内容，size不能超过DIST_MAX_FILE_SIZE，否则评测机断开连接
+ *  评测机对judge的回复：
+ *    缺少文件时 {"event":"need","seq":...,"hashes":"哈希1,哈希2"}
+ *      协调端发送所缺的文件后以同一序号重新发送该请求
+ *    评测完成时 {"event":"result","seq":...,"resID":评测结果ID,"message":评测信息,
+ *                "cpuUs":CPU用时,"wallUs":真实用时,"memory":峰值内存(字节)}
+ *    请求有误时 {"event":"error","seq":...,"message":错误原因}
+ *  文件按内容的哈希值保存在评测机的缓存目录中，评测机重启后仍然有效
+ *  压缩的测试数据由协调端解压后发送，评测机上的测试数据都是普通文件
+ */
+
+// 评测机发送心跳的间隔(ms)
+const long long DIST_HEARTBEAT_MS = 1000;
+
+// 超过该时间(ms)收不到评测机的任何消息，或无法发送出数据，则认为评测机已失联
+const long long DIST_TIMEOUT_MS = 10000;
+
+// 连接评测机的超时(ms)
+const long long DIST_CONNECT_TIMEOUT_MS = 5000;
+
+// 一个样例最多因评测机失联而重新评测的次数，超过后不再重试，避免一个样例拖垮所有评测机
+const int DIST_MAX_CASE_RETRY = 3;
+
+// 单个文件的最大字节数，评测机把收到的文件整个读入内存，超过时视为对方出错
+// 协调端不发送更大的文件，直接报告该样例无法评测
+const long long DIST_MAX_FILE_SIZE = 1ll << 30;
+
+// 评测信息的最大长度，过长的部分截断，保证一行消息不超过MAX_MESSAGE_LINE
+const size_t DIST_MAX_RESULT_MSG = MAX_MESSAGE_LINE / 8;
+
+// 文件内容的哈希值，用作评测机缓存中的文件名
+std::string getContentHash(std::string_view content) {
+	return formatHash64(calcHash64(content));
+}
+
+// 是否是getContentHash生成的哈希值，评测机收到的哈希值与后缀都要检查后才能用作文件名
+bool isValidContentHash(const std::string& hash) {
+	if (hash.size() != 16) {
+		return false;
+	}
+	for (char ch : hash) {
+		if (!((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f'))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 是否是可以用作缓存文件名一部分的后缀：为空或者是.加上不超过8个字母数字
+bool isValidFileExten(const std::string& exten) {
+	if (exten.empty()) {
+		return true;
+	}
+	if (exten[0] != '.' || exten.size() > 9) {
+		return false;
+	}
+	for (size_t i = 1; i < exten.size(); ++i) {
+		if (!isalnum(static_cast<unsigned char>(exten[i]))) {
+			return false;
+		}
+	}
+	return exten.size() > 1;
+}
+
+// 比较令牌，所用时间与内容无关，不能通过响应时间逐字节猜测令牌
+bool isSameToken(const std::string& token, const std::string& expected) {
+	if (expected.empty()) {
+		return false;
+	}
+	unsigned char diff = token.size() == expected.size() ? 0 : 1;
+	for (size_t i = 0; i < token.size(); ++i) {
+		diff |= static_cast<unsigned char>(token[i] ^ expected[i % expected.size()]);
+	}
+	return diff == 0;
+}
+
+// 写入评测配置中与样例文件无关、可以在评测机上复现的部分
+void addTestConfigFields(JsonLineWriter& writer, const TestConfig& config) {
+	writer.addNumber("timeLimit", config.timeLimit)
+	.addNumber("memoryLimit", config.memoryLimit)
+	.addNumber("outputLimit", config.outputLimit)
+	.addBool("stream", config.isStreamCmp)
+	.addBool("fileInput", config.isFileInput)
+	.addBool("token", config.isTokenCmp)
+	.addDouble("absEps", config.eps.absEps)
+	.addDouble("relEps", config.eps.relEps)
+	.addBool("lineDiff", config.isLineDiff);
+}
+
+/*
+ *	读取addTestConfigFields写入的评测配置，缺少的字段保持原值
+ *  字段的值无效时返回false并把原因写在errMsg里面
+ */
+bool parseTestConfigFields(const std::map<std::string, std::string>& fields,
+                           TestConfig& config, std::string& errMsg) {
+	for (const auto& e : fields) {
+		const std::string& key = e.first;
+		const std::string& value = e.second;
+		try {
+			if (key == "timeLimit") {
+				config.timeLimit = std::stoll(value);
+			} else if (key == "memoryLimit") {
+				config.memoryLimit = std::stoll(value);
+			} else if (key == "outputLimit") {
+				config.outputLimit = std::stoll(value);
+			} else if (key == "stream") {
+				config.isStreamCmp = value == "true";
+			} else if (key == "fileInput") {
+				config.isFileInput = value == "true";
+			} else if (key == "token") {
+				config.isTokenCmp = value == "true";
+			} else if (key == "absEps") {
+				config.eps.absEps = std::stod(value);
+			} else if (key == "relEps") {
+				config.eps.relEps = std::stod(value);
+			} else if (key == "lineDiff") {
+				config.isLineDiff = value == "true";
+			}
+		} catch (const std::exception& ex) {
+			errMsg = "评测配置" + key + "的值无效：" + value;
+			return false;
+		}
+	}
+	if (config.timeLimit <= 0 || config.outputLimit <= 0) {
+		errMsg = "时间限制与输出限制必须大于0";
+		return false;
+	}
+	return true;
+}
+
+#endif /* _XY0797_DISTPROTOCOL */
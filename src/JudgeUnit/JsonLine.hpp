@@ -0,0 +1,354 @@
+/**
+ * \file    	JsonLine.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		每行一个JSON对象的消息格式，只支持值为字符串、数字与布尔值的扁平对象
+ */
+#ifndef _XY0797_JSONLINE
+#define _XY0797_JSONLINE 1
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <cstdio>
+#include <cstdint>
+
+namespace INTERNAL_jsonline {
+	// 把码点按UTF-8编码追加到res
+	void appendUTF8(std::string& res, uint32_t code) {
+		if (code < 0x80) {
+			res += static_cast<char>(code);
+		} else if (code < 0x800) {
+			res += static_cast<char>(0xC0 | (code >> 6));
+			res += static_cast<char>(0x80 | (code & 0x3F));
+		} else if (code < 0x10000) {
+			res += static_cast<char>(0xE0 | (code >> 12));
+			res += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+			res += static_cast<char>(0x80 | (code & 0x3F));
+		} else {
+			res += static_cast<char>(0xF0 | (code >> 18));
+			res += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+			res += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+			res += static_cast<char>(0x80 | (code & 0x3F));
+		}
+	}
+
+	// 读取\u后的4位十六进制数，失败返回false
+	bool parseHex4(std::string_view text, size_t pos, uint32_t& code) {
+		if (pos + 4 > text.size()) {
+			return false;
+		}
+		code = 0;
+		for (size_t i = pos; i < pos + 4; ++i) {
+			char ch = text[i];
+			code <<= 4;
+			if (ch >= '0' && ch <= '9') {
+				code |= ch - '0';
+			} else if (ch >= 'a' && ch <= 'f') {
+				code |= ch - 'a' + 10;
+			} else if (ch >= 'A' && ch <= 'F') {
+				code |= ch - 'A' + 10;
+			} else {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// 跳过空白字符
+	void skipSpace(std::string_view text, size_t& pos) {
+		while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t'
+		                             || text[pos] == '\r' || text[pos] == '\n')) {
+			++pos;
+		}
+	}
+
+	// 从pos处的引号开始读取字符串并反转义，pos移到结尾引号之后，失败返回false
+	bool parseString(std::string_view text, size_t& pos, std::string& res) {
+		res.clear();
+		if (pos >= text.size() || text[pos] != '"') {
+			return false;
+		}
+		++pos;
+		while (pos < text.size()) {
+			char ch = text[pos++];
+			if (ch == '"') {
+				return true;
+			}
+			if (ch != '\\') {
+				res += ch;
+				continue;
+			}
+			if (pos >= text.size()) {
+				return false;
+			}
+			char esc = text[pos++];
+			switch (esc) {
+				case '"':
+				case '\\':
+				case '/':
+					res += esc;
+					break;
+				case 'b':
+					res += '\b';
+					break;
+				case 'f':
+					res += '\f';
+					break;
+				case 'n':
+					res += '\n';
+					break;
+				case 'r':
+					res += '\r';
+					break;
+				case 't':
+					res += '\t';
+					break;
+				case 'u': {
+					uint32_t code;
+					if (!parseHex4(text, pos, code)) {
+						return false;
+					}
+					pos += 4;
+					// 代理对组合为一个码点
+					if (code >= 0xD800 && code < 0xDC00) {
+						uint32_t low;
+						if (pos + 6 > text.size() || text[pos] != '\\' || text[pos + 1] != 'u'
+						        || !parseHex4(text, pos + 2, low) || low < 0xDC00 || low >= 0xE000) {
+							return false;
+						}
+						pos += 6;
+						code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+					} else if (code >= 0xDC00 && code < 0xE000) {
+						return false;
+					}
+					appendUTF8(res, code);
+					break;
+				}
+				default:
+					return false;
+			}
+		}
+		return false;
+	}
+
+	// 读取数字、true、false或null，原样保存其文本，null保存为空文本
+	bool parseLiteral(std::string_view text, size_t& pos, std::string& res) {
+		size_t begin = pos;
+		while (pos < text.size() && text[pos] != ',' && text[pos] != '}'
+		        && text[pos] != ' ' && text[pos] != '\t' && text[pos] != '\r'
+		        && text[pos] != '\n') {
+			++pos;
+		}
+		res.assign(text.substr(begin, pos - begin));
+		if (res == "true" || res == "false") {
+			return true;
+		}
+		if (res == "null") {
+			res.clear();
+			return true;
+		}
+		// 数字只检查字符集，转换由使用者进行
+		if (res.empty()) {
+			return false;
+		}
+		for (char ch : res) {
+			if (!((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.'
+			        || ch == 'e' || ch == 'E')) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// UTF-8编码的字符从pos开始的字节数，不是合法的UTF-8编码时返回0
+	size_t getUTF8Len(std::string_view text, size_t pos) {
+		unsigned char ch = static_cast<unsigned char>(text[pos]);
+		size_t len;
+		uint32_t code;
+		if (ch < 0x80) {
+			return 1;
+		} else if ((ch & 0xE0) == 0xC0) {
+			len = 2;
+			code = ch & 0x1F;
+		} else if ((ch & 0xF0) == 0xE0) {
+			len = 3;
+			code = ch & 0x0F;
+		} else if ((ch & 0xF8) == 0xF0) {
+			len = 4;
+			code = ch & 0x07;
+		} else {
+			return 0;
+		}
+		if (pos + len > text.size()) {
+			return 0;
+		}
+		for (size_t i = 1; i < len; ++i) {
+			unsigned char next = static_cast<unsigned char>(text[pos + i]);
+			if ((next & 0xC0) != 0x80) {
+				return 0;
+			}
+			code = (code << 6) | (next & 0x3F);
+		}
+		// 拒绝过长编码、代理区与超出范围的码点
+		static const uint32_t minCode[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+		if (code < minCode[len] || code > 0x10FFFF || (code >= 0xD800 && code < 0xE000)) {
+			return 0;
+		}
+		return len;
+	}
+}
+
+/*
+ *	解析一行JSON对象，把各字段的值以文本形式写入fields
+ *  字符串取反转义后的内容，数字与布尔值取原文，null为空文本
+ *  不支持数组与嵌套对象，格式有误时返回false并把原因写在errMsg里面
+ */
+bool parseJsonLine(std::string_view text, std::map<std::string, std::string>& fields,
+                   std::string& errMsg) {
+	using namespace INTERNAL_jsonline;
+	fields.clear();
+	size_t pos = 0;
+	skipSpace(text, pos);
+	if (pos >= text.size() || text[pos] != '{') {
+		errMsg = "消息必须是JSON对象";
+		return false;
+	}
+	++pos;
+	skipSpace(text, pos);
+	if (pos < text.size() && text[pos] == '}') {
+		++pos;
+	} else {
+		while (true) {
+			std::string key, value;
+			skipSpace(text, pos);
+			if (!parseString(text, pos, key)) {
+				errMsg = "字段名无效";
+				return false;
+			}
+			skipSpace(text, pos);
+			if (pos >= text.size() || text[pos] != ':') {
+				errMsg = "字段" + key + "缺少冒号";
+				return false;
+			}
+			++pos;
+			skipSpace(text, pos);
+			if (pos < text.size() && (text[pos] == '{' || text[pos] == '[')) {
+				errMsg = "字段" + key + "的值不能是数组或对象";
+				return false;
+			}
+			bool isValid = pos < text.size() && text[pos] == '"'
+			               ? parseString(text, pos, value) : parseLiteral(text, pos, value);
+			if (!isValid) {
+				errMsg = "字段" + key + "的值无效";
+				return false;
+			}
+			fields[key] = value;
+			skipSpace(text, pos);
+			if (pos < text.size() && text[pos] == ',') {
+				++pos;
+				continue;
+			}
+			if (pos < text.size() && text[pos] == '}') {
+				++pos;
+				break;
+			}
+			errMsg = "JSON对象不完整";
+			return false;
+		}
+	}
+	skipSpace(text, pos);
+	if (pos != text.size()) {
+		errMsg = "JSON对象之后有多余的内容";
+		return false;
+	}
+	return true;
+}
+
+/*
+ *	转义为JSON字符串(含两侧引号)，控制字符写为\uXXXX
+ *  程序输出可能不是合法的UTF-8，非法的字节替换为U+FFFD，保证结果总是合法的JSON
+ */
+std::string escapeJsonString(std::string_view text) {
+	std::string res = "\"";
+	res.reserve(text.size() + 2);
+	for (size_t i = 0; i < text.size();) {
+		char ch = text[i];
+		if (ch == '"' || ch == '\\') {
+			res += '\\';
+			res += ch;
+		} else if (ch == '\n') {
+			res += "\\n";
+		} else if (ch == '\r') {
+			res += "\\r";
+		} else if (ch == '\t') {
+			res += "\\t";
+		} else if (static_cast<unsigned char>(ch) < 0x20 || ch == 0x7F) {
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(ch));
+			res += buf;
+		} else {
+			size_t len = INTERNAL_jsonline::getUTF8Len(text, i);
+			if (len == 0) {
+				res += "\\ufffd";
+				++i;
+			} else {
+				res.append(text.substr(i, len));
+				i += len;
+			}
+			continue;
+		}
+		++i;
+	}
+	res += '"';
+	return res;
+}
+
+// 逐个字段生成一行JSON对象
+class JsonLineWriter {
+private:
+	std::string m_text = "{";
+
+	void addKey(const std::string& key) {
+		if (m_text.size() > 1) {
+			m_text += ',';
+		}
+		m_text += escapeJsonString(key);
+		m_text += ':';
+	}
+
+public:
+	JsonLineWriter& addString(const std::string& key, std::string_view value) {
+		addKey(key);
+		m_text += escapeJsonString(value);
+		return *this;
+	}
+
+	JsonLineWriter& addNumber(const std::string& key, long long value) {
+		addKey(key);
+		m_text += std::to_string(value);
+		return *this;
+	}
+
+	// 按能准确还原原值的精度写出，值必须是有限数
+	JsonLineWriter& addDouble(const std::string& key, double value) {
+		addKey(key);
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%.17g", value);
+		m_text += buf;
+		return *this;
+	}
+
+	JsonLineWriter& addBool(const std::string& key, bool value) {
+		addKey(key);
+		m_text += value ? "true" : "false";
+		return *this;
+	}
+
+	// 完整的JSON对象，不含换行
+	std::string str() const {
+		return m_text + "}";
+	}
+};
+
+#endif /* _XY0797_JSONLINE */
@@ -7,32 +7,458 @@
 #ifndef _XY0797_JUDGE
 #define _XY0797_JUDGE 1
 
-#include <regex>
 #include <fstream>
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <cstdio>
 #include <exception>
+#include <memory>
+#include "../WindowsFileSysTool.hpp"
 #include "ConsoleOJ.hpp"
 #include "TestStringCmp.hpp"
+#include "LineDiff.hpp"
+#include "StreamAnsCmp.hpp"
+#include "TokenCmp.hpp"
+#include "CheckerPlugin.hpp"
+#include "MappedFile.hpp"
+#include "TestData.hpp"
+#include "AnsDigest.hpp"
 
-// 统一换行符
-std::string unifyNewlines(const std::string& input) {
-	// 正则表达式匹配各种换行符，包括\r, \r\n
-	static std::regex newline_regex("(\\r\\n|\\r)");
-	// 使用std::regex_replace替换所有匹配到的换行符为\n
-	return std::regex_replace(input, newline_regex, "\n");
+// 统一换行符，把\r\n与\r替换为\n
+// 在原字符串上就地压缩，没有\r时只扫描一遍，不分配内存
+void unifyNewlines(std::string& str) {
+	size_t readPos = str.find('\r');
+	if (readPos == std::string::npos) {
+		return;
+	}
+	size_t writePos = readPos;
+	while (readPos < str.size()) {
+		char ch = str[readPos++];
+		if (ch == '\r') {
+			ch = '\n';
+			if (readPos < str.size() && str[readPos] == '\n') {
+				++readPos;
+			}
+		}
+		str[writePos++] = ch;
+	}
+	str.resize(writePos);
 }
 
-// 读取整个文件
-// 自动统一换行符
-std::string read_entire_text_file(const std::string& filename) {
-	std::ifstream in(filename);
-	if (!in) {
-		throw std::runtime_error("无法打开文件");
+// 取得统一换行符后的文本
+// 文件映射是只读的，只有含\r时才复制到buffer里面统一，否则直接使用原文本
+std::string_view getUnifiedText(std::string_view text, std::string& buffer) {
+	if (text.find('\r') == std::string_view::npos) {
+		return text;
+	}
+	buffer.assign(text.data(), text.size());
+	unifyNewlines(buffer);
+	return buffer;
+}
+
+// 评测线程复用的输出缓冲区在评测后最多保留的容量，超过时释放
+const size_t OUTPUT_BUFFER_KEEP_SIZE = 4 * 1024 * 1024;
+
+// 离开作用域时释放过大的线程复用输出缓冲区
+// 守护进程、评测机与批量评测中线程长期存在，否则每个线程都会一直占用其最大输出的内存
+class OutputBufferTrimmer {
+private:
+	std::string& m_buffer;
+
+public:
+	explicit OutputBufferTrimmer(std::string& buffer) : m_buffer(buffer) {}
+
+	OutputBufferTrimmer(const OutputBufferTrimmer&) = delete;
+	OutputBufferTrimmer& operator=(const OutputBufferTrimmer&) = delete;
+
+	~OutputBufferTrimmer() {
+		if (m_buffer.capacity() > OUTPUT_BUFFER_KEEP_SIZE) {
+			std::string().swap(m_buffer);
+		}
+	}
+};
+
+// 微秒转为带三位小数的毫秒文本，例如"12.345ms"
+std::string formatTimeUs(long long us) {
+	std::string fracStr = std::to_string(us % 1000);
+	return std::to_string(us / 1000) + "."
+	       + std::string(3 - fracStr.size(), '0') + fracStr + "ms";
+}
+
+// 字节转为带两位小数的MB文本，例如"12.34MB"，无法获取的峰值内存为0，显示为"未知"
+std::string formatMemory(long long bytes) {
+	if (bytes <= 0) {
+		return "未知";
+	}
+	long long centiMB = bytes * 100 / (1024 * 1024);
+	std::string fracStr = std::to_string(centiMB % 100);
+	return std::to_string(centiMB / 100) + "."
+	       + std::string(2 - fracStr.size(), '0') + fracStr + "MB";
+}
+
+// 预先读入的样例，多个程序评测同一测试集时共用，读入与统一换行符都只进行一次
+// 普通文件为映射，压缩的测试数据为解压后的内容
+struct LoadedTestCase {
+	TestDataContent input;
+	TestDataContent ans;
+	// 统一换行符后的标准答案，流式比较时使用，不含\r时与ans相同
+	std::string unifiedAnsBuffer;
+	std::string_view unifiedAns;
+
+	/*
+	 *	读入样例的输入与标准答案，失败时抛出std::runtime_error
+	 */
+	LoadedTestCase(const std::string& testCaseFilePath, const std::string& ansFilePath)
+		: input(testCaseFilePath), ans(ansFilePath) {
+		unifiedAns = getUnifiedText(ans.view(), unifiedAnsBuffer);
+	}
+
+	LoadedTestCase(const LoadedTestCase&) = delete;
+	LoadedTestCase& operator=(const LoadedTestCase&) = delete;
+};
+
+// 单次评测的配置
+struct TestConfig {
+	// 限时(ms)
+	long long timeLimit = 1000;
+	// 待测程序绑定的逻辑CPU序号，-1表示不绑定
+	int cpuIndex = -1;
+	// 是否在程序运行期间比较输出，确定WA后立即结束程序
+	bool isStreamCmp = true;
+	// 输出限制(字节)
+	long long outputLimit = 256ll * 1024 * 1024;
+	// 是否直接把输入文件作为待测程序的标准输入，否则读入后通过管道写入
+	bool isFileInput = true;
+	// 内存限制(字节)，小于0表示不限制
+	long long memoryLimit = -1;
+	// 是否统计硬件性能计数器
+	bool isPerf = false;
+	// checker(特判程序)的路径，为空则使用内置的比较
+	std::string checkerPath;
+	// 已加载的checker插件，不为空时优先于checkerPath
+	const CheckerPlugin* checkerPlugin = nullptr;
+	// 是否按单词比较(忽略空白字符的差异)，此时不进行流式比较
+	bool isTokenCmp = false;
+	// 按单词比较时浮点数的容许误差
+	TokenCmpEps eps;
+	// 标准答案摘要索引，不为空时逐行比较的样例优先按摘要判定AC，按单词比较时不使用
+	AnsDigestIndex* digestIndex = nullptr;
+	// WA时是否按行对齐列出各处差异，需要完整的输出，只在不进行流式比较时有效
+	bool isLineDiff = false;
+	// 已经读入的样例，不为空时输入与标准答案都使用其内容，不再打开文件，必须与评测的样例对应
+	const LoadedTestCase* loadedCase = nullptr;
+};
+
+// checker的时间限制(ms)
+const long long CHECKER_TIME_LIMIT = 10000;
+
+// checker的输出限制(字节)，checker的输出只作为评测信息显示
+const long long CHECKER_OUTPUT_LIMIT = 1024 * 1024;
+
+// testlib约定的checker返回值
+const long long TESTLIB_EXIT_OK = 0;
+const long long TESTLIB_EXIT_WA = 1;
+const long long TESTLIB_EXIT_PE = 2;
+const long long TESTLIB_EXIT_FAIL = 3;
+const long long TESTLIB_EXIT_POINTS = 7;
+
+// 待测程序的输入
+// 普通文件按评测配置直接作为标准输入或映射后写入管道，压缩的测试数据边解压边写入管道
+// 解压出错时待测程序读到的输入提前结束，错误信息在运行结束后由getErrMsg取得
+class SolutionInput {
+private:
+	std::unique_ptr<MappedFile> m_file;
+	std::unique_ptr<TestDataStream> m_stream;
+	std::string_view m_text;
+	// 在写入线程中写入，运行结束后才读取
+	std::string m_errMsg;
+
+public:
+	/*
+	 *	为待测程序设置输入，loadedText不为空时表示输入已经整个读入，直接写入该文本
+	 *  loadedText为空时使用评测配置中已经读入的样例
+	 *  打开输入失败时抛出std::runtime_error
+	 */
+	SolutionInput(ConsoleOJ& myansEXE, const std::string& testCaseFilePath,
+	              const TestConfig& config, const TestDataContent* loadedText = nullptr) {
+		if (loadedText == nullptr && config.loadedCase != nullptr) {
+			loadedText = &config.loadedCase->input;
+		}
+		bool isPlain = isPlainTestData(testCaseFilePath);
+		if (isPlain && config.isFileInput) {
+			myansEXE.setInputFile(testCaseFilePath);
+		} else if (loadedText != nullptr) {
+			m_text = loadedText->view();
+		} else if (isPlain) {
+			m_file = std::make_unique<MappedFile>(testCaseFilePath);
+			m_text = m_file->view();
+		} else {
+			m_stream = std::make_unique<TestDataStream>(testCaseFilePath);
+			myansEXE.setInputSource([this](char* buf, size_t cap) -> size_t {
+				try {
+					return m_stream->read(buf, cap);
+				} catch (const std::exception& ex) {
+					m_errMsg = ex.what();
+					return 0;
+				}
+			});
+		}
+	}
+
+	SolutionInput(const SolutionInput&) = delete;
+	SolutionInput& operator=(const SolutionInput&) = delete;
+
+	// 需要通过管道写入的输入文本
+	std::string_view getText() const {
+		return m_text;
+	}
+
+	// 解压输入时的错误信息，没有错误时为空
+	const std::string& getErrMsg() const {
+		return m_errMsg;
+	}
+};
+
+// 运行待测程序，把失败时的错误信息转为返回状态码，含义与runTest相同
+// 流式比较时由streamCmp判断WA，否则只会返回0、-1、-3、-4、-5
+int launchSolution(ConsoleOJ& myansEXE, const SolutionInput& input,
+                   const TestConfig& config, std::string& myansStr,
+                   const StreamAnsCmp* streamCmp, std::string& resMsg, RunStats& stats) {
+	std::string errorMsg;
+	bool isSuccess = myansEXE.launchAndWait(input.getText(), config.timeLimit,
+	                                        myansStr, stats, errorMsg);
+	if (!input.getErrMsg().empty()) {
+		// 输入不完整，运行结果没有意义
+		resMsg = "读取输入数据失败，原因：" + input.getErrMsg();
+		return -1;
+	}
+	if (isSuccess) {
+		return 0;
+	}
+	if (errorMsg.find("输出超限") != errorMsg.npos) {
+		resMsg = errorMsg;
+		return -4;
+	}
+	if (errorMsg.find("内存超限") != errorMsg.npos) {
+		resMsg = errorMsg;
+		return -5;
+	}
+	if (streamCmp != nullptr && streamCmp->isWA()) {
+		// 输出已确定WA，程序被提前结束
+		return -2;
+	}
+	if (errorMsg.find("超时") != errorMsg.npos) {
+		resMsg = errorMsg;
+		return -3;
+	}
+	resMsg = "运行待测程序失败，用时" + formatTimeUs(stats.cpuTimeUs)
+	         + "，原因：" + errorMsg;
+	return -1;
+}
+
+// 按评测配置设置待测程序，输入由SolutionInput设置
+void setupSolution(ConsoleOJ& myansEXE, const TestConfig& config) {
+	myansEXE.setCPUAffinity(config.cpuIndex);
+	myansEXE.setOutputLimit(config.outputLimit);
+	myansEXE.setMemoryLimit(config.memoryLimit);
+	myansEXE.setPerfEnabled(config.isPerf);
+}
+
+// 运行待测程序，程序正常结束时把输出原样保存到临时文件，留给checker检查
+// 返回状态码与runTest相同，但不会返回-2，返回0时outputFilePath为临时文件的路径
+// 临时文件由调用者在检查后删除，返回其它状态码时不会留下临时文件
+int runSolution(const std::string& testCaseFilePath, const std::string& testExePath,
+                const TestConfig& config, std::string& resMsg, RunStats& stats,
+                std::string& outputFilePath) {
+	static thread_local std::string myansStr;
+	OutputBufferTrimmer myansTrimmer(myansStr);
+	resMsg.clear();
+	outputFilePath.clear();
+	ConsoleOJ myansEXE(testExePath);
+	setupSolution(myansEXE, config);
+	SolutionInput input(myansEXE, testCaseFilePath, config);
+	int resID = launchSolution(myansEXE, input, config, myansStr, nullptr, resMsg, stats);
+	if (resID != 0) {
+		return resID;
+	}
+	std::string tmpPath = winfs::createTempFile();
+	if (tmpPath.empty()) {
+		throw std::runtime_error("无法创建保存输出的临时文件");
+	}
+	std::ofstream fout(tmpPath, std::ios::binary);
+	fout.write(myansStr.data(), static_cast<std::streamsize>(myansStr.size()));
+	fout.close();
+	if (!fout) {
+		std::remove(tmpPath.c_str());
+		throw std::runtime_error("无法写入保存输出的临时文件");
+	}
+	outputFilePath = tmpPath;
+	return 0;
+}
+
+// 把testlib约定的checker返回值转为返回状态码，checker进程与插件共用
+// 0：AC，-2：WA(包括格式错误与部分正确)，-1：checker返回FAIL或无法识别的值
+int getCheckerResult(long long exitCode, const std::string& checkerMsg, std::string& resMsg) {
+	switch (exitCode) {
+		case TESTLIB_EXIT_OK:
+			resMsg = checkerMsg;
+			return 0;
+		case TESTLIB_EXIT_WA:
+			resMsg = "checker判定答案错误：" + checkerMsg;
+			return -2;
+		case TESTLIB_EXIT_PE:
+			resMsg = "checker判定格式错误：" + checkerMsg;
+			return -2;
+		case TESTLIB_EXIT_POINTS:
+			resMsg = "checker判定部分正确：" + checkerMsg;
+			return -2;
+		case TESTLIB_EXIT_FAIL:
+			resMsg = "checker判定评测数据或checker自身有误：" + checkerMsg;
+			return -1;
+		default:
+			resMsg = "checker返回值为" + std::to_string(exitCode) + "，无法识别：" + checkerMsg;
+			return -1;
+	}
+}
+
+// 以testlib的方式运行checker：checker input output answer
+// 返回状态码：0：AC，-2：WA(包括格式错误与部分正确)，-1：checker运行失败或返回FAIL
+// checker输出的信息写在resMsg里面，checker消耗的资源写在checkerStats里面
+int runChecker(const std::string& checkerPath, const std::string& testCaseFilePath,
+               const std::string& outputFilePath, const std::string& ansFilePath,
+               std::string& resMsg, RunStats& checkerStats) {
+	resMsg.clear();
+	if (!isPlainTestData(testCaseFilePath) || !isPlainTestData(ansFilePath)) {
+		resMsg = "checker只能检查普通文件形式的测试数据，不支持压缩的测试数据";
+		return -1;
+	}
+	ConsoleOJ checkerEXE(checkerPath);
+	// checker在自己的目录下运行，路径都要转为绝对路径
+	checkerEXE.setArguments({ winfs::getAbsolutePath(testCaseFilePath),
+	                          winfs::getAbsolutePath(outputFilePath),
+	                          winfs::getAbsolutePath(ansFilePath) });
+	checkerEXE.setOutputLimit(CHECKER_OUTPUT_LIMIT);
+	// 无论返回值如何都需要checker的输出，因此用输出处理函数保存
+	std::string checkerMsg;
+	checkerEXE.setOutputSink([&checkerMsg](const char* data, size_t len) {
+		checkerMsg.append(data, len);
+		return true;
+	});
+	std::string unusedStr, errorMsg;
+	bool isSuccess = checkerEXE.launchAndWait(std::string_view(), CHECKER_TIME_LIMIT,
+	                 unusedStr, checkerStats, errorMsg);
+	long long exitCode = checkerEXE.getExitCode();
+	while (!checkerMsg.empty()
+	        && (checkerMsg.back() == '\n' || checkerMsg.back() == '\r')) {
+		checkerMsg.pop_back();
+	}
+	if (!isSuccess && exitCode <= 0) {
+		resMsg = "checker运行失败，原因：" + errorMsg;
+		return -1;
+	}
+	return getCheckerResult(exitCode, checkerMsg, resMsg);
+}
+
+// 运行待测程序，再在本进程内调用checker插件检查输出，返回状态码与runTest相同
+// 输入、输出与答案都以内存的形式交给插件，不经过临时文件
+// 压缩的测试数据需要完整解压到内存
+int runTestWithPlugin(const std::string& testCaseFilePath, const std::string& ansFilePath,
+                      const std::string& testExePath, const TestConfig& config,
+                      std::string& resMsg, RunStats& stats) {
+	static thread_local std::string myansStr;
+	OutputBufferTrimmer myansTrimmer(myansStr);
+	resMsg.clear();
+	// 插件总是需要输入，因此先读入
+	std::unique_ptr<LoadedTestCase> ownCase;
+	if (config.loadedCase == nullptr) {
+		ownCase = std::make_unique<LoadedTestCase>(testCaseFilePath, ansFilePath);
+	}
+	const LoadedTestCase& testCase = ownCase ? *ownCase : *config.loadedCase;
+	ConsoleOJ myansEXE(testExePath);
+	setupSolution(myansEXE, config);
+	SolutionInput input(myansEXE, testCaseFilePath, config, &testCase.input);
+	int resID = launchSolution(myansEXE, input, config, myansStr, nullptr, resMsg, stats);
+	if (resID != 0) {
+		return resID;
+	}
+	std::string checkerMsg;
+	int exitCode = config.checkerPlugin->check(testCase.input.view(), myansStr,
+	               testCase.ans.view(), checkerMsg);
+	return getCheckerResult(exitCode, checkerMsg, resMsg);
+}
+
+// 边解压边计算测试数据的摘要，解压后的内容不需要整个放在内存中
+AnsDigest calcTestDataDigest(const std::string& filePath) {
+	TestDataStream stream(filePath);
+	AnsDigestBuilder builder;
+	std::vector<char> buffer(INPUT_WRITE_CHUNK);
+	size_t len;
+	while ((len = stream.read(buffer.data(), buffer.size())) > 0) {
+		builder.feed(buffer.data(), len);
+	}
+	return builder.finish();
+}
+
+// 逐行比较程序输出与标准答案，返回是否一致，不一致时按评测配置生成差异信息
+bool checkAnsStr(std::string_view ansStr, std::string_view outputStr,
+                 const TestConfig& config, std::string& resMsg) {
+	if (compareAnsStr(ansStr, outputStr, resMsg)) {
+		return true;
+	}
+	if (config.isLineDiff) {
+		genLineDiffMsg(ansStr, outputStr, resMsg);
+	}
+	return false;
+}
+
+// 按标准答案的摘要评测，返回状态码与runTest相同
+// 程序运行期间边保存输出边计算摘要，与标准答案的摘要一致即为AC，不需要打开标准答案
+// 摘要不一致时才读入标准答案，逐字节比较生成差异信息，此时不能提前结束WA的程序
+int runTestWithDigest(ConsoleOJ& myansEXE, const SolutionInput& input,
+                      const std::string& ansFilePath, const AnsDigest& ansDigest,
+                      const TestConfig& config, std::string& resMsg, RunStats& stats) {
+	static thread_local std::string myansStr;
+	OutputBufferTrimmer myansTrimmer(myansStr);
+	// 输出处理函数在监视线程中调用，必须引用本线程的缓冲区
+	std::string& outputStr = myansStr;
+	outputStr.clear();
+	AnsDigestBuilder outputDigest;
+	myansEXE.setOutputSink([&outputStr, &outputDigest](const char* data, size_t len) {
+		outputStr.append(data, len);
+		outputDigest.feed(data, len);
+		return true;
+	});
+	std::string unusedStr;
+	int resID = launchSolution(myansEXE, input, config, unusedStr,
+	                           nullptr, resMsg, stats);
+	if (resID != 0) {
+		return resID;
+	}
+	if (outputDigest.finish() == ansDigest) {
+		return 0;
+	}
+	TestDataContent ansFile(ansFilePath);
+	return checkAnsStr(ansFile.view(), outputStr, config, resMsg) ? 0 : -2;
+}
+
+// 评测结果ID对应的简称
+std::string getResName(int resID) {
+	switch (resID) {
+		case 0:
+			return "AC";
+		case -2:
+			return "WA";
+		case -3:
+			return "TLE";
+		case -4:
+			return "OLE";
+		case -5:
+			return "MLE";
+		case 1:
+			return "UNTESTED";
+		default:
+			return "FAILED";
 	}
-	std::stringstream buffer;
-	buffer << in.rdbuf();
-	return buffer.str();
 }
 
 // 返回状态码
@@ -40,33 +466,119 @@ std::string read_entire_text_file(const std::string& filename) {
 // -1：启动失败
 // -2：WA
 // -3：TLE
-// 如果启动失败，会将错误信息写在m_TestERRStr里面
-// 如果WA了，会将差异以人类可读形式写在m_TestERRStr里面
-// 如果AC，会将用时(小数秒)写在m_TestERRStr里面
+// -4：OLE
+// -5：MLE
+// 如果启动失败，会将错误信息写在resMsg里面
+// 如果WA了，会将差异以人类可读形式写在resMsg里面
+// 指定了标准答案摘要索引时，摘要有效的样例按摘要评测，其余样例的摘要会被补上
+// 测试数据可以是.gz文件或.zip压缩包中的文件，见TestDataStream
+// 压缩的输入边解压边写入，压缩的标准答案边解压边计算摘要后按摘要评测
+// 无论结果如何，程序消耗的CPU时间、真实时间与峰值内存都会写在stats里面
+// 启用性能计数器时，计数值同样写在stats里面
+// 指定了checker或checker插件时由其判定结果，checker消耗的资源不计入stats
+// 评测配置中有已经读入的样例时不再读取测试数据，checker进程仍然读取文件
+// 不使用全局状态，可在多个线程中同时调用
 int runTest(const std::string& testCaseFilePath, const std::string& ansFilePath,
-            const std::string& testExePath, long long timeLimit) {
-	std::string myansStr, errorMsg;
-	m_TestERRStr.clear();
-	long long timecost = 0;
-	std::string testCaseStr = read_entire_text_file(testCaseFilePath);
-	std::string ansStr = read_entire_text_file(ansFilePath);
+            const std::string& testExePath, const TestConfig& config,
+            std::string& resMsg, RunStats& stats) {
+	if (config.checkerPlugin != nullptr) {
+		return runTestWithPlugin(testCaseFilePath, ansFilePath, testExePath, config,
+		                         resMsg, stats);
+	}
+	if (!config.checkerPath.empty()) {
+		// 使用checker时先运行待测程序，再检查其输出
+		std::string outputFilePath;
+		int resID = runSolution(testCaseFilePath, testExePath, config,
+		                        resMsg, stats, outputFilePath);
+		if (resID != 0) {
+			return resID;
+		}
+		RunStats checkerStats;
+		resID = runChecker(config.checkerPath, testCaseFilePath, outputFilePath,
+		                   ansFilePath, resMsg, checkerStats);
+		std::remove(outputFilePath.c_str());
+		return resID;
+	}
+	// 每个评测线程复用同一块输出缓冲区
+	static thread_local std::string myansStr;
+	OutputBufferTrimmer myansTrimmer(myansStr);
+	resMsg.clear();
+	// 输入与标准答案都直接映射，比较与写入输入都在映射上进行
+	// 直接使用输入文件时不需要映射输入
 	ConsoleOJ myansEXE(testExePath);
-	// 获取待检测答案
-	if (!myansEXE.launchAndWait(testCaseStr, timeLimit, myansStr, timecost, errorMsg)) {
-		if (errorMsg.find("超时") != errorMsg.npos) {
-			m_TestERRStr = errorMsg;
-			return -3;
+	setupSolution(myansEXE, config);
+	SolutionInput input(myansEXE, testCaseFilePath, config);
+	if (config.isTokenCmp) {
+		// 按单词比较不区分换行符，不需要统一换行符
+		std::unique_ptr<TestDataContent> ansFile;
+		if (config.loadedCase == nullptr) {
+			ansFile = std::make_unique<TestDataContent>(ansFilePath);
 		}
-		m_TestERRStr = "运行待测程序失败，用时" + std::to_string(timecost)
-		               + "ms，原因：" + errorMsg;
-		return -1;
+		int resID = launchSolution(myansEXE, input, config, myansStr,
+		                           nullptr, resMsg, stats);
+		if (resID != 0) {
+			return resID;
+		}
+		std::string_view ansStr = ansFile ? ansFile->view() : config.loadedCase->ans.view();
+		return compareTokens(ansStr, myansStr, config.eps, resMsg) ? 0 : -2;
+	}
+	std::unique_ptr<MappedFile> ansFile;
+	std::string unifiedAnsStr;
+	std::string_view ansStr;
+	if (config.loadedCase != nullptr) {
+		// 标准答案已经在内存中，直接比较比按摘要评测更快
+		ansStr = config.isStreamCmp ? config.loadedCase->unifiedAns
+		         : config.loadedCase->ans.view();
+	} else {
+		AnsDigest ansDigest;
+		if (config.digestIndex != nullptr && config.digestIndex->find(ansFilePath, ansDigest)) {
+			return runTestWithDigest(myansEXE, input, ansFilePath, ansDigest,
+			                         config, resMsg, stats);
+		}
+		if (!isPlainTestData(ansFilePath)) {
+			// 压缩的标准答案只在WA时才完整解压，其余时候边解压边计算摘要
+			ansDigest = calcTestDataDigest(ansFilePath);
+			if (config.digestIndex != nullptr) {
+				config.digestIndex->update(ansFilePath, ansDigest);
+			}
+			return runTestWithDigest(myansEXE, input, ansFilePath, ansDigest,
+			                         config, resMsg, stats);
+		}
+		ansFile = std::make_unique<MappedFile>(ansFilePath);
+		if (config.digestIndex != nullptr) {
+			// 摘要缺失或已失效，顺便重新计算
+			config.digestIndex->update(ansFilePath, calcAnsDigest(ansFile->view()));
+		}
+		// 流式比较要求标准答案已经统一换行符，逐字节比较可以直接使用映射
+		ansStr = config.isStreamCmp ? getUnifiedText(ansFile->view(), unifiedAnsStr)
+		         : ansFile->view();
 	}
-	myansStr = unifyNewlines(myansStr);
-	ansStr = unifyNewlines(ansStr);
-	if (!compareAnsStr(ansStr, myansStr)) {
+	// 流式比较时，输出边读取边比较，不再保存
+	StreamAnsCmp streamCmp(ansStr);
+	if (config.isStreamCmp) {
+		myansEXE.setOutputSink([&streamCmp](const char* data, size_t len) {
+			return streamCmp.feed(data, len);
+		});
+	}
+	// 获取待检测答案
+	int resID = launchSolution(myansEXE, input, config, myansStr,
+	                           config.isStreamCmp ? &streamCmp : nullptr, resMsg, stats);
+	if (resID == -2) {
+		streamCmp.finish(resMsg);
 		return -2;
 	}
-	m_TestERRStr = std::to_string(timecost) ;
+	if (resID != 0) {
+		return resID;
+	}
+	if (config.isStreamCmp) {
+		if (!streamCmp.finish(resMsg)) {
+			return -2;
+		}
+	} else {
+		if (!checkAnsStr(ansStr, myansStr, config, resMsg)) {
+			return -2;
+		}
+	}
 	return 0;
 }
 
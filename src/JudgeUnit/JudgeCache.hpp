@@ -0,0 +1,205 @@
+/**
+ * \file    	JudgeCache.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		评测结果缓存，程序、输入、答案与评测配置都未变化的样例可以直接使用上一次的结果
+ */
+#ifndef _XY0797_JUDGECACHE
+#define _XY0797_JUDGECACHE 1
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include "ConsoleOJ.hpp"
+#include "MappedFile.hpp"
+#include "AnsDigest.hpp"
+#include "TestData.hpp"
+
+// 64位哈希值转为16位十六进制文本
+std::string formatHash64(uint64_t hash) {
+	char buf[17];
+	snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+	return buf;
+}
+
+// 文本内容的哈希值
+uint64_t calcHash64(std::string_view text) {
+	StreamHash64 hash;
+	hash.update(text.data(), text.size());
+	return hash.digest();
+}
+
+// 文件内容的哈希值，无法读取时抛出std::runtime_error
+uint64_t calcFileHash64(const std::string& filePath) {
+	MappedFile file(filePath);
+	return calcHash64(file.view());
+}
+
+// 缓存的评测结果
+struct CachedResult {
+	// 样例输入文件的路径，用于按样例查询上一次的结果
+	std::string casePath;
+	// 评测结果ID，含义与runTest的返回状态码相同
+	int resID = 1;
+	// 评测的结果信息
+	std::string resMsg;
+	// 程序消耗的CPU时间、真实时间与峰值内存，不含性能计数器
+	RunStats stats;
+	// checker消耗的资源
+	RunStats checkerStats;
+};
+
+// 评测结果缓存
+// 键由调用者根据程序的内容、输入与答案的路径、大小、修改时间以及评测配置生成，变化后键随之变化，旧结果不再被命中
+// 只保存本次评测用到的结果，上一次评测之前的结果不会无限累积
+// 可在多个线程中同时查询与更新
+class JudgeCache {
+private:
+	std::string m_cachePath;
+
+	// 从缓存文件读取的结果
+	std::unordered_map<std::string, CachedResult> m_loadedResults;
+
+	// 本次评测的结果，保存时写入缓存文件
+	std::unordered_map<std::string, CachedResult> m_curResults;
+
+	// 从缓存文件读取的各样例的结果ID，按输入文件路径查询
+	std::unordered_map<std::string, int> m_loadedResIDs;
+
+	mutable std::mutex m_mutex;
+
+	// 路径与结果信息可能含有换行，转义后才能写在一行里，\t用于分隔两者
+	static std::string escapeField(const std::string& msg) {
+		std::string res;
+		res.reserve(msg.size());
+		for (char ch : msg) {
+			if (ch == '\\') {
+				res += "\\\\";
+			} else if (ch == '\n') {
+				res += "\\n";
+			} else if (ch == '\r') {
+				res += "\\r";
+			} else if (ch == '\t') {
+				res += "\\t";
+			} else {
+				res += ch;
+			}
+		}
+		return res;
+	}
+
+	static std::string unescapeField(const std::string& str) {
+		std::string res;
+		res.reserve(str.size());
+		for (size_t i = 0; i < str.size(); ++i) {
+			if (str[i] == '\\' && i + 1 < str.size()) {
+				++i;
+				res += str[i] == 'n' ? '\n' : str[i] == 'r' ? '\r' : str[i] == 't' ? '\t' : str[i];
+			} else {
+				res += str[i];
+			}
+		}
+		return res;
+	}
+
+public:
+	JudgeCache() = default;
+	JudgeCache(const JudgeCache&) = delete;
+	JudgeCache& operator=(const JudgeCache&) = delete;
+
+	/*
+	 *	读取缓存文件，文件不存在时得到空的缓存，格式有误的行被忽略
+	 *  每行依次为：键 结果ID CPU用时 真实用时 峰值内存 checkerCPU用时 checker真实用时 输入文件路径
+	 *  路径之后以\t分隔结果信息
+	 */
+	void load(const std::string& cachePath) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cachePath = cachePath;
+		m_loadedResults.clear();
+		m_curResults.clear();
+		m_loadedResIDs.clear();
+		std::ifstream fin(cachePath);
+		std::string lineStr;
+		while (std::getline(fin, lineStr)) {
+			std::istringstream lineIn(lineStr);
+			std::string key;
+			CachedResult result;
+			if (lineIn >> key >> result.resID >> result.stats.cpuTimeUs
+			        >> result.stats.wallTimeUs >> result.stats.peakMemory
+			        >> result.checkerStats.cpuTimeUs >> result.checkerStats.wallTimeUs
+			        && lineIn.get() == ' ') {
+				std::string pathStr, msgStr;
+				if (!std::getline(lineIn, pathStr, '\t')) {
+					continue;
+				}
+				std::getline(lineIn, msgStr);
+				result.casePath = unescapeField(pathStr);
+				result.resMsg = unescapeField(msgStr);
+				m_loadedResIDs[result.casePath] = result.resID;
+				m_loadedResults[key] = result;
+			}
+		}
+	}
+
+	/*
+	 *	查询样例上一次的结果ID，没有记录时返回false
+	 */
+	bool findLastResID(const std::string& casePath, int& resID) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_loadedResIDs.find(casePath);
+		if (it == m_loadedResIDs.end()) {
+			return false;
+		}
+		resID = it->second;
+		return true;
+	}
+
+	/*
+	 *	查询上一次保存的结果，没有时返回false
+	 *  启动失败可能只是偶然，这样的结果只用于按样例查询，不会被直接使用
+	 */
+	bool find(const std::string& key, CachedResult& result) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_loadedResults.find(key);
+		if (it == m_loadedResults.end() || it->second.resID == -1) {
+			return false;
+		}
+		result = it->second;
+		return true;
+	}
+
+	/*
+	 *	记录本次评测的结果，直接使用的缓存结果也需要记录
+	 */
+	void update(const std::string& key, const CachedResult& result) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_curResults[key] = result;
+	}
+
+	/*
+	 *	把本次评测的结果写回缓存文件，返回是否成功
+	 */
+	bool save() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::ofstream fout(m_cachePath);
+		if (!fout.is_open()) {
+			return false;
+		}
+		for (const auto& e : m_curResults) {
+			const CachedResult& result = e.second;
+			fout << e.first << ' ' << result.resID << ' ' << result.stats.cpuTimeUs << ' '
+			     << result.stats.wallTimeUs << ' ' << result.stats.peakMemory << ' '
+			     << result.checkerStats.cpuTimeUs << ' ' << result.checkerStats.wallTimeUs
+			     << ' ' << escapeField(result.casePath) << '\t' << escapeField(result.resMsg) << '\n';
+		}
+		fout.close();
+		return static_cast<bool>(fout);
+	}
+};
+
+#endif /* _XY0797_JUDGECACHE */
@@ -0,0 +1,425 @@
+/**
+ * \file    	JudgeCluster.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		分布式评测的协调端，把样例分配给各评测机评测，评测机失联时改由其它评测机评测
+ */
+#ifndef _XY0797_JUDGECLUSTER
+#define _XY0797_JUDGECLUSTER 1
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <exception>
+#include <condition_variable>
+#include "../WindowsFileSysTool.hpp"
+#include "Judge.hpp"
+#include "MappedFile.hpp"
+#include "TestData.hpp"
+#include "JsonLine.hpp"
+#include "TcpSocket.hpp"
+#include "DistProtocol.hpp"
+
+// 发给评测机的一个请求
+struct ClusterRequest {
+	// 评测机要求发送的文件的哈希值，逗号分隔，为空表示没有要求
+	std::string needHashes;
+	// 已得到结果
+	bool isDone = false;
+	// 评测机在得到结果之前失联
+	bool isLost = false;
+	int resID = -1;
+	std::string resMsg;
+	RunStats stats;
+};
+
+// 协调端与一台评测机的连接
+struct ClusterWorker {
+	std::string addr;
+	std::unique_ptr<TcpConnection> conn;
+	// 可以同时评测的样例数与已分配的样例数，以下各项都在集群的锁内访问
+	int slotCnt = 0;
+	int busyCnt = 0;
+	bool isAlive = true;
+	// 等待结果的请求，按请求序号查找
+	std::map<long long, ClusterRequest*> requests;
+
+	// 发送时持有，一个文件的描述与内容必须连续发送
+	std::mutex writeMutex;
+	// 已经发送过的文件，在writeMutex内访问，评测机按顺序处理，之后的请求不必再发送
+	std::set<std::string> sentFiles;
+
+	// 读取评测机消息的线程
+	std::thread reader;
+};
+
+// 发送给评测机的文件
+struct ClusterFile {
+	std::string hash;
+	std::string exten;
+	bool isExecutable = false;
+	std::string_view content;
+};
+
+// 评测机集群
+// 每个样例由调用judge的线程分配给空闲的评测机并等待结果，评测机失联时改由其它评测机评测
+// 调用线程数与评测机的总并行数相同时，所有评测机都不会空闲
+class JudgeCluster {
+private:
+	std::vector<std::unique_ptr<ClusterWorker>> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	long long m_nextSeq = 0;
+
+	// 正在关闭，此时的断开不是失联
+	std::atomic<bool> m_isStopping{ false };
+
+	// 已计算的文件内容哈希值，按路径保存计算时的大小与修改时间，文件未变化时不再重新计算
+	// 同一程序的所有样例只需计算一次
+	std::mutex m_hashMutex;
+	std::map<std::string, std::pair<std::string, std::string>> m_hashMemo;
+
+	// 文件内容的哈希值，content为path的内容
+	std::string getFileHash(const std::string& path, std::string_view content) {
+		std::string stamp = getTestDataStamp(path);
+		{
+			std::lock_guard<std::mutex> lock(m_hashMutex);
+			auto it = m_hashMemo.find(path);
+			if (it != m_hashMemo.end() && it->second.first == stamp) {
+				return it->second.second;
+			}
+		}
+		std::string hash = getContentHash(content);
+		std::lock_guard<std::mutex> lock(m_hashMutex);
+		m_hashMemo[path] = std::make_pair(stamp, hash);
+		return hash;
+	}
+
+	// 标记评测机失联，其上所有未完成的请求都会改由其它评测机评测
+	void markLost(ClusterWorker& worker) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!worker.isAlive) {
+				return;
+			}
+			worker.isAlive = false;
+			for (auto& e : worker.requests) {
+				e.second->isLost = true;
+			}
+			worker.requests.clear();
+		}
+		worker.conn->shutdown();
+		m_cv.notify_all();
+		if (!m_isStopping) {
+			std::cerr << "\x1b[1;31m评测机" + worker.addr
+			          + "已失联，分配给它的样例将由其它评测机重新评测\x1b[22;0m\n";
+		}
+	}
+
+	void readerFunc(ClusterWorker* worker) {
+		std::string line, errMsg;
+		while (!m_isStopping && worker->conn->readLine(line)) {
+			std::map<std::string, std::string> fields;
+			if (!parseJsonLine(line, fields, errMsg)) {
+				break;
+			}
+			const std::string& event = fields["event"];
+			if (event != "result" && event != "need" && event != "error") {
+				continue;
+			}
+			long long seq;
+			try {
+				seq = std::stoll(fields["seq"]);
+			} catch (const std::exception& ex) {
+				continue;
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				auto it = worker->requests.find(seq);
+				if (it == worker->requests.end()) {
+					continue;
+				}
+				ClusterRequest& request = *it->second;
+				if (event == "need") {
+					request.needHashes = fields["hashes"];
+				} else {
+					request.isDone = true;
+					worker->requests.erase(it);
+					if (event == "error") {
+						request.resID = -1;
+						request.resMsg = "评测机" + worker->addr + "报告错误：" + fields["message"];
+					} else {
+						try {
+							request.resID = std::stoi(fields["resID"]);
+							request.stats.cpuTimeUs = std::stoll(fields["cpuUs"]);
+							request.stats.wallTimeUs = std::stoll(fields["wallUs"]);
+							request.stats.peakMemory = std::stoll(fields["memory"]);
+						} catch (const std::exception& ex) {
+							request.resID = -1;
+						}
+						request.resMsg = fields["message"];
+					}
+				}
+			}
+			m_cv.notify_all();
+		}
+		markLost(*worker);
+	}
+
+	// 取得一台有空闲的评测机并占用一个并行数，优先选择空闲最多的，没有存活的评测机时返回空指针
+	ClusterWorker* acquireWorker() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true) {
+			ClusterWorker* best = nullptr;
+			bool hasAlive = false;
+			for (const auto& e : m_workers) {
+				if (!e->isAlive) {
+					continue;
+				}
+				hasAlive = true;
+				if (e->busyCnt < e->slotCnt && (best == nullptr
+				                                || e->slotCnt - e->busyCnt > best->slotCnt - best->busyCnt)) {
+					best = e.get();
+				}
+			}
+			if (best != nullptr) {
+				++best->busyCnt;
+				return best;
+			}
+			if (!hasAlive) {
+				return nullptr;
+			}
+			m_cv.wait(lock);
+		}
+	}
+
+	void releaseWorker(ClusterWorker& worker) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--worker.busyCnt;
+		}
+		m_cv.notify_all();
+	}
+
+	bool sendLine(ClusterWorker& worker, const std::string& line) {
+		std::lock_guard<std::mutex> lock(worker.writeMutex);
+		return worker.conn->writeAll(line + "\n");
+	}
+
+	bool sendFile(ClusterWorker& worker, const ClusterFile& file) {
+		std::lock_guard<std::mutex> lock(worker.writeMutex);
+		std::string fileKey = file.hash + file.exten + (file.isExecutable ? "x" : "");
+		if (worker.sentFiles.count(fileKey) > 0) {
+			return true;
+		}
+		std::string header = JsonLineWriter().addString("op", "file")
+		                     .addString("hash", file.hash)
+		                     .addString("ext", file.exten)
+		                     .addBool("executable", file.isExecutable)
+		                     .addNumber("size", static_cast<long long>(file.content.size())).str();
+		if (!worker.conn->writeAll(header + "\n") || !worker.conn->writeAll(file.content)) {
+			return false;
+		}
+		worker.sentFiles.insert(fileKey);
+		return true;
+	}
+
+	// 哈希值是否在逗号分隔的列表中
+	static bool isHashInList(const std::string& hash, const std::string& hashList) {
+		size_t pos = 0;
+		while (pos <= hashList.size()) {
+			size_t end = hashList.find(',', pos);
+			if (end == std::string::npos) {
+				end = hashList.size();
+			}
+			if (hashList.compare(pos, end - pos, hash) == 0) {
+				return true;
+			}
+			pos = end + 1;
+		}
+		return false;
+	}
+
+	/*
+	 *	在一台评测机上评测，按需发送文件，得到结果时返回true
+	 *  评测机失联时返回false，此时评测机已被标记为失联
+	 */
+	bool judgeOn(ClusterWorker& worker, const ClusterFile (&files)[3],
+	             const TestConfig& config, ClusterRequest& request) {
+		long long seq;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!worker.isAlive) {
+				return false;
+			}
+			seq = m_nextSeq++;
+			worker.requests[seq] = &request;
+		}
+		JsonLineWriter writer;
+		writer.addString("op", "judge").addNumber("seq", seq)
+		.addString("exe", files[0].hash).addString("exeExt", files[0].exten)
+		.addString("in", files[1].hash).addString("ans", files[2].hash);
+		addTestConfigFields(writer, config);
+		std::string requestLine = writer.str();
+		bool isSent = sendLine(worker, requestLine);
+		while (isSent) {
+			std::string needHashes;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_cv.wait(lock, [&request] {
+					return request.isDone || request.isLost || !request.needHashes.empty();
+				});
+				if (request.isDone || request.isLost) {
+					break;
+				}
+				needHashes.swap(request.needHashes);
+			}
+			for (const auto& file : files) {
+				if (isSent && isHashInList(file.hash, needHashes)) {
+					isSent = sendFile(worker, file);
+				}
+			}
+			isSent = isSent && sendLine(worker, requestLine);
+		}
+		// 发送失败时请求仍在等待，标记失联后才能确定不会再被访问
+		if (!isSent) {
+			markLost(worker);
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return request.isDone;
+	}
+
+public:
+	JudgeCluster() = default;
+	JudgeCluster(const JudgeCluster&) = delete;
+	JudgeCluster& operator=(const JudgeCluster&) = delete;
+
+	~JudgeCluster() {
+		m_isStopping = true;
+		for (const auto& e : m_workers) {
+			e->conn->shutdown();
+		}
+		for (const auto& e : m_workers) {
+			e->reader.join();
+		}
+	}
+
+	/*
+	 *	用令牌token连接评测机，返回其可以同时评测的样例数
+	 *  无法连接或被拒绝时返回0并把原因写在errMsg里面
+	 */
+	int addWorker(const std::string& addr, const std::string& token, std::string& errMsg) {
+		std::unique_ptr<TcpConnection> conn = connectTcp(addr, DIST_CONNECT_TIMEOUT_MS, errMsg);
+		if (!conn) {
+			return 0;
+		}
+		conn->setTimeout(DIST_TIMEOUT_MS);
+		std::string line;
+		std::map<std::string, std::string> fields;
+		int slotCnt = 0;
+		if (!conn->writeAll(JsonLineWriter().addString("op", "hello")
+		                    .addString("token", token).str() + "\n")) {
+			errMsg = "无法发送hello";
+			return 0;
+		}
+		if (!conn->readLine(line) || !parseJsonLine(line, fields, errMsg)) {
+			errMsg = addr + "不是有效的评测机";
+			return 0;
+		}
+		if (fields["event"] == "denied") {
+			errMsg = "评测机拒绝了连接：" + fields["message"];
+			return 0;
+		}
+		if (fields["event"] == "hello") {
+			try {
+				slotCnt = std::stoi(fields["slots"]);
+			} catch (const std::exception& ex) {
+				slotCnt = 0;
+			}
+		}
+		if (slotCnt <= 0) {
+			errMsg = addr + "不是有效的评测机";
+			return 0;
+		}
+		auto worker = std::make_unique<ClusterWorker>();
+		worker->addr = addr;
+		worker->conn = std::move(conn);
+		worker->slotCnt = slotCnt;
+		worker->reader = std::thread(&JudgeCluster::readerFunc, this, worker.get());
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_workers.push_back(std::move(worker));
+		return slotCnt;
+	}
+
+	// 存活的评测机的总并行数
+	int getSlotCnt() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		int slotCnt = 0;
+		for (const auto& e : m_workers) {
+			if (e->isAlive) {
+				slotCnt += e->slotCnt;
+			}
+		}
+		return slotCnt;
+	}
+
+	/*
+	 *	由评测机评测一个样例，阻塞直到得到结果，返回值与runTest相同，可在多个线程中同时调用
+	 *  程序与测试数据在本机读入，评测机缺少时才发送，压缩的测试数据解压后发送
+	 *  评测机失联时改由其它评测机评测，所有评测机都失联或重试次数过多时返回-1
+	 *  无法读取程序或测试数据时抛出std::runtime_error
+	 */
+	int judge(const std::string& testCaseFilePath, const std::string& ansFilePath,
+	          const std::string& exeFilePath, const TestConfig& config,
+	          std::string& resMsg, RunStats& stats) {
+		MappedFile exeFile(exeFilePath);
+		TestDataContent input(testCaseFilePath);
+		TestDataContent ans(ansFilePath);
+		// 评测机不接收更大的文件，发送后只会导致其断开
+		for (std::string_view content : { exeFile.view(), input.view(), ans.view() }) {
+			if (content.size() > static_cast<size_t>(DIST_MAX_FILE_SIZE)) {
+				resMsg = "程序或测试数据超过" + std::to_string(DIST_MAX_FILE_SIZE / 1024 / 1024)
+				         + "MB，无法发送给评测机";
+				return -1;
+			}
+		}
+		ClusterFile files[3];
+		files[0].content = exeFile.view();
+		files[0].exten = winfs::getFileExtenWithDot(winfs::getFileNameWithExten(exeFilePath));
+		files[0].isExecutable = true;
+		files[1].content = input.view();
+		files[2].content = ans.view();
+		files[0].hash = getFileHash(exeFilePath, files[0].content);
+		files[1].hash = getFileHash(testCaseFilePath, files[1].content);
+		files[2].hash = getFileHash(ansFilePath, files[2].content);
+		for (int retryCnt = 0; retryCnt <= DIST_MAX_CASE_RETRY; ++retryCnt) {
+			ClusterWorker* worker = acquireWorker();
+			if (worker == nullptr) {
+				resMsg = "所有评测机都已失联，无法评测";
+				return -1;
+			}
+			ClusterRequest request;
+			bool isDone = judgeOn(*worker, files, config, request);
+			releaseWorker(*worker);
+			if (isDone) {
+				resMsg = request.resMsg;
+				stats = request.stats;
+				return request.resID;
+			}
+		}
+		resMsg = "评测该样例时评测机已失联" + std::to_string(DIST_MAX_CASE_RETRY + 1)
+		         + "次，不再重试";
+		return -1;
+	}
+};
+
+#endif /* _XY0797_JUDGECLUSTER */
@@ -0,0 +1,411 @@
+/**
+ * \file    	JudgeDaemon.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		评测守护进程，通过本地套接字接收JSON评测任务，常用的测试集保留在内存中
+ */
+#ifndef _XY0797_JUDGEDAEMON
+#define _XY0797_JUDGEDAEMON 1
+
+#include <map>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+#include <condition_variable>
+#include "../CPUCoreTool.hpp"
+#include "../WindowsFileSysTool.hpp"
+#include "Judge.hpp"
+#include "TestSet.hpp"
+#include "JsonLine.hpp"
+#include "LocalSocket.hpp"
+
+/*
+ *	通信协议：连接建立后双方各自每行发送一个JSON对象，一个连接可以先后提交多个任务
+ *  任务：{"id":"任务标识","tests":"测试集路径","exe":"程序路径",
+ *         "timeLimit":限时(ms，默认1000),"inExt":".in","ansExt":".out"}
+ *  只有tests与exe必须提供，测试集的形式与交互式评测相同，id原样写在该任务的所有回复中
+ *  回复：
+ *    {"id":...,"event":"accepted","cases":样例数,"cached":测试集是否来自缓存}
+ *    {"id":...,"event":"case","index":样例序号(从1开始),"name":样例名,"result":"AC",
+ *     "cpuUs":CPU用时,"wallUs":真实用时,"memory":峰值内存(字节),"message":评测信息}
+ *    {"id":...,"event":"done","ac":通过的样例数,"total":样例数}
+ *    {"id":...,"event":"error","message":错误原因}
+ *  样例的结果按完成的先后发送，不一定按序号顺序
+ *  客户端需要保持连接直到收到所有结果，连接关闭后其尚未开始评测的样例不再评测
+ */
+
+// 守护进程在内存中保留的测试集数量，超过时淘汰最久未使用的测试集
+const size_t DAEMON_CACHED_SET_CNT = 8;
+
+// 守护进程接受连接失败后重试前的等待时间(ms)
+const long long DAEMON_ACCEPT_RETRY_MS = 100;
+
+// 测试集中的一个样例
+struct DaemonTestCase {
+	std::string testCasePath;
+	std::string ansPath;
+	// 显示的名称，含输入文件后缀
+	std::string name;
+	// 读入的测试数据，读入失败时为空，评测时再打开文件，由评测报告错误
+	std::unique_ptr<LoadedTestCase> loaded;
+};
+
+// 已读入内存的测试集
+struct LoadedTestSet {
+	// 按显示顺序排列的样例
+	std::vector<DaemonTestCase> cases;
+	// 读入时各文件的路径、大小与修改时间，不同则测试集已经变化
+	std::string stamp;
+};
+
+// 测试集缓存，最多保留DAEMON_CACHED_SET_CNT个测试集
+// 每次取得测试集时重新枚举样例并检查文件是否变化，变化后重新读入
+// 可在多个线程中同时调用
+class TestSetCache {
+private:
+	std::mutex m_mutex;
+
+	// 最近使用的测试集排在前面
+	std::list<std::pair<std::string, std::shared_ptr<const LoadedTestSet>>> m_sets;
+
+public:
+	/*
+	 *	取得测试集，isCached表示是否直接使用了缓存中的测试集
+	 *  测试集中没有样例时抛出std::runtime_error
+	 */
+	std::shared_ptr<const LoadedTestSet> get(const std::string& testSetPath,
+	        const std::string& testCaseExtension,
+	        const std::string& ansExtension, bool& isCached) {
+		std::string key = testSetPath + '\n' + testCaseExtension + '\n' + ansExtension;
+		std::vector<std::string> testCaseFiles = getTestCaseFiles(testSetPath,
+		        testCaseExtension);
+		std::sort(testCaseFiles.begin(), testCaseFiles.end(),
+		[](const std::string & a, const std::string & b) {
+			return isCaseNameLess(getTestCaseName(a), getTestCaseName(b));
+		});
+		auto testSet = std::make_shared<LoadedTestSet>();
+		for (const auto& path : testCaseFiles) {
+			DaemonTestCase testCase;
+			testCase.testCasePath = path;
+			testCase.ansPath = getAnsFilePathOf(path, testCaseExtension, ansExtension);
+			testCase.name = getTestCaseName(path) + testCaseExtension;
+			testSet->stamp += path + '\n' + getTestDataStamp(path) + '\n'
+			                  + testCase.ansPath + '\n' + getTestDataStamp(testCase.ansPath) + '\n';
+			testSet->cases.push_back(std::move(testCase));
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (auto it = m_sets.begin(); it != m_sets.end(); ++it) {
+				if (it->first == key && it->second->stamp == testSet->stamp) {
+					m_sets.splice(m_sets.begin(), m_sets, it);
+					isCached = true;
+					return m_sets.front().second;
+				}
+			}
+		}
+		// 读入时不持有锁，不影响其它连接使用缓存
+		for (auto& testCase : testSet->cases) {
+			try {
+				testCase.loaded = std::make_unique<LoadedTestCase>(testCase.testCasePath,
+				                  testCase.ansPath);
+			} catch (const std::exception& ex) {
+				testCase.loaded.reset();
+			}
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_sets.remove_if([&key](const std::pair<std::string, std::shared_ptr<const LoadedTestSet>>& e) {
+			return e.first == key;
+		});
+		m_sets.emplace_front(key, testSet);
+		// 仍在评测的任务持有测试集，淘汰后等任务结束才释放
+		while (m_sets.size() > DAEMON_CACHED_SET_CNT) {
+			m_sets.pop_back();
+		}
+		isCached = false;
+		return testSet;
+	}
+};
+
+struct DaemonJob;
+
+// 守护进程的一个连接
+class DaemonClient {
+private:
+	std::unique_ptr<LocalConnection> m_conn;
+	std::mutex m_writeMutex;
+	std::atomic<bool> m_isClosed;
+
+public:
+	// 还有样例未开始评测的任务，按提交顺序排列，只在任务队列的锁内访问
+	std::deque<std::shared_ptr<DaemonJob>> pendingJobs;
+
+	explicit DaemonClient(std::unique_ptr<LocalConnection> conn)
+		: m_conn(std::move(conn)), m_isClosed(false) {}
+
+	// 读取一行请求，只在该连接的线程中调用
+	bool readLine(std::string& line) {
+		return m_conn->readLine(line);
+	}
+
+	// 发送一行回复，可在多个线程中同时调用，发送失败后连接视为已关闭
+	void send(const std::string& line) {
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		if (!m_isClosed && !m_conn->writeAll(line + "\n")) {
+			m_isClosed = true;
+		}
+	}
+
+	// 对方已断开，只在该连接的线程中调用
+	void markClosed() {
+		m_isClosed = true;
+	}
+
+	// 是否已无法发送，此时其任务不再评测
+	bool isClosed() const {
+		return m_isClosed;
+	}
+};
+
+// 守护进程中的一个评测任务
+struct DaemonJob {
+	std::string id;
+	std::shared_ptr<DaemonClient> client;
+	std::shared_ptr<const LoadedTestSet> testSet;
+	std::string exePath;
+	long long timeLimit = 1000;
+	// 下一个开始评测的样例，在任务队列的锁内访问
+	size_t nextCase = 0;
+	// 已完成与通过的样例数
+	std::atomic<size_t> doneCnt{ 0 };
+	std::atomic<size_t> ACcnt{ 0 };
+};
+
+// 评测守护进程
+// 工作线程轮流为各连接评测一个样例，同一连接的任务按提交顺序评测
+// 一个连接提交的大量任务不会让其它连接的任务一直等待
+class JudgeDaemon {
+private:
+	// 与样例无关的评测配置
+	TestConfig m_baseConfig;
+
+	int m_workerCnt;
+	bool m_pinCPU;
+
+	TestSetCache m_testSetCache;
+
+	// 有任务等待评测的连接，按轮转顺序排列
+	std::deque<std::shared_ptr<DaemonClient>> m_clientQueue;
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCV;
+
+	// 多个线程输出日志时不交错
+	std::mutex m_logMutex;
+
+	void log(const std::string& msg) {
+		std::lock_guard<std::mutex> lock(m_logMutex);
+		std::cout << msg << std::endl;
+	}
+
+	void sendError(DaemonClient& client, const std::string& id, const std::string& msg) {
+		client.send(JsonLineWriter().addString("id", id).addString("event", "error")
+		            .addString("message", msg).str());
+	}
+
+	// 取得下一个要评测的样例，已断开的连接的任务直接丢弃
+	void takeCase(std::shared_ptr<DaemonJob>& job, size_t& caseIndex) {
+		std::unique_lock<std::mutex> lock(m_queueMutex);
+		while (true) {
+			m_queueCV.wait(lock, [this] {
+				return !m_clientQueue.empty();
+			});
+			std::shared_ptr<DaemonClient> client = m_clientQueue.front();
+			m_clientQueue.pop_front();
+			if (client->isClosed()) {
+				for (const auto& e : client->pendingJobs) {
+					log("任务[" + e->id + "]的连接已断开，不再评测剩余样例");
+				}
+				client->pendingJobs.clear();
+				continue;
+			}
+			job = client->pendingJobs.front();
+			caseIndex = job->nextCase++;
+			if (job->nextCase == job->testSet->cases.size()) {
+				client->pendingJobs.pop_front();
+			}
+			if (!client->pendingJobs.empty()) {
+				m_clientQueue.push_back(client);
+			}
+			return;
+		}
+	}
+
+	void workerFunc(int workerID) {
+		int cpuIndex = m_pinCPU ? cpucore::getWorkerCPU(workerID) : -1;
+		while (true) {
+			std::shared_ptr<DaemonJob> job;
+			size_t caseIndex;
+			takeCase(job, caseIndex);
+			const DaemonTestCase& testCase = job->testSet->cases[caseIndex];
+			TestConfig config = m_baseConfig;
+			config.timeLimit = job->timeLimit;
+			config.cpuIndex = cpuIndex;
+			config.loadedCase = testCase.loaded.get();
+			std::string resMsg;
+			RunStats stats;
+			int resID;
+			try {
+				resID = runTest(testCase.testCasePath, testCase.ansPath, job->exePath,
+				                config, resMsg, stats);
+			} catch (const std::exception& ex) {
+				resMsg = std::string("评测时遇到异常：") + ex.what();
+				resID = -1;
+			}
+			if (resID == 0) {
+				++job->ACcnt;
+			}
+			job->client->send(JsonLineWriter().addString("id", job->id)
+			                  .addString("event", "case")
+			                  .addNumber("index", static_cast<long long>(caseIndex + 1))
+			                  .addString("name", testCase.name)
+			                  .addString("result", getResName(resID))
+			                  .addNumber("cpuUs", stats.cpuTimeUs)
+			                  .addNumber("wallUs", stats.wallTimeUs)
+			                  .addNumber("memory", stats.peakMemory)
+			                  .addString("message", resMsg).str());
+			size_t caseCnt = job->testSet->cases.size();
+			if (++job->doneCnt == caseCnt) {
+				job->client->send(JsonLineWriter().addString("id", job->id)
+				                  .addString("event", "done")
+				                  .addNumber("ac", static_cast<long long>(job->ACcnt))
+				                  .addNumber("total", static_cast<long long>(caseCnt)).str());
+				log("任务[" + job->id + "]完成，通过情况：" + std::to_string(job->ACcnt)
+				    + "/" + std::to_string(caseCnt));
+			}
+		}
+	}
+
+	// 处理一行请求，读入测试集后把任务放入队列
+	void handleRequest(const std::shared_ptr<DaemonClient>& client, const std::string& line) {
+		std::map<std::string, std::string> fields;
+		std::string errMsg;
+		if (!parseJsonLine(line, fields, errMsg)) {
+			sendError(*client, "", "请求格式有误：" + errMsg);
+			return;
+		}
+		auto job = std::make_shared<DaemonJob>();
+		job->id = fields["id"];
+		job->client = client;
+		job->exePath = fields["exe"];
+		std::string testSetPath = fields["tests"];
+		if (testSetPath.empty() || !isTestDataExist(testSetPath)) {
+			sendError(*client, job->id, "测试集不存在：" + testSetPath);
+			return;
+		}
+		if (!winfs::isFileExist(job->exePath) || winfs::isDir(job->exePath)) {
+			sendError(*client, job->id, "程序不存在：" + job->exePath);
+			return;
+		}
+		if (!fields["timeLimit"].empty()) {
+			try {
+				job->timeLimit = std::stoll(fields["timeLimit"]);
+			} catch (const std::exception& ex) {
+				job->timeLimit = 0;
+			}
+			if (job->timeLimit <= 0) {
+				sendError(*client, job->id, "时间限制无效：" + fields["timeLimit"]);
+				return;
+			}
+		}
+		std::string testCaseExtension = fields["inExt"].empty() ? ".in" : fields["inExt"];
+		std::string ansExtension = fields["ansExt"].empty() ? ".out" : fields["ansExt"];
+		if (!isTestSetMultiCase(testSetPath)) {
+			testCaseExtension = winfs::getFileExtenWithDot(removeCompressExten(testSetPath));
+		}
+		bool isCached;
+		try {
+			job->testSet = m_testSetCache.get(testSetPath, testCaseExtension,
+			                                  ansExtension, isCached);
+		} catch (const std::exception& ex) {
+			sendError(*client, job->id, std::string("无法读入测试集：") + ex.what());
+			return;
+		}
+		size_t caseCnt = job->testSet->cases.size();
+		client->send(JsonLineWriter().addString("id", job->id).addString("event", "accepted")
+		             .addNumber("cases", static_cast<long long>(caseCnt))
+		             .addBool("cached", isCached).str());
+		log("收到任务[" + job->id + "]：" + job->exePath + "，测试集" + testSetPath + "，"
+		    + std::to_string(caseCnt) + "个样例" + (isCached ? "(测试集来自缓存)" : ""));
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			// 连接没有等待评测的任务时才需要重新加入轮转
+			if (client->pendingJobs.empty()) {
+				m_clientQueue.push_back(client);
+			}
+			client->pendingJobs.push_back(job);
+		}
+		m_queueCV.notify_all();
+	}
+
+	void clientFunc(std::shared_ptr<DaemonClient> client) {
+		std::string line;
+		while (client->readLine(line)) {
+			if (!line.empty()) {
+				handleRequest(client, line);
+			}
+		}
+		// 读取失败说明对方已断开，不必等到发送结果失败才停止评测其任务
+		client->markClosed();
+	}
+
+public:
+	/*
+	 *	构造时传入：与样例无关的评测配置、工作线程数(小于1则使用默认值)、是否绑定核心
+	 */
+	JudgeDaemon(const TestConfig& baseConfig, int workerCnt, bool pinCPU)
+		: m_baseConfig(baseConfig),
+		  m_workerCnt(workerCnt < 1 ? cpucore::getDefaultWorkerCnt() : workerCnt),
+		  m_pinCPU(pinCPU) {}
+
+	JudgeDaemon(const JudgeDaemon&) = delete;
+	JudgeDaemon& operator=(const JudgeDaemon&) = delete;
+
+	int getWorkerCnt() const {
+		return m_workerCnt;
+	}
+
+	/*
+	 *	在path上监听并处理任务，每个连接由单独的线程读取请求
+	 *  无法监听时返回false并把原因写在errMsg里面，开始监听后不再返回
+	 */
+	bool serve(const std::string& path, std::string& errMsg) {
+		LocalServer server;
+		if (!server.listen(path, errMsg)) {
+			return false;
+		}
+		for (int i = 0; i < m_workerCnt; ++i) {
+			std::thread(&JudgeDaemon::workerFunc, this, i).detach();
+		}
+		log("守护进程已开始监听：" + path + "，并行评测线程数：" + std::to_string(m_workerCnt));
+		while (true) {
+			std::unique_ptr<LocalConnection> conn = server.accept();
+			if (!conn) {
+				// 文件描述符耗尽等情况可能只是暂时的，稍后重试
+				std::this_thread::sleep_for(std::chrono::milliseconds(DAEMON_ACCEPT_RETRY_MS));
+				continue;
+			}
+			auto client = std::make_shared<DaemonClient>(std::move(conn));
+			std::thread(&JudgeDaemon::clientFunc, this, client).detach();
+		}
+	}
+};
+
+#endif /* _XY0797_JUDGEDAEMON */
@@ -0,0 +1,236 @@
+/**
+ * \file    	JudgePool.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		并行评测的工作线程池，结果按任务序号顺序交付
+ */
+#ifndef _XY0797_JUDGEPOOL
+#define _XY0797_JUDGEPOOL 1
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+#include "../CPUCoreTool.hpp"
+
+class JudgePool {
+private:
+	// 工作线程数
+	int m_workerCnt;
+
+	// 是否把工作线程的任务绑定到各自的核心
+	bool m_pinCPU;
+
+	// 任务的执行顺序，为空则按任务序号从小到大执行
+	std::vector<size_t> m_execOrder;
+
+	// 任务先于前面的任务完成时的通知函数
+	std::function<void(size_t)> m_onEarlyDone;
+
+public:
+	/*
+	 *	构造时传入：工作线程数(小于1则使用默认值)、是否绑定核心
+	 */
+	explicit JudgePool(int workerCnt, bool pinCPU = true)
+		: m_workerCnt(workerCnt < 1 ? cpucore::getDefaultWorkerCnt() : workerCnt),
+		  m_pinCPU(pinCPU) {}
+
+	int getWorkerCnt() const {
+		return m_workerCnt;
+	}
+
+	/*
+	 *	设置任务的执行顺序，必须是全部任务序号的一个排列，传入空数组则恢复为按序号执行
+	 *  只影响任务开始执行的先后，onDone仍按任务序号从小到大执行
+	 */
+	void setExecOrder(std::vector<size_t> execOrder) {
+		m_execOrder = std::move(execOrder);
+	}
+
+	/*
+	 *	设置提前完成的通知函数，传入空函数则不通知
+	 *  任务在序号更小的任务之前完成时，在调用线程中尽快执行onEarlyDone(任务序号)
+	 *  之后仍会按顺序对其执行onDone
+	 */
+	void setOnEarlyDone(std::function<void(size_t)> onEarlyDone) {
+		m_onEarlyDone = std::move(onEarlyDone);
+	}
+
+	/*
+	 *	并行执行taskCnt个任务
+	 *  task(任务序号, 绑定的逻辑CPU序号)：在工作线程中执行，不绑定时CPU序号为-1
+	 *  onDone(任务序号)：在调用线程中按任务序号从小到大依次执行
+	 *  任务抛出的异常会在所有工作线程结束后于调用线程重新抛出
+	 */
+	void run(size_t taskCnt, const std::function<void(size_t, int)>& task,
+	         const std::function<void(size_t)>& onDone) {
+		run(taskCnt, task, nullptr, onDone);
+	}
+
+	/*
+	 *	并行执行taskCnt个任务，每个任务分为两个阶段
+	 *  task(任务序号, 绑定的逻辑CPU序号)：第一阶段，在工作线程中执行
+	 *  check(任务序号)：第二阶段，在另一组不绑定核心的检查线程中执行，为空则没有第二阶段
+	 *  工作线程交出任务后立即开始下一个任务，第二阶段的耗时与后续任务的执行重叠
+	 *  onDone(任务序号)：两个阶段都完成后，在调用线程中按任务序号从小到大依次执行
+	 *  任何阶段抛出的异常会在所有线程结束后于调用线程重新抛出，抛出异常的任务不再执行第二阶段
+	 */
+	void run(size_t taskCnt, const std::function<void(size_t, int)>& task,
+	         const std::function<void(size_t)>& check,
+	         const std::function<void(size_t)>& onDone) {
+		std::vector<char> doneList(taskCnt, 0);
+		// 按完成先后记录的任务序号，用于提前完成的通知
+		std::vector<size_t> finishList;
+		std::vector<std::exception_ptr> errList(taskCnt);
+		std::atomic<size_t> nextTask(0);
+		std::atomic<bool> isStop(false);
+		std::mutex doneMutex;
+		std::condition_variable doneCV;
+		// 等待第二阶段的任务，以及仍在执行第一阶段的工作线程数
+		std::deque<size_t> checkQueue;
+		size_t runningWorkerCnt = 0;
+		std::mutex checkMutex;
+		std::condition_variable checkCV;
+
+		auto markDone = [&](size_t taskID) {
+			{
+				std::lock_guard<std::mutex> lock(doneMutex);
+				doneList[taskID] = 1;
+				finishList.push_back(taskID);
+			}
+			doneCV.notify_all();
+		};
+
+		auto workerFunc = [&](int workerID) {
+			int cpuIndex = m_pinCPU ? cpucore::getWorkerCPU(workerID) : -1;
+			while (!isStop) {
+				size_t slot = nextTask++;
+				if (slot >= taskCnt) {
+					break;
+				}
+				size_t taskID = m_execOrder.empty() ? slot : m_execOrder[slot];
+				try {
+					task(taskID, cpuIndex);
+				} catch (...) {
+					errList[taskID] = std::current_exception();
+				}
+				if (check && !errList[taskID]) {
+					{
+						std::lock_guard<std::mutex> lock(checkMutex);
+						checkQueue.push_back(taskID);
+					}
+					checkCV.notify_one();
+				} else {
+					markDone(taskID);
+				}
+			}
+			// 最后一个工作线程退出时唤醒所有检查线程，让它们处理完队列后退出
+			{
+				std::lock_guard<std::mutex> lock(checkMutex);
+				--runningWorkerCnt;
+			}
+			checkCV.notify_all();
+		};
+
+		auto checkFunc = [&]() {
+			while (true) {
+				size_t taskID;
+				{
+					std::unique_lock<std::mutex> lock(checkMutex);
+					checkCV.wait(lock, [&] {
+						return !checkQueue.empty() || runningWorkerCnt == 0;
+					});
+					if (checkQueue.empty()) {
+						break;
+					}
+					taskID = checkQueue.front();
+					checkQueue.pop_front();
+				}
+				if (!isStop) {
+					try {
+						check(taskID);
+					} catch (...) {
+						errList[taskID] = std::current_exception();
+					}
+				}
+				markDone(taskID);
+			}
+		};
+
+		std::vector<std::thread> workers;
+		size_t workerCnt = std::min(static_cast<size_t>(m_workerCnt), taskCnt);
+		runningWorkerCnt = workerCnt;
+		for (size_t i = 0; i < workerCnt; ++i) {
+			workers.emplace_back(workerFunc, static_cast<int>(i));
+		}
+		// 检查线程与工作线程数量相同
+		std::vector<std::thread> checkers;
+		if (check) {
+			for (size_t i = 0; i < workerCnt; ++i) {
+				checkers.emplace_back(checkFunc);
+			}
+		}
+
+		std::exception_ptr firstErr;
+		size_t notifiedCnt = 0;
+		for (size_t i = 0; i < taskCnt; ++i) {
+			while (true) {
+				std::vector<size_t> earlyList;
+				bool isReady;
+				{
+					std::unique_lock<std::mutex> lock(doneMutex);
+					doneCV.wait(lock, [&] {
+						return doneList[i] != 0
+						       || (m_onEarlyDone && notifiedCnt < finishList.size());
+					});
+					isReady = doneList[i] != 0;
+					for (; notifiedCnt < finishList.size(); ++notifiedCnt) {
+						if (finishList[notifiedCnt] > i) {
+							earlyList.push_back(finishList[notifiedCnt]);
+						}
+					}
+				}
+				// 通知函数在锁外执行，出错的任务留给下面按顺序处理
+				if (m_onEarlyDone) {
+					for (size_t taskID : earlyList) {
+						if (!errList[taskID]) {
+							m_onEarlyDone(taskID);
+						}
+					}
+				}
+				if (isReady) {
+					break;
+				}
+			}
+			if (errList[i]) {
+				firstErr = errList[i];
+				break;
+			}
+			try {
+				onDone(i);
+			} catch (...) {
+				firstErr = std::current_exception();
+				break;
+			}
+		}
+		if (firstErr) {
+			isStop = true;
+		}
+		for (auto& e : workers) {
+			e.join();
+		}
+		for (auto& e : checkers) {
+			e.join();
+		}
+		if (firstErr) {
+			std::rethrow_exception(firstErr);
+		}
+	}
+};
+
+#endif /* _XY0797_JUDGEPOOL */
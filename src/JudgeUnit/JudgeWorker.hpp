@@ -0,0 +1,510 @@
+/**
+ * \file    	JudgeWorker.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		分布式评测的评测机，通过TCP接收协调端分配的样例，测试数据按内容的哈希值缓存
+ */
+#ifndef _XY0797_JUDGEWORKER
+#define _XY0797_JUDGEWORKER 1
+
+#include <map>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <cstdio>
+#include <cerrno>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <condition_variable>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "../CPUCoreTool.hpp"
+#include "../WindowsFileSysTool.hpp"
+#include "Judge.hpp"
+#include "JsonLine.hpp"
+#include "TcpSocket.hpp"
+#include "DistProtocol.hpp"
+
+// 评测机接受连接失败后重试前的等待时间(ms)
+const long long WORKER_ACCEPT_RETRY_MS = 100;
+
+// 评测机的文件缓存，文件名由用途、内容的哈希值与后缀组成
+// 文件先写入临时文件再改名，多个评测机进程可以共用同一个缓存目录
+// 可在多个线程中同时调用
+class WorkerFileCache {
+private:
+	std::string m_dirPath;
+
+	std::mutex m_mutex;
+
+	// 已确认存在的文件名
+	std::set<std::string> m_knownFiles;
+
+	// 生成临时文件名
+	std::mt19937_64 m_random;
+
+	static std::string getFileName(const std::string& hash, const std::string& exten,
+	                               bool isExecutable) {
+		// 内容相同的程序与测试数据权限不同，不能共用一个文件
+		return (isExecutable ? "exe_" : "data_") + hash + exten;
+	}
+
+	// 把内容写入新文件，程序带有执行权限
+	// 文件不能被并行评测的程序继承，否则写入的程序一直处于打开状态而无法运行
+	static bool writeNewFile(const std::string& filePath, std::string_view content,
+	                         bool isExecutable) {
+#ifdef _WIN32
+		// 未指定安全属性时句柄不可继承
+		HANDLE hFile = CreateFileA(filePath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_NEW,
+		                           FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		bool isOK = true;
+		while (isOK && !content.empty()) {
+			DWORD len = 0;
+			DWORD toWrite = static_cast<DWORD>(std::min<size_t>(content.size(), 1 << 30));
+			isOK = WriteFile(hFile, content.data(), toWrite, &len, NULL) && len > 0;
+			content.remove_prefix(len);
+		}
+		return CloseHandle(hFile) && isOK;
+#else
+		int fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+		              isExecutable ? 0755 : 0644);
+		if (fd < 0) {
+			return false;
+		}
+		bool isOK = true;
+		while (isOK && !content.empty()) {
+			ssize_t len = write(fd, content.data(), content.size());
+			if (len < 0 && errno == EINTR) {
+				continue;
+			}
+			isOK = len > 0;
+			if (isOK) {
+				content.remove_prefix(static_cast<size_t>(len));
+			}
+		}
+		return close(fd) == 0 && isOK;
+#endif
+	}
+
+public:
+	/*
+	 *	使用dirPath作为缓存目录，不存在时创建，失败时抛出std::runtime_error
+	 */
+	explicit WorkerFileCache(const std::string& dirPath)
+		: m_dirPath(dirPath), m_random(std::random_device()()) {
+		if (!winfs::createDir(m_dirPath)) {
+			throw std::runtime_error("无法创建缓存目录：" + m_dirPath);
+		}
+	}
+
+	WorkerFileCache(const WorkerFileCache&) = delete;
+	WorkerFileCache& operator=(const WorkerFileCache&) = delete;
+
+	std::string getPath(const std::string& hash, const std::string& exten,
+	                    bool isExecutable) const {
+		return m_dirPath + winfs::PATH_SEP + getFileName(hash, exten, isExecutable);
+	}
+
+	// 缓存中是否已有该文件，之前运行时保存的文件同样有效
+	bool has(const std::string& hash, const std::string& exten, bool isExecutable) {
+		std::string fileName = getFileName(hash, exten, isExecutable);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_knownFiles.count(fileName) > 0) {
+				return true;
+			}
+		}
+		if (!winfs::isFileExist(getPath(hash, exten, isExecutable))) {
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_knownFiles.insert(fileName);
+		return true;
+	}
+
+	/*
+	 *	保存文件，内容与哈希值不符或无法写入时返回false并把原因写在errMsg里面
+	 */
+	bool put(const std::string& hash, const std::string& exten, bool isExecutable,
+	         std::string_view content, std::string& errMsg) {
+		if (getContentHash(content) != hash) {
+			errMsg = "文件内容与哈希值" + hash + "不符";
+			return false;
+		}
+		std::string filePath = getPath(hash, exten, isExecutable);
+		std::string tempPath;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			tempPath = filePath + ".tmp" + formatHash64(m_random());
+		}
+		if (!writeNewFile(tempPath, content, isExecutable)) {
+			std::remove(tempPath.c_str());
+			errMsg = "无法写入缓存文件：" + tempPath;
+			return false;
+		}
+		// 其它评测机进程已经保存了同一文件时，Windows下改名会失败，直接使用已有的文件即可
+		if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+			std::remove(tempPath.c_str());
+			if (!winfs::isFileExist(filePath)) {
+				errMsg = "无法写入缓存文件：" + filePath;
+				return false;
+			}
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_knownFiles.insert(getFileName(hash, exten, isExecutable));
+		return true;
+	}
+};
+
+// 评测机与协调端的一个连接
+class WorkerClient {
+private:
+	std::unique_ptr<TcpConnection> m_conn;
+	std::mutex m_writeMutex;
+	std::atomic<bool> m_isClosed;
+
+public:
+	explicit WorkerClient(std::unique_ptr<TcpConnection> conn)
+		: m_conn(std::move(conn)), m_isClosed(false) {}
+
+	// 读取一行请求，只在该连接的线程中调用
+	bool readLine(std::string& line) {
+		return m_conn->readLine(line);
+	}
+
+	// 读取紧跟在请求之后的文件内容，只在该连接的线程中调用
+	bool readExact(std::string& data, size_t len) {
+		return m_conn->readExact(data, len);
+	}
+
+	// 设置读写的超时(ms)，为0表示不超时
+	void setTimeout(long long ms) {
+		m_conn->setTimeout(ms);
+	}
+
+	// 发送一行回复，可在多个线程中同时调用，发送失败后连接视为已关闭
+	void send(const std::string& line) {
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		if (!m_isClosed && !m_conn->writeAll(line + "\n")) {
+			m_isClosed = true;
+		}
+	}
+
+	// 不再读写，尚未开始的样例不再评测
+	void close() {
+		m_isClosed = true;
+		m_conn->shutdown();
+	}
+
+	bool isClosed() const {
+		return m_isClosed;
+	}
+};
+
+// 评测机上等待评测的样例
+struct WorkerTask {
+	std::shared_ptr<WorkerClient> client;
+	long long seq = 0;
+	std::string exePath;
+	std::string testCasePath;
+	std::string ansPath;
+	TestConfig config;
+};
+
+// 分布式评测的评测机
+// 各连接的样例进入同一个队列，由与并行数相同的工作线程按到达顺序评测
+// 协调端在一个连接上同时分配的样例不超过hello中告知的并行数
+class JudgeWorker {
+private:
+	int m_slotCnt;
+	bool m_pinCPU;
+
+	// 协调端必须提供的令牌
+	std::string m_token;
+
+	WorkerFileCache m_fileCache;
+
+	std::deque<WorkerTask> m_taskQueue;
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCV;
+
+	// 多个线程输出日志时不交错
+	std::mutex m_logMutex;
+
+	void log(const std::string& msg) {
+		std::lock_guard<std::mutex> lock(m_logMutex);
+		std::cout << msg << std::endl;
+	}
+
+	void sendError(WorkerClient& client, long long seq, const std::string& msg) {
+		client.send(JsonLineWriter().addString("event", "error").addNumber("seq", seq)
+		            .addString("message", msg).str());
+	}
+
+	void workerFunc(int workerID) {
+		int cpuIndex = m_pinCPU ? cpucore::getWorkerCPU(workerID) : -1;
+		while (true) {
+			WorkerTask task;
+			{
+				std::unique_lock<std::mutex> lock(m_queueMutex);
+				m_queueCV.wait(lock, [this] {
+					return !m_taskQueue.empty();
+				});
+				task = std::move(m_taskQueue.front());
+				m_taskQueue.pop_front();
+			}
+			// 协调端已经断开，这些样例会被分配给其它评测机
+			if (task.client->isClosed()) {
+				continue;
+			}
+			task.config.cpuIndex = cpuIndex;
+			try {
+				judgeTask(task);
+			} catch (const std::exception& ex) {
+				// 无法回复结果，断开后协调端会把该连接上的样例改由其它评测机评测
+				log(std::string("回复评测结果时遇到异常：") + ex.what());
+				task.client->close();
+			}
+		}
+	}
+
+	// 评测一个样例并回复结果
+	void judgeTask(const WorkerTask& task) {
+		std::string resMsg;
+		RunStats stats;
+		int resID;
+		try {
+			resID = runTest(task.testCasePath, task.ansPath, task.exePath,
+			                task.config, resMsg, stats);
+		} catch (const std::exception& ex) {
+			resMsg = std::string("评测时遇到异常：") + ex.what();
+			resID = -1;
+		}
+		if (resMsg.size() > DIST_MAX_RESULT_MSG) {
+			resMsg.resize(DIST_MAX_RESULT_MSG);
+			resMsg += "\n(评测信息过长，之后的部分已省略)";
+		}
+		task.client->send(JsonLineWriter().addString("event", "result")
+		                  .addNumber("seq", task.seq)
+		                  .addNumber("resID", resID)
+		                  .addString("message", resMsg)
+		                  .addNumber("cpuUs", stats.cpuTimeUs)
+		                  .addNumber("wallUs", stats.wallTimeUs)
+		                  .addNumber("memory", stats.peakMemory).str());
+	}
+
+	// 处理评测请求，缓存中缺少文件时请求协调端发送，否则放入队列
+	void handleJudge(const std::shared_ptr<WorkerClient>& client,
+	                 std::map<std::string, std::string>& fields, long long seq) {
+		WorkerTask task;
+		task.client = client;
+		task.seq = seq;
+		std::string errMsg;
+		if (!parseTestConfigFields(fields, task.config, errMsg)) {
+			sendError(*client, seq, errMsg);
+			return;
+		}
+		const std::string& exeExten = fields["exeExt"];
+		const std::string* hashList[3] = { &fields["exe"], &fields["in"], &fields["ans"] };
+		for (const std::string* hash : hashList) {
+			if (!isValidContentHash(*hash)) {
+				sendError(*client, seq, "文件的哈希值无效：" + *hash);
+				return;
+			}
+		}
+		if (!isValidFileExten(exeExten)) {
+			sendError(*client, seq, "程序的后缀无效：" + exeExten);
+			return;
+		}
+		std::string needHashes;
+		for (int i = 0; i < 3; ++i) {
+			bool isExecutable = i == 0;
+			if (!m_fileCache.has(*hashList[i], isExecutable ? exeExten : "", isExecutable)) {
+				needHashes += (needHashes.empty() ? "" : ",") + *hashList[i];
+			}
+		}
+		if (!needHashes.empty()) {
+			client->send(JsonLineWriter().addString("event", "need").addNumber("seq", seq)
+			             .addString("hashes", needHashes).str());
+			return;
+		}
+		task.exePath = m_fileCache.getPath(*hashList[0], exeExten, true);
+		task.testCasePath = m_fileCache.getPath(*hashList[1], "", false);
+		task.ansPath = m_fileCache.getPath(*hashList[2], "", false);
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_taskQueue.push_back(std::move(task));
+		}
+		m_queueCV.notify_one();
+	}
+
+	// 接收紧跟在请求之后的文件，失败时返回false，此时连接中的数据已经无法继续解析
+	bool handleFile(WorkerClient& client, std::map<std::string, std::string>& fields,
+	                std::string& errMsg) {
+		const std::string& hash = fields["hash"];
+		const std::string& exten = fields["ext"];
+		long long size = -1;
+		try {
+			size = std::stoll(fields["size"]);
+		} catch (const std::exception& ex) {
+			size = -1;
+		}
+		if (!isValidContentHash(hash) || !isValidFileExten(exten) || size < 0) {
+			errMsg = "文件的描述无效";
+			return false;
+		}
+		// 大小来自网络，读入前必须检查，否则一个错误的请求就能耗尽内存
+		if (size > DIST_MAX_FILE_SIZE) {
+			errMsg = "文件过大：" + std::to_string(size) + "字节";
+			return false;
+		}
+		std::string content;
+		if (!client.readExact(content, static_cast<size_t>(size))) {
+			errMsg = "文件内容不完整";
+			return false;
+		}
+		return m_fileCache.put(hash, exten, fields["executable"] == "true", content, errMsg);
+	}
+
+	// 定时发送心跳，直到连接关闭
+	void heartbeatFunc(std::shared_ptr<WorkerClient> client) {
+		while (!client->isClosed()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(DIST_HEARTBEAT_MS));
+			client->send(JsonLineWriter().addString("event", "alive").str());
+		}
+	}
+
+	// 检查协调端的令牌，通过后回复hello，否则回复拒绝的原因
+	bool authenticate(WorkerClient& client, std::string& errMsg) {
+		// 未通过检查的连接不能一直占用线程
+		client.setTimeout(DIST_TIMEOUT_MS);
+		std::string line;
+		std::map<std::string, std::string> fields;
+		if (!client.readLine(line)) {
+			errMsg = "没有收到hello";
+			return false;
+		}
+		if (!parseJsonLine(line, fields, errMsg) || fields["op"] != "hello") {
+			errMsg = "第一个请求不是hello";
+		} else if (!isSameToken(fields["token"], m_token)) {
+			errMsg = "令牌错误";
+		} else {
+			client.setTimeout(0);
+			client.send(JsonLineWriter().addString("event", "hello")
+			            .addNumber("slots", m_slotCnt).str());
+			return true;
+		}
+		client.send(JsonLineWriter().addString("event", "denied")
+		            .addString("message", errMsg).str());
+		return false;
+	}
+
+	// 处理协调端的请求直到连接关闭，出错时把原因写在errMsg里面
+	void serveClient(const std::shared_ptr<WorkerClient>& client, std::string& errMsg) {
+		std::string line;
+		while (client->readLine(line)) {
+			std::map<std::string, std::string> fields;
+			if (!parseJsonLine(line, fields, errMsg)) {
+				errMsg = "请求格式有误：" + errMsg;
+				break;
+			}
+			const std::string& op = fields["op"];
+			if (op == "file") {
+				if (!handleFile(*client, fields, errMsg)) {
+					break;
+				}
+				continue;
+			}
+			long long seq;
+			try {
+				seq = std::stoll(fields["seq"]);
+			} catch (const std::exception& ex) {
+				errMsg = "请求缺少序号";
+				break;
+			}
+			if (op == "judge") {
+				handleJudge(client, fields, seq);
+			} else {
+				sendError(*client, seq, "未知的请求：" + op);
+			}
+		}
+	}
+
+	void clientFunc(std::shared_ptr<WorkerClient> client) {
+		std::string errMsg;
+		// 异常只断开这一个连接，不能结束整个评测机
+		try {
+			if (!authenticate(*client, errMsg)) {
+				client->close();
+				log("拒绝了协调端的连接：" + errMsg);
+				return;
+			}
+			log("协调端已连接");
+			std::thread(&JudgeWorker::heartbeatFunc, this, client).detach();
+			serveClient(client, errMsg);
+		} catch (const std::exception& ex) {
+			errMsg = std::string("处理请求时遇到异常：") + ex.what();
+		}
+		client->close();
+		log(errMsg.empty() ? "协调端已断开" : "与协调端的连接出错，已断开：" + errMsg);
+	}
+
+public:
+	/*
+	 *	构造时传入：并行评测的样例数(小于1则使用默认值)、是否绑定核心、缓存目录、
+	 *  协调端必须提供的令牌(不能为空)
+	 *  无法创建缓存目录时抛出std::runtime_error
+	 */
+	JudgeWorker(int slotCnt, bool pinCPU, const std::string& cacheDirPath,
+	            const std::string& token)
+		: m_slotCnt(slotCnt < 1 ? cpucore::getDefaultWorkerCnt() : slotCnt),
+		  m_pinCPU(pinCPU),
+		  m_token(token),
+		  m_fileCache(cacheDirPath) {}
+
+	JudgeWorker(const JudgeWorker&) = delete;
+	JudgeWorker& operator=(const JudgeWorker&) = delete;
+
+	/*
+	 *	在addr上监听协调端的连接并评测其分配的样例，每个连接由单独的线程读取请求
+	 *  无法监听时返回false并把原因写在errMsg里面，开始监听后不再返回
+	 */
+	bool serve(const std::string& addr, std::string& errMsg) {
+		TcpServer server;
+		if (!server.listen(addr, errMsg)) {
+			return false;
+		}
+		for (int i = 0; i < m_slotCnt; ++i) {
+			std::thread(&JudgeWorker::workerFunc, this, i).detach();
+		}
+		log("评测机已开始监听：" + addr + "，并行评测线程数：" + std::to_string(m_slotCnt));
+		while (true) {
+			std::unique_ptr<TcpConnection> conn = server.accept();
+			if (!conn) {
+				// 文件描述符耗尽等情况可能只是暂时的，稍后重试
+				std::this_thread::sleep_for(std::chrono::milliseconds(WORKER_ACCEPT_RETRY_MS));
+				continue;
+			}
+			auto client = std::make_shared<WorkerClient>(std::move(conn));
+			std::thread(&JudgeWorker::clientFunc, this, client).detach();
+		}
+	}
+};
+
+#endif /* _XY0797_JUDGEWORKER */
@@ -0,0 +1,348 @@
+/**
+ * \file    	LineDiff.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		按行对齐标准答案与程序输出，列出各处差异，多出或缺失行时后面的行不会都算作差异
+ */
+#ifndef _XY0797_LINEDIFF
+#define _XY0797_LINEDIFF 1
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "TestStringCmp.hpp"
+
+// 每次对齐时两边最多取出的行数，对齐只在窗口内进行，内存占用与输出的长度无关
+const size_t LINE_DIFF_WINDOW = 8192;
+
+// 窗口内允许的最大编辑距离，超过时缩小窗口重新对齐
+const int LINE_DIFF_MAX_EDIT = 1024;
+
+// 最多列出的差异处数
+const size_t LINE_DIFF_MAX_HUNKS = 10;
+
+// 每处差异每边最多显示的行数
+const long long LINE_DIFF_SHOW_LINES = 5;
+
+// 参与对齐的一行，先比较哈希值再比较内容
+struct DiffLine {
+	std::string_view text;
+	uint64_t hash;
+
+	// FNV-1a哈希
+	explicit DiffLine(std::string_view lineText)
+		: text(lineText), hash(14695981039346656037ull) {
+		for (char ch : lineText) {
+			hash = (hash ^ static_cast<unsigned char>(ch)) * 1099511628211ull;
+		}
+	}
+
+	bool operator==(const DiffLine& o) const {
+		return hash == o.hash && text == o.text;
+	}
+};
+
+// 一处差异：标准答案从aBegin起的aCnt行被替换为程序输出从bBegin起的bCnt行，行号从0开始
+struct LineDiffHunk {
+	long long aBegin = 0;
+	long long aCnt = 0;
+	long long bBegin = 0;
+	long long bCnt = 0;
+};
+
+// 按行读取文本，行的划分与compareAnsStr一致，取出的行已去除行末空格
+struct DiffLineCursor {
+	const char* pos;
+	const char* end;
+	// 已经取出的行数
+	long long lineNo = 0;
+
+	explicit DiffLineCursor(std::string_view text)
+		: pos(text.data()), end(text.data() + text.size()) {}
+
+	bool isEnd() const {
+		return pos == end;
+	}
+
+	std::string_view next() {
+		const char* lineEnd = findLineEnd(pos, end);
+		std::string_view line(pos, getTrimmedLen(pos, lineEnd));
+		pos = skipLineBreak(lineEnd, end);
+		++lineNo;
+		return line;
+	}
+};
+
+// 两边同时跳过相同的行，直到遇到不同的行或其中一边结束
+// 逐字节相同的部分用memcmp整段跳过，只在不同处逐行比较
+void skipSameLines(DiffLineCursor& a, DiffLineCursor& b) {
+	while (true) {
+		size_t sameLen = getCommonPrefixLen(a.pos, a.end - a.pos, b.pos, b.end - b.pos);
+		if (a.pos + sameLen == a.end && b.pos + sameLen == b.end) {
+			long long cnt = countLines(a.pos, a.end);
+			a.lineNo += cnt;
+			b.lineNo += cnt;
+			a.pos = a.end;
+			b.pos = b.end;
+			return;
+		}
+		// 退回到相同部分中最后一个\n之后，两边都位于行首
+		size_t skipLen = sameLen;
+		while (skipLen > 0 && a.pos[skipLen - 1] != '\n') {
+			--skipLen;
+		}
+		long long cnt = countLines(a.pos, a.pos + skipLen);
+		a.pos += skipLen;
+		b.pos += skipLen;
+		a.lineNo += cnt;
+		b.lineNo += cnt;
+		if (a.isEnd() || b.isEnd()) {
+			return;
+		}
+		DiffLineCursor nextA = a, nextB = b;
+		if (nextA.next() != nextB.next()) {
+			return;
+		}
+		a = nextA;
+		b = nextB;
+	}
+}
+
+// 用Myers算法求两段行的最短编辑，把编辑合并为差异写入hunks，行号相对于两段的开头
+// 编辑距离超过maxD时返回false，只保存各步的搜索前沿，内存占用为O(maxD^2)
+bool diffLineWindow(const std::vector<DiffLine>& a, const std::vector<DiffLine>& b,
+                    int maxD, std::vector<LineDiffHunk>& hunks) {
+	int n = static_cast<int>(a.size());
+	int m = static_cast<int>(b.size());
+	int offset = maxD + 1;
+	// v[offset + k]为对角线k(x - y = k)上到达的最远x
+	std::vector<int> v(2 * maxD + 3, 0);
+	// 各步结束后对角线-d..d上的最远x，用于倒推编辑
+	std::vector<int> trace;
+	std::vector<size_t> traceBegin;
+	int finalD = -1;
+	for (int d = 0; d <= maxD && finalD < 0; ++d) {
+		for (int k = -d; k <= d; k += 2) {
+			int x;
+			if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+				// 从对角线k+1向下：插入程序输出的一行
+				x = v[offset + k + 1];
+			} else {
+				// 从对角线k-1向右：删除标准答案的一行
+				x = v[offset + k - 1] + 1;
+			}
+			int y = x - k;
+			while (x < n && y < m && a[x] == b[y]) {
+				++x;
+				++y;
+			}
+			v[offset + k] = x;
+			if (x >= n && y >= m) {
+				finalD = d;
+				break;
+			}
+		}
+		traceBegin.push_back(trace.size());
+		trace.insert(trace.end(), v.begin() + offset - d, v.begin() + offset + d + 1);
+	}
+	if (finalD < 0) {
+		return false;
+	}
+	// 从终点倒推，相邻的编辑之间没有相同的行时属于同一处差异
+	hunks.clear();
+	int x = n, y = m;
+	for (int d = finalD; d > 0; --d) {
+		const int* pv = trace.data() + traceBegin[d - 1] + (d - 1);
+		int k = x - y;
+		bool isInsert = k == -d || (k != d && pv[k - 1] < pv[k + 1]);
+		int prevK = isInsert ? k + 1 : k - 1;
+		int prevX = pv[prevK];
+		int prevY = prevX - prevK;
+		int snakeLen = x - (isInsert ? prevX : prevX + 1);
+		if (hunks.empty() || snakeLen > 0) {
+			LineDiffHunk hunk;
+			hunk.aBegin = prevX;
+			hunk.bBegin = prevY;
+			hunks.push_back(hunk);
+		}
+		LineDiffHunk& hunk = hunks.back();
+		hunk.aBegin = prevX;
+		hunk.bBegin = prevY;
+		if (isInsert) {
+			++hunk.bCnt;
+		} else {
+			++hunk.aCnt;
+		}
+		x = prevX;
+		y = prevY;
+	}
+	std::reverse(hunks.begin(), hunks.end());
+	return true;
+}
+
+// 单行差异的显示，过长时折叠
+std::string getDiffLineShowStr(std::string_view line) {
+	if (line.empty()) {
+		return "\x1b[1;37;100m(空行)\x1b[0m";
+	}
+	if (line.size() > static_cast<size_t>(MAX_DIFF_SHOW_MAX)) {
+		return "\x1b[1;37;41m" + std::string(line.substr(0, MAX_DIFF_SHOW))
+		       + "\x1b[0m\x1b[1;37;100m...还有"
+		       + std::to_string(line.size() - MAX_DIFF_SHOW) + "个字符...\x1b[0m";
+	}
+	return "\x1b[1;37;41m" + std::string(line) + "\x1b[0m";
+}
+
+// 显示一处差异中一边的各行，带行号，最多显示LINE_DIFF_SHOW_LINES行
+std::string getDiffLinesShowStr(std::string_view text, const char* linePos,
+                                long long lineBegin, long long lineCnt) {
+	if (lineCnt == 0) {
+		return "\x1b[1;37;100m   空   \x1b[0m\n";
+	}
+	DiffLineCursor cursor(text);
+	cursor.pos = linePos;
+	std::string res;
+	long long showCnt = std::min(lineCnt, LINE_DIFF_SHOW_LINES);
+	for (long long i = 0; i < showCnt && !cursor.isEnd(); ++i) {
+		res += std::to_string(lineBegin + i + 1) + "| " + getDiffLineShowStr(cursor.next())
+		       + "\n";
+	}
+	if (lineCnt > showCnt) {
+		res += "\x1b[1;37;100m...还有" + std::to_string(lineCnt - showCnt) + "行...\x1b[0m\n";
+	}
+	return res;
+}
+
+// 行范围的文字描述，行号从0开始，显示时从1开始
+std::string getLineRangeStr(long long lineBegin, long long lineCnt) {
+	if (lineCnt == 1) {
+		return "第" + std::to_string(lineBegin + 1) + "行";
+	}
+	return "第" + std::to_string(lineBegin + 1) + "~" + std::to_string(lineBegin + lineCnt)
+	       + "行";
+}
+
+// 生成一处差异的信息，aPos与bPos为两边差异开始处的位置
+std::string genHunkMsg(std::string_view stdansStr, std::string_view myansStr,
+                       const LineDiffHunk& hunk, const char* aPos, const char* bPos) {
+	std::string msg;
+	if (hunk.aCnt > 0 && hunk.bCnt > 0) {
+		msg = "标准答案" + getLineRangeStr(hunk.aBegin, hunk.aCnt)
+		      + "，程序输出" + getLineRangeStr(hunk.bBegin, hunk.bCnt) + "\n";
+	} else if (hunk.aCnt > 0) {
+		msg = "程序输出缺失了标准答案的" + getLineRangeStr(hunk.aBegin, hunk.aCnt)
+		      + "，应在程序输出第" + std::to_string(hunk.bBegin + 1) + "行处\n";
+	} else {
+		msg = "程序输出" + getLineRangeStr(hunk.bBegin, hunk.bCnt)
+		      + "是多余的，位于标准答案第" + std::to_string(hunk.aBegin + 1) + "行处\n";
+	}
+	if (hunk.aCnt == 1 && hunk.bCnt == 1) {
+		// 一行对一行时逐字符标出差异
+		DiffLineCursor a(stdansStr), b(myansStr);
+		a.pos = aPos;
+		b.pos = bPos;
+		std::string lineMsg;
+		testStringCmp(std::string(a.next()), std::string(b.next()), lineMsg);
+		return msg + lineMsg + "\n";
+	}
+	msg += "标准答案: \n" + getDiffLinesShowStr(stdansStr, aPos, hunk.aBegin, hunk.aCnt);
+	msg += "程序输出：\n" + getDiffLinesShowStr(myansStr, bPos, hunk.bBegin, hunk.bCnt);
+	return msg;
+}
+
+// 在两边的当前位置开始对齐，求出第一处差异，isAligned表示差异之后两边是否重新对齐
+// 窗口内的编辑距离过大时缩小窗口，窗口足够小时编辑距离不可能超过限制
+LineDiffHunk findNextHunk(const DiffLineCursor& a, const DiffLineCursor& b,
+                          bool& isAligned) {
+	for (size_t window = LINE_DIFF_WINDOW;; window /= 2) {
+		std::vector<DiffLine> aLines, bLines;
+		DiffLineCursor aCursor = a, bCursor = b;
+		while (aLines.size() < window && !aCursor.isEnd()) {
+			aLines.emplace_back(aCursor.next());
+		}
+		while (bLines.size() < window && !bCursor.isEnd()) {
+			bLines.emplace_back(bCursor.next());
+		}
+		std::vector<LineDiffHunk> hunks;
+		if (!diffLineWindow(aLines, bLines, LINE_DIFF_MAX_EDIT, hunks)) {
+			continue;
+		}
+		LineDiffHunk hunk = hunks.front();
+		long long aEnd = hunk.aBegin + hunk.aCnt;
+		long long bEnd = hunk.bBegin + hunk.bCnt;
+		// 差异延续到窗口末尾时，只有两边都已经结束才算对齐
+		isAligned = aEnd < static_cast<long long>(aLines.size())
+		            || bEnd < static_cast<long long>(bLines.size())
+		            || (aCursor.isEnd() && bCursor.isEnd());
+		if (!isAligned && (aCursor.isEnd() || bCursor.isEnd())) {
+			// 一边已经结束，另一边剩下的行都属于这处差异
+			hunk.aCnt = countLines(a.pos, a.end) - hunk.aBegin;
+			hunk.bCnt = countLines(b.pos, b.end) - hunk.bBegin;
+			isAligned = true;
+		}
+		hunk.aBegin += a.lineNo;
+		hunk.bBegin += b.lineNo;
+		return hunk;
+	}
+}
+
+// 按行对齐标准答案与程序输出，列出各处差异，在compareAnsStr判定不一致后调用
+// 行的划分与比较规则与compareAnsStr一致，相同的行不计入差异
+// 对齐在有限大小的窗口内用Myers算法进行，每处差异都是窗口内的最短编辑
+// 最多列出LINE_DIFF_MAX_HUNKS处差异，差异过于密集无法重新对齐时停止
+void genLineDiffMsg(std::string_view stdansStr, std::string_view myansStr,
+                    std::string& diffMsg) {
+	DiffLineCursor a(stdansStr), b(myansStr);
+	std::string hunksMsg;
+	size_t hunkCnt = 0;
+	bool isAligned = true;
+	bool isMore = false;
+	while (true) {
+		skipSameLines(a, b);
+		if (a.isEnd() && b.isEnd()) {
+			break;
+		}
+		if (hunkCnt == LINE_DIFF_MAX_HUNKS || !isAligned) {
+			isMore = true;
+			break;
+		}
+		LineDiffHunk hunk;
+		if (a.isEnd() || b.isEnd()) {
+			// 其中一边已经结束，另一边剩下的行都是差异
+			hunk.aBegin = a.lineNo;
+			hunk.bBegin = b.lineNo;
+			hunk.aCnt = countLines(a.pos, a.end);
+			hunk.bCnt = countLines(b.pos, b.end);
+		} else {
+			hunk = findNextHunk(a, b, isAligned);
+		}
+		++hunkCnt;
+		hunksMsg += "第" + std::to_string(hunkCnt) + "处差异："
+		            + genHunkMsg(stdansStr, myansStr, hunk, a.pos, b.pos);
+		// 跳过差异中的行
+		for (long long i = 0; i < hunk.aCnt && !a.isEnd(); ++i) {
+			a.next();
+		}
+		for (long long i = 0; i < hunk.bCnt && !b.isEnd(); ++i) {
+			b.next();
+		}
+	}
+	diffMsg = "按行对齐后";
+	if (isMore) {
+		diffMsg += isAligned ? "列出前" + std::to_string(hunkCnt) + "处差异"
+		           : "列出" + std::to_string(hunkCnt) + "处差异，之后差异过多，不再对齐";
+	} else {
+		diffMsg += "共有" + std::to_string(hunkCnt) + "处差异";
+	}
+	diffMsg += "，标准答案共" + std::to_string(countLines(stdansStr.data(),
+	           stdansStr.data() + stdansStr.size()))
+	           + "行，程序输出共" + std::to_string(countLines(myansStr.data(),
+	                   myansStr.data() + myansStr.size())) + "行\n" + hunksMsg;
+	while (!diffMsg.empty() && diffMsg.back() == '\n') {
+		diffMsg.pop_back();
+	}
+}
+
+#endif /* _XY0797_LINEDIFF */
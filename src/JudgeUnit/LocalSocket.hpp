@@ -0,0 +1,33 @@
+/**
+ * \file    	LocalSocket.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		本机进程间的双向连接，POSIX下为Unix域套接字，Windows下为命名管道
+ */
+#ifndef _XY0797_LOCALSOCKET
+#define _XY0797_LOCALSOCKET 1
+
+#include <string>
+#include <string_view>
+#include "MessageReader.hpp"
+
+/*
+ *	各平台提供相同的接口：
+ *  class LocalConnection
+ *    bool readLine(std::string& line)：读取一行，连接关闭时返回false，只能在一个线程中调用
+ *    bool writeAll(std::string_view data)：写入全部数据，失败时返回false
+ *    读写可以在不同线程中同时进行，多个线程写入时由调用者保证互斥
+ *  class LocalServer
+ *    bool listen(const std::string& path, std::string& errMsg)：开始监听，失败时返回false
+ *    std::unique_ptr<LocalConnection> accept()：等待下一个连接，失败时返回空指针
+ *    析构时停止监听并清理监听的路径
+ *  路径在POSIX下为套接字文件的路径，在Windows下为管道名，不以\\.\pipe\开头时自动补上
+ *  连接不会被评测的程序继承
+ */
+#ifdef _WIN32
+#include "LocalSocketWin.hpp"
+#else
+#include "LocalSocketPosix.hpp"
+#endif
+
+#endif /* _XY0797_LOCALSOCKET */
@@ -0,0 +1,148 @@
+/**
+ * \file    	LocalSocketPosix.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		LocalSocket的POSIX实现，使用Unix域套接字
+ */
+#ifndef _XY0797_LOCALSOCKETPOSIX
+#define _XY0797_LOCALSOCKETPOSIX 1
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+class LocalConnection {
+private:
+	int m_fd;
+
+	// 已读取但还没有取走的数据
+	std::string m_buffer;
+
+public:
+	// 接管已连接的套接字
+	explicit LocalConnection(int fd) : m_fd(fd) {}
+
+	~LocalConnection() {
+		close(m_fd);
+	}
+
+	LocalConnection(const LocalConnection&) = delete;
+	LocalConnection& operator=(const LocalConnection&) = delete;
+
+	bool readLine(std::string& line) {
+		return readLineFrom(m_buffer, line, [this](char* buf, size_t cap) -> size_t {
+			while (true) {
+				ssize_t len = recv(m_fd, buf, cap, 0);
+				if (len < 0 && errno == EINTR) {
+					continue;
+				}
+				return len > 0 ? static_cast<size_t>(len) : 0;
+			}
+		});
+	}
+
+	bool writeAll(std::string_view data) {
+		while (!data.empty()) {
+			// 对方已断开时只返回EPIPE，不产生SIGPIPE
+			ssize_t len = send(m_fd, data.data(), data.size(), MSG_NOSIGNAL);
+			if (len < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+			data.remove_prefix(static_cast<size_t>(len));
+		}
+		return true;
+	}
+};
+
+class LocalServer {
+private:
+	int m_fd = -1;
+	std::string m_path;
+
+public:
+	LocalServer() = default;
+	LocalServer(const LocalServer&) = delete;
+	LocalServer& operator=(const LocalServer&) = delete;
+
+	~LocalServer() {
+		if (m_fd >= 0) {
+			close(m_fd);
+			unlink(m_path.c_str());
+		}
+	}
+
+	bool listen(const std::string& path, std::string& errMsg) {
+		sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+			errMsg = "套接字路径为空或过长：" + path;
+			return false;
+		}
+		memcpy(addr.sun_path, path.c_str(), path.size());
+		// 上一次异常退出时留下的套接字文件需要删除，其它文件不能删除
+		// 连接被拒绝才说明没有进程在监听，仍在使用的套接字不能删除
+		struct stat st;
+		if (lstat(path.c_str(), &st) == 0) {
+			if (!S_ISSOCK(st.st_mode)) {
+				errMsg = "路径已被其它文件占用：" + path;
+				return false;
+			}
+			int probeFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+			if (probeFd < 0) {
+				errMsg = std::string("无法创建套接字：") + strerror(errno);
+				return false;
+			}
+			int probeRet = connect(probeFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+			int probeErr = errno;
+			close(probeFd);
+			if (probeRet == 0) {
+				errMsg = "已有其它进程在监听" + path;
+				return false;
+			}
+			if (probeErr != ECONNREFUSED) {
+				errMsg = "无法确定" + path + "是否仍在使用：" + strerror(probeErr);
+				return false;
+			}
+			unlink(path.c_str());
+		}
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0) {
+			errMsg = std::string("无法创建套接字：") + strerror(errno);
+			return false;
+		}
+		if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+		        || ::listen(fd, 16) != 0) {
+			errMsg = "无法监听" + path + "：" + strerror(errno);
+			close(fd);
+			return false;
+		}
+		m_fd = fd;
+		m_path = path;
+		return true;
+	}
+
+	std::unique_ptr<LocalConnection> accept() {
+		while (true) {
+			int fd = accept4(m_fd, NULL, NULL, SOCK_CLOEXEC);
+			if (fd >= 0) {
+				return std::make_unique<LocalConnection>(fd);
+			}
+			// 对方在连接完成前断开时继续等待下一个连接
+			if (errno != EINTR && errno != ECONNABORTED) {
+				return nullptr;
+			}
+		}
+	}
+};
+
+#endif /* _XY0797_LOCALSOCKETPOSIX */
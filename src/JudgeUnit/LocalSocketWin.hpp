@@ -0,0 +1,156 @@
+/**
+ * \file    	LocalSocketWin.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		LocalSocket的Windows实现，使用命名管道
+ */
+#ifndef _XY0797_LOCALSOCKETWIN
+#define _XY0797_LOCALSOCKETWIN 1
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <algorithm>
+#include <windows.h>
+
+// 管道的缓冲区大小
+const DWORD LOCAL_PIPE_BUFFER_SIZE = 64 * 1024;
+
+// 同步句柄上的读写会相互等待，因此管道使用重叠I/O，每次操作都等待其完成
+// 读写各自使用一个事件，可以在不同线程中同时进行
+class LocalConnection {
+private:
+	HANDLE m_pipe;
+	HANDLE m_readEvent;
+	HANDLE m_writeEvent;
+
+	// 已读取但还没有取走的数据
+	std::string m_buffer;
+
+	// 等待一次重叠读写完成，传输的字节数写入len，失败返回false
+	bool waitIO(BOOL isDone, OVERLAPPED& overlapped, DWORD& len) {
+		if (!isDone && GetLastError() != ERROR_IO_PENDING) {
+			return false;
+		}
+		return GetOverlappedResult(m_pipe, &overlapped, &len, TRUE) != 0;
+	}
+
+public:
+	// 接管已连接的管道
+	explicit LocalConnection(HANDLE pipe)
+		: m_pipe(pipe),
+		  m_readEvent(CreateEventA(NULL, TRUE, FALSE, NULL)),
+		  m_writeEvent(CreateEventA(NULL, TRUE, FALSE, NULL)) {}
+
+	~LocalConnection() {
+		DisconnectNamedPipe(m_pipe);
+		CloseHandle(m_pipe);
+		CloseHandle(m_readEvent);
+		CloseHandle(m_writeEvent);
+	}
+
+	LocalConnection(const LocalConnection&) = delete;
+	LocalConnection& operator=(const LocalConnection&) = delete;
+
+	bool readLine(std::string& line) {
+		return readLineFrom(m_buffer, line, [this](char* buf, size_t cap) -> size_t {
+			OVERLAPPED overlapped;
+			ZeroMemory(&overlapped, sizeof(overlapped));
+			overlapped.hEvent = m_readEvent;
+			DWORD len = 0;
+			BOOL isDone = ReadFile(m_pipe, buf, static_cast<DWORD>(cap), &len, &overlapped);
+			return waitIO(isDone, overlapped, len) ? len : 0;
+		});
+	}
+
+	bool writeAll(std::string_view data) {
+		while (!data.empty()) {
+			OVERLAPPED overlapped;
+			ZeroMemory(&overlapped, sizeof(overlapped));
+			overlapped.hEvent = m_writeEvent;
+			DWORD len = 0;
+			DWORD toWrite = static_cast<DWORD>(std::min<size_t>(data.size(),
+			                                   LOCAL_PIPE_BUFFER_SIZE));
+			BOOL isDone = WriteFile(m_pipe, data.data(), toWrite, &len, &overlapped);
+			if (!waitIO(isDone, overlapped, len) || len == 0) {
+				return false;
+			}
+			data.remove_prefix(len);
+		}
+		return true;
+	}
+};
+
+class LocalServer {
+private:
+	std::string m_pipeName;
+
+	// 等待下一个连接的管道实例
+	HANDLE m_nextPipe = INVALID_HANDLE_VALUE;
+
+	// 创建一个管道实例，第一个实例要求管道名未被占用
+	HANDLE createPipe(bool isFirst) {
+		return CreateNamedPipeA(m_pipeName.c_str(),
+		                        PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED
+		                        | (isFirst ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+		                        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT
+		                        | PIPE_REJECT_REMOTE_CLIENTS,
+		                        PIPE_UNLIMITED_INSTANCES, LOCAL_PIPE_BUFFER_SIZE,
+		                        LOCAL_PIPE_BUFFER_SIZE, 0, NULL);
+	}
+
+public:
+	LocalServer() = default;
+	LocalServer(const LocalServer&) = delete;
+	LocalServer& operator=(const LocalServer&) = delete;
+
+	~LocalServer() {
+		if (m_nextPipe != INVALID_HANDLE_VALUE) {
+			CloseHandle(m_nextPipe);
+		}
+	}
+
+	bool listen(const std::string& path, std::string& errMsg) {
+		const std::string prefix = "\\\\.\\pipe\\";
+		m_pipeName = path.compare(0, prefix.size(), prefix) == 0 ? path : prefix + path;
+		m_nextPipe = createPipe(true);
+		if (m_nextPipe == INVALID_HANDLE_VALUE) {
+			errMsg = "无法创建命名管道" + m_pipeName + "，错误码："
+			         + std::to_string(GetLastError());
+			return false;
+		}
+		return true;
+	}
+
+	std::unique_ptr<LocalConnection> accept() {
+		if (m_nextPipe == INVALID_HANDLE_VALUE) {
+			m_nextPipe = createPipe(false);
+			if (m_nextPipe == INVALID_HANDLE_VALUE) {
+				return nullptr;
+			}
+		}
+		HANDLE hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+		OVERLAPPED overlapped;
+		ZeroMemory(&overlapped, sizeof(overlapped));
+		overlapped.hEvent = hEvent;
+		bool isConnected = ConnectNamedPipe(m_nextPipe, &overlapped) != 0;
+		if (!isConnected) {
+			DWORD err = GetLastError();
+			DWORD unusedLen;
+			// 对方在调用ConnectNamedPipe之前已经连上
+			isConnected = err == ERROR_PIPE_CONNECTED
+			              || (err == ERROR_IO_PENDING
+			                  && GetOverlappedResult(m_nextPipe, &overlapped, &unusedLen, TRUE));
+		}
+		CloseHandle(hEvent);
+		HANDLE pipe = m_nextPipe;
+		m_nextPipe = INVALID_HANDLE_VALUE;
+		if (!isConnected) {
+			CloseHandle(pipe);
+			return nullptr;
+		}
+		return std::make_unique<LocalConnection>(pipe);
+	}
+};
+
+#endif /* _XY0797_LOCALSOCKETWIN */
@@ -0,0 +1,120 @@
+/**
+ * \file    	MappedFile.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		以只读方式把整个文件映射到内存，支持Windows与POSIX(Linux)
+ */
+#ifndef _XY0797_MAPPEDFILE
+#define _XY0797_MAPPEDFILE 1
+
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// 只读的文件映射
+// 文件内容直接由页缓存提供，不复制到进程的堆上，同一文件被多次映射时共享物理页
+// 映射期间文件不得被修改或截断
+class MappedFile {
+private:
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+#ifdef _WIN32
+	HANDLE m_hMapping = NULL;
+#endif
+
+public:
+	/*
+	 *	映射整个文件，失败时抛出std::runtime_error，空文件得到空的映射
+	 */
+	explicit MappedFile(const std::string& filePath) {
+#ifdef _WIN32
+		HANDLE hFile = CreateFileA(filePath.c_str(), GENERIC_READ,
+		                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		                           NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("无法打开文件");
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(hFile, &fileSize)) {
+			CloseHandle(hFile);
+			throw std::runtime_error("无法获取文件大小");
+		}
+		m_size = static_cast<size_t>(fileSize.QuadPart);
+		// 空文件无法创建映射，也不需要映射
+		if (m_size > 0) {
+			m_hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (m_hMapping != NULL) {
+				m_data = static_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+			}
+		}
+		// 映射会保持文件打开，文件句柄可以立即关闭
+		CloseHandle(hFile);
+		if (m_size > 0 && m_data == nullptr) {
+			if (m_hMapping != NULL) {
+				CloseHandle(m_hMapping);
+			}
+			throw std::runtime_error("无法映射文件");
+		}
+#else
+		int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			throw std::runtime_error("无法打开文件");
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			close(fd);
+			throw std::runtime_error("无法获取文件大小");
+		}
+		m_size = static_cast<size_t>(st.st_size);
+		if (m_size > 0) {
+			void* addr = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (addr == MAP_FAILED) {
+				close(fd);
+				throw std::runtime_error("无法映射文件");
+			}
+			// 评测时总是从头到尾读取，提示内核加大预读
+			madvise(addr, m_size, MADV_SEQUENTIAL);
+			m_data = static_cast<const char*>(addr);
+		}
+		// 映射会保持文件打开，文件描述符可以立即关闭
+		close(fd);
+#endif
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile() {
+#ifdef _WIN32
+		if (m_data != nullptr) {
+			UnmapViewOfFile(m_data);
+		}
+		if (m_hMapping != NULL) {
+			CloseHandle(m_hMapping);
+		}
+#else
+		if (m_data != nullptr) {
+			munmap(const_cast<char*>(m_data), m_size);
+		}
+#endif
+	}
+
+	// 文件内容，生存期与本对象相同
+	std::string_view view() const {
+		return std::string_view(m_data, m_size);
+	}
+
+	size_t size() const {
+		return m_size;
+	}
+};
+
+#endif /* _XY0797_MAPPEDFILE */
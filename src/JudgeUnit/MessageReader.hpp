@@ -0,0 +1,70 @@
+/**
+ * \file    	MessageReader.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		从连接中按行或按长度读取消息，与平台及连接的种类无关
+ */
+#ifndef _XY0797_MESSAGEREADER
+#define _XY0797_MESSAGEREADER 1
+
+#include <string>
+#include <algorithm>
+
+// 一行消息的最大长度，超过时视为对方出错并断开连接
+const size_t MAX_MESSAGE_LINE = 1024 * 1024;
+
+// 从连接中按行读取
+// readSome(缓冲区, 容量)返回读到的字节数，连接关闭或出错时返回0
+// 取得的行去掉末尾的\r\n，连接关闭时不完整的最后一行同样返回
+// 连接已关闭且没有剩余数据，或一行过长时返回false
+template <class ReadSome>
+bool readLineFrom(std::string& buffer, std::string& line, ReadSome readSome) {
+	size_t searchPos = 0;
+	while (true) {
+		size_t i = buffer.find('\n', searchPos);
+		if (i != std::string::npos) {
+			line.assign(buffer, 0, i);
+			buffer.erase(0, i + 1);
+			break;
+		}
+		if (buffer.size() > MAX_MESSAGE_LINE) {
+			return false;
+		}
+		searchPos = buffer.size();
+		char chunk[4096];
+		size_t len = readSome(chunk, sizeof(chunk));
+		if (len == 0) {
+			if (buffer.empty()) {
+				return false;
+			}
+			line.swap(buffer);
+			buffer.clear();
+			break;
+		}
+		buffer.append(chunk, len);
+	}
+	if (!line.empty() && line.back() == '\r') {
+		line.pop_back();
+	}
+	return true;
+}
+
+// 从连接中读取恰好len字节，先取走buffer中已读取但还没有取走的数据
+// readSome的含义与readLineFrom相同，读满之前连接关闭或出错时返回false
+template <class ReadSome>
+bool readExactFrom(std::string& buffer, std::string& data, size_t len, ReadSome readSome) {
+	size_t pos = std::min(len, buffer.size());
+	data.assign(buffer, 0, pos);
+	buffer.erase(0, pos);
+	data.resize(len);
+	while (pos < len) {
+		size_t readLen = readSome(&data[pos], len - pos);
+		if (readLen == 0) {
+			return false;
+		}
+		pos += readLen;
+	}
+	return true;
+}
+
+#endif /* _XY0797_MESSAGEREADER */
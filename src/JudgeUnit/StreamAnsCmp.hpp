@@ -0,0 +1,333 @@
+/**
+ * \file    	StreamAnsCmp.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		在程序运行期间逐段比较程序输出与标准答案，确定WA后即可结束程序
+ */
+#ifndef _XY0797_STREAMANSCMP
+#define _XY0797_STREAMANSCMP 1
+
+#include <string>
+#include <string_view>
+#include "TestStringCmp.hpp"
+
+// 确定WA后，为了生成差异信息最多再读取的输出字节数
+const size_t STREAM_DRAIN_MAX = 64 * 1024;
+
+// 流式比较器
+// 判定规则与compareAnsStr(标准答案, 程序输出)一致：
+// 按行比较，\r\n与\r视为\n，忽略行末空格，末尾的单个换行不影响结果
+class StreamAnsCmp {
+private:
+	enum CmpState {
+		// 目前为止完全一致
+		CMP_SAME,
+		// 当前行已确定不一致，继续读取该行用于生成差异信息
+		CMP_DRAIN_LINE,
+		// 程序输出多出了行，继续读取用于统计行数
+		CMP_DRAIN_EXTRA,
+		// 已经得出结论
+		CMP_DONE
+	};
+
+	// 标准答案，必须已经统一换行符
+	std::string_view m_stdAns;
+
+	// 标准答案下一行的起始位置
+	size_t m_ansPos = 0;
+
+	// 标准答案当前行(已去尾空格)
+	size_t m_ansLineBegin = 0;
+	size_t m_ansLineLen = 0;
+	bool m_hasAnsLine = false;
+
+	// 标准答案已经取出的行数
+	long long m_ansLineCnt = 0;
+
+	// 程序输出已经结束的行数
+	long long m_testLineCnt = 0;
+
+	// 程序输出当前行已读取的字符数
+	// 一致期间当前行一定是标准答案当前行的前缀(之后可能跟着空格)，不需要保存内容
+	size_t m_curLen = 0;
+
+	// 当前行是否已经开始(读取到了字符)
+	bool m_isLineStarted = false;
+
+	// 上一段输出以\r结尾，下一段开头的\n属于同一个换行
+	bool m_isPendingCR = false;
+
+	// 确定不一致后保存的程序输出当前行
+	std::string m_curLine;
+
+	// 确定不一致后还允许读取的字节数
+	size_t m_drainLeft = 0;
+
+	// 多出的第一行是否已经读完
+	bool m_isExtraLineDone = false;
+
+	CmpState m_state = CMP_SAME;
+
+	// 差异信息
+	std::string m_diffMsg;
+
+	// 取出标准答案的下一行
+	void nextAnsLine() {
+		m_hasAnsLine = m_ansPos < m_stdAns.size();
+		if (!m_hasAnsLine) {
+			return;
+		}
+		size_t endPos = m_stdAns.find('\n', m_ansPos);
+		if (endPos == std::string::npos) {
+			endPos = m_stdAns.size();
+		}
+		m_ansLineBegin = m_ansPos;
+		m_ansLineLen = endPos - m_ansPos;
+		while (m_ansLineLen > 0 && m_stdAns[m_ansLineBegin + m_ansLineLen - 1] == ' ') {
+			--m_ansLineLen;
+		}
+		m_ansPos = endPos < m_stdAns.size() ? endPos + 1 : endPos;
+		++m_ansLineCnt;
+	}
+
+	// 标准答案剩余的行数
+	long long countRemainAnsLine() const {
+		long long cnt = 0;
+		size_t pos = m_ansPos;
+		while (pos < m_stdAns.size()) {
+			size_t endPos = m_stdAns.find('\n', pos);
+			++cnt;
+			if (endPos == std::string::npos) {
+				break;
+			}
+			pos = endPos + 1;
+		}
+		return cnt;
+	}
+
+	// 由一致的部分还原程序输出当前行
+	void rebuildCurLine() {
+		size_t sameLen = std::min(m_curLen, m_ansLineLen);
+		m_curLine.assign(m_stdAns, m_ansLineBegin, sameLen);
+		m_curLine.append(m_curLen - sameLen, ' ');
+	}
+
+	// 开始读取多出的行
+	void startDrainExtra() {
+		m_state = CMP_DRAIN_EXTRA;
+		m_drainLeft = STREAM_DRAIN_MAX;
+		m_curLine.clear();
+	}
+
+	// 当前行不一致，生成差异信息
+	void finishDrainLine() {
+		std::string standardLine(m_stdAns.substr(m_ansLineBegin, m_ansLineLen));
+		trim(m_curLine);
+		testStringCmp(standardLine, m_curLine, m_diffMsg);
+		m_diffMsg = "第一处差异在第" + std::to_string(m_testLineCnt + 1)
+		            + "行\n" + m_diffMsg;
+		m_state = CMP_DONE;
+	}
+
+	// 多出了行，生成差异信息
+	void finishDrainExtra(bool isLowerBound) {
+		long long testLineCnt = m_testLineCnt;
+		if (!m_isExtraLineDone || m_isLineStarted) {
+			// 未结束的最后一行也算一行
+			++testLineCnt;
+		}
+		genExtraLineMsg(m_curLine, m_ansLineCnt + 1, m_ansLineCnt,
+		                testLineCnt, m_diffMsg, isLowerBound);
+		m_state = CMP_DONE;
+	}
+
+	// 处理当前行中的一段字符
+	void onLineData(const char* data, size_t len) {
+		m_isLineStarted = true;
+		switch (m_state) {
+			case CMP_SAME: {
+				if (!m_hasAnsLine) {
+					// 标准答案已经没有行了
+					startDrainExtra();
+					onLineData(data, len);
+					return;
+				}
+				// 标准答案当前行剩余的部分整段比较，超出的部分只能是空格
+				size_t cmpLen = m_curLen < m_ansLineLen
+				                ? std::min(len, m_ansLineLen - m_curLen) : 0;
+				const char* ansLine = m_stdAns.data() + m_ansLineBegin + m_curLen;
+				size_t i = getCommonPrefixLen(data, cmpLen, ansLine, cmpLen);
+				if (i == cmpLen) {
+					while (i < len && data[i] == ' ') {
+						++i;
+					}
+				}
+				if (i < len) {
+					// 确定不一致
+					m_curLen += i;
+					rebuildCurLine();
+					m_curLen = 0;
+					m_state = CMP_DRAIN_LINE;
+					m_drainLeft = STREAM_DRAIN_MAX;
+					onLineData(data + i, len - i);
+					return;
+				}
+				m_curLen += len;
+				break;
+			}
+			case CMP_DRAIN_LINE:
+			case CMP_DRAIN_EXTRA: {
+				size_t useLen = std::min(len, m_drainLeft);
+				if (!m_isExtraLineDone) {
+					m_curLine.append(data, useLen);
+				}
+				m_drainLeft -= useLen;
+				if (m_drainLeft == 0) {
+					// 不再继续读取
+					if (m_state == CMP_DRAIN_LINE) {
+						finishDrainLine();
+					} else {
+						finishDrainExtra(true);
+					}
+				}
+				break;
+			}
+			case CMP_DONE:
+				break;
+		}
+	}
+
+	// 处理一个换行
+	void onLineEnd() {
+		switch (m_state) {
+			case CMP_SAME:
+				if (!m_hasAnsLine) {
+					// 多出一个空行
+					startDrainExtra();
+					onLineEnd();
+					return;
+				}
+				if (m_curLen < m_ansLineLen) {
+					// 程序输出的这一行比标准答案短
+					rebuildCurLine();
+					finishDrainLine();
+					return;
+				}
+				++m_testLineCnt;
+				m_curLen = 0;
+				m_isLineStarted = false;
+				nextAnsLine();
+				break;
+			case CMP_DRAIN_LINE:
+				finishDrainLine();
+				break;
+			case CMP_DRAIN_EXTRA:
+				++m_testLineCnt;
+				m_isExtraLineDone = true;
+				m_isLineStarted = false;
+				if (m_drainLeft > 0) {
+					--m_drainLeft;
+				}
+				if (m_drainLeft == 0) {
+					finishDrainExtra(true);
+				}
+				break;
+			case CMP_DONE:
+				break;
+		}
+	}
+
+public:
+	/*
+	 *	构造时传入：标准答案(必须已经统一换行符，比较期间不得析构)
+	 */
+	explicit StreamAnsCmp(std::string_view stdAns) : m_stdAns(stdAns) {
+		nextAnsLine();
+	}
+
+	/*
+	 *	输入程序输出的下一段，可以是任意长度，可以在任意位置断开
+	 *  返回false表示已经确定WA，不再需要后续的输出
+	 */
+	bool feed(const char* data, size_t len) {
+		size_t i = 0;
+		if (m_isPendingCR && len > 0) {
+			m_isPendingCR = false;
+			if (data[0] == '\n') {
+				i = 1;
+			}
+		}
+		while (i < len && m_state != CMP_DONE) {
+			// 找到下一个换行符
+			size_t j = findLineEnd(data + i, data + len) - data;
+			if (j > i) {
+				onLineData(data + i, j - i);
+			}
+			if (j == len) {
+				break;
+			}
+			if (data[j] == '\r') {
+				if (j + 1 == len) {
+					m_isPendingCR = true;
+				} else if (data[j + 1] == '\n') {
+					++j;
+				}
+			}
+			onLineEnd();
+			i = j + 1;
+		}
+		return m_state != CMP_DONE;
+	}
+
+	/*
+	 *	程序输出全部输入后调用，返回是否一致
+	 *  不一致时差异以人类可读形式写在diffMsg里面
+	 */
+	bool finish(std::string& diffMsg) {
+		switch (m_state) {
+			case CMP_SAME:
+				if (m_isLineStarted) {
+					// 没有换行的最后一行
+					onLineEnd();
+					if (m_state != CMP_SAME) {
+						return finish(diffMsg);
+					}
+				}
+				if (m_hasAnsLine) {
+					// 程序输出缺失了行
+					std::string standardLine(m_stdAns.substr(m_ansLineBegin,
+					                         m_ansPos - m_ansLineBegin));
+					if (!standardLine.empty() && standardLine.back() == '\n') {
+						standardLine.pop_back();
+					}
+					long long ansLineCnt = m_ansLineCnt + countRemainAnsLine();
+					genLackLineMsg(standardLine, m_testLineCnt + 1, ansLineCnt,
+					               m_testLineCnt, diffMsg);
+					return false;
+				}
+				return true;
+			case CMP_DRAIN_LINE:
+				finishDrainLine();
+				break;
+			case CMP_DRAIN_EXTRA:
+				finishDrainExtra(false);
+				break;
+			case CMP_DONE:
+				break;
+		}
+		diffMsg = m_diffMsg;
+		return false;
+	}
+
+	// 是否已经确定WA
+	bool isWA() const {
+		return m_state == CMP_DONE;
+	}
+
+	// 获取已经确定的差异信息
+	const std::string& getDiffMsg() const {
+		return m_diffMsg;
+	}
+};
+
+#endif /* _XY0797_STREAMANSCMP */
@@ -0,0 +1,68 @@
+/**
+ * \file    	TcpSocket.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		跨主机的TCP连接，用于分布式评测，支持Windows与POSIX(Linux)
+ */
+#ifndef _XY0797_TCPSOCKET
+#define _XY0797_TCPSOCKET 1
+
+#include <string>
+#include <string_view>
+#include <cctype>
+#include "MessageReader.hpp"
+
+// 只写端口时使用的主机，只接受本机的连接
+const char* const TCP_DEFAULT_HOST = "127.0.0.1";
+
+/*
+ *	把"主机:端口"拆分为主机与端口，IPv6地址写为"[地址]:端口"
+ *  只写端口时主机为TCP_DEFAULT_HOST，端口不是1~65535的整数时返回false
+ */
+bool splitTcpAddress(const std::string& addr, std::string& host, std::string& port) {
+	size_t colonPos = addr.rfind(':');
+	if (colonPos == std::string::npos) {
+		host = TCP_DEFAULT_HOST;
+		port = addr;
+	} else {
+		host = addr.substr(0, colonPos);
+		port = addr.substr(colonPos + 1);
+		if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+			host = host.substr(1, host.size() - 2);
+		}
+	}
+	if (host.empty() || port.empty() || port.size() > 5) {
+		return false;
+	}
+	for (char ch : port) {
+		if (!isdigit(static_cast<unsigned char>(ch))) {
+			return false;
+		}
+	}
+	int portNum = std::stoi(port);
+	return portNum >= 1 && portNum <= 65535;
+}
+
+/*
+ *	各平台提供相同的接口：
+ *  class TcpConnection
+ *    bool readLine(std::string& line)：读取一行，连接关闭时返回false，只能在一个线程中调用
+ *    bool readExact(std::string& data, size_t len)：读取恰好len字节，与readLine在同一线程中调用
+ *    bool writeAll(std::string_view data)：写入全部数据，失败时返回false
+ *    void setTimeout(long long ms)：设置读写的超时，超过该时间没有进展的读写失败
+ *    void shutdown()：使其它线程中阻塞的读写尽快失败，之后连接不能再使用
+ *    读写可以在不同线程中同时进行，多个线程写入时由调用者保证互斥
+ *  class TcpServer
+ *    bool listen(const std::string& addr, std::string& errMsg)：开始监听，失败时返回false
+ *    std::unique_ptr<TcpConnection> accept()：等待下一个连接，失败时返回空指针
+ *  std::unique_ptr<TcpConnection> connectTcp(addr, timeoutMs, errMsg)
+ *    在timeoutMs内连接addr，失败时返回空指针并把原因写在errMsg里面
+ *  地址的格式见splitTcpAddress，连接不会被评测的程序继承
+ */
+#ifdef _WIN32
+#include "TcpSocketWin.hpp"
+#else
+#include "TcpSocketPosix.hpp"
+#endif
+
+#endif /* _XY0797_TCPSOCKET */
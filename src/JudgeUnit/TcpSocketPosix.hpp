@@ -0,0 +1,216 @@
+/**
+ * \file    	TcpSocketPosix.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		TcpSocket的POSIX实现
+ */
+#ifndef _XY0797_TCPSOCKETPOSIX
+#define _XY0797_TCPSOCKETPOSIX 1
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+class TcpConnection {
+private:
+	int m_fd;
+
+	// 已读取但还没有取走的数据
+	std::string m_buffer;
+
+	size_t readSome(char* buf, size_t cap) {
+		while (true) {
+			ssize_t len = recv(m_fd, buf, cap, 0);
+			if (len < 0 && errno == EINTR) {
+				continue;
+			}
+			return len > 0 ? static_cast<size_t>(len) : 0;
+		}
+	}
+
+public:
+	// 接管已连接的套接字
+	explicit TcpConnection(int fd) : m_fd(fd) {
+		// 消息都很短且需要立即送达，不等待合并
+		int isNoDelay = 1;
+		setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &isNoDelay, sizeof(isNoDelay));
+	}
+
+	~TcpConnection() {
+		close(m_fd);
+	}
+
+	TcpConnection(const TcpConnection&) = delete;
+	TcpConnection& operator=(const TcpConnection&) = delete;
+
+	bool readLine(std::string& line) {
+		return readLineFrom(m_buffer, line, [this](char* buf, size_t cap) {
+			return readSome(buf, cap);
+		});
+	}
+
+	bool readExact(std::string& data, size_t len) {
+		return readExactFrom(m_buffer, data, len, [this](char* buf, size_t cap) {
+			return readSome(buf, cap);
+		});
+	}
+
+	bool writeAll(std::string_view data) {
+		while (!data.empty()) {
+			// 对方已断开时只返回EPIPE，不产生SIGPIPE
+			ssize_t len = send(m_fd, data.data(), data.size(), MSG_NOSIGNAL);
+			if (len < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return false;
+			}
+			data.remove_prefix(static_cast<size_t>(len));
+		}
+		return true;
+	}
+
+	void setTimeout(long long ms) {
+		timeval tv;
+		tv.tv_sec = static_cast<time_t>(ms / 1000);
+		tv.tv_usec = static_cast<suseconds_t>(ms % 1000 * 1000);
+		setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		setsockopt(m_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+	}
+
+	void shutdown() {
+		::shutdown(m_fd, SHUT_RDWR);
+	}
+};
+
+// 解析地址，失败时返回空指针并写入错误原因，结果需要用freeaddrinfo释放
+addrinfo* resolveTcpAddress(const std::string& addr, bool isPassive, std::string& errMsg) {
+	std::string host, port;
+	if (!splitTcpAddress(addr, host, port)) {
+		errMsg = "地址格式有误：" + addr;
+		return nullptr;
+	}
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = isPassive ? AI_PASSIVE : 0;
+	addrinfo* result = nullptr;
+	int err = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+	if (err != 0) {
+		errMsg = "无法解析地址" + addr + "：" + gai_strerror(err);
+		return nullptr;
+	}
+	return result;
+}
+
+class TcpServer {
+private:
+	int m_fd = -1;
+
+public:
+	TcpServer() = default;
+	TcpServer(const TcpServer&) = delete;
+	TcpServer& operator=(const TcpServer&) = delete;
+
+	~TcpServer() {
+		if (m_fd >= 0) {
+			close(m_fd);
+		}
+	}
+
+	bool listen(const std::string& addr, std::string& errMsg) {
+		addrinfo* addrList = resolveTcpAddress(addr, true, errMsg);
+		if (addrList == nullptr) {
+			return false;
+		}
+		int fd = socket(addrList->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0) {
+			errMsg = std::string("无法创建套接字：") + strerror(errno);
+			freeaddrinfo(addrList);
+			return false;
+		}
+		// 重启后可以立即监听同一端口，不必等待上一次的连接超时
+		int isReuse = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &isReuse, sizeof(isReuse));
+		bool isOK = bind(fd, addrList->ai_addr, addrList->ai_addrlen) == 0
+		            && ::listen(fd, 16) == 0;
+		freeaddrinfo(addrList);
+		if (!isOK) {
+			errMsg = "无法监听" + addr + "：" + strerror(errno);
+			close(fd);
+			return false;
+		}
+		m_fd = fd;
+		return true;
+	}
+
+	std::unique_ptr<TcpConnection> accept() {
+		while (true) {
+			int fd = accept4(m_fd, NULL, NULL, SOCK_CLOEXEC);
+			if (fd >= 0) {
+				return std::make_unique<TcpConnection>(fd);
+			}
+			// 对方在连接完成前断开时继续等待下一个连接
+			if (errno != EINTR && errno != ECONNABORTED) {
+				return nullptr;
+			}
+		}
+	}
+};
+
+std::unique_ptr<TcpConnection> connectTcp(const std::string& addr, long long timeoutMs,
+        std::string& errMsg) {
+	addrinfo* addrList = resolveTcpAddress(addr, false, errMsg);
+	if (addrList == nullptr) {
+		return nullptr;
+	}
+	int fd = -1;
+	int err = 0;
+	for (addrinfo* p = addrList; p != nullptr && fd < 0; p = p->ai_next) {
+		// 非阻塞地连接，才能限制等待的时间
+		fd = socket(p->ai_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+		if (fd < 0) {
+			err = errno;
+			continue;
+		}
+		if (connect(fd, p->ai_addr, p->ai_addrlen) != 0) {
+			err = errno;
+			if (err == EINPROGRESS) {
+				pollfd pfd;
+				pfd.fd = fd;
+				pfd.events = POLLOUT;
+				int ready = poll(&pfd, 1, static_cast<int>(timeoutMs));
+				socklen_t errLen = sizeof(err);
+				if (ready == 0) {
+					err = ETIMEDOUT;
+				} else if (ready < 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) != 0) {
+					err = errno;
+				}
+			}
+			if (err != 0) {
+				close(fd);
+				fd = -1;
+			}
+		}
+	}
+	freeaddrinfo(addrList);
+	if (fd < 0) {
+		errMsg = "无法连接" + addr + "：" + strerror(err);
+		return nullptr;
+	}
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+	return std::make_unique<TcpConnection>(fd);
+}
+
+#endif /* _XY0797_TCPSOCKETPOSIX */
@@ -0,0 +1,230 @@
+/**
+ * \file    	TcpSocketWin.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		TcpSocket的Windows实现，使用Winsock2，MinGW编译时需要加上-lws2_32
+ */
+#ifndef _XY0797_TCPSOCKETWIN
+#define _XY0797_TCPSOCKETWIN 1
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <algorithm>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+
+// 初始化Winsock，只在第一次调用时进行，失败返回false
+bool initWinsock() {
+	static bool isOK = [] {
+		WSADATA data;
+		return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}();
+	return isOK;
+}
+
+// 套接字默认可被继承，需要关闭继承，否则评测的程序会持有连接
+void disableSocketInherit(SOCKET sock) {
+	SetHandleInformation(reinterpret_cast<HANDLE>(sock), HANDLE_FLAG_INHERIT, 0);
+}
+
+class TcpConnection {
+private:
+	SOCKET m_sock;
+
+	// 已读取但还没有取走的数据
+	std::string m_buffer;
+
+	size_t readSome(char* buf, size_t cap) {
+		int len = recv(m_sock, buf, static_cast<int>(std::min<size_t>(cap, 1 << 30)), 0);
+		return len > 0 ? static_cast<size_t>(len) : 0;
+	}
+
+public:
+	// 接管已连接的套接字
+	explicit TcpConnection(SOCKET sock) : m_sock(sock) {
+		// 消息都很短且需要立即送达，不等待合并
+		BOOL isNoDelay = TRUE;
+		setsockopt(m_sock, IPPROTO_TCP, TCP_NODELAY,
+		           reinterpret_cast<const char*>(&isNoDelay), sizeof(isNoDelay));
+	}
+
+	~TcpConnection() {
+		closesocket(m_sock);
+	}
+
+	TcpConnection(const TcpConnection&) = delete;
+	TcpConnection& operator=(const TcpConnection&) = delete;
+
+	bool readLine(std::string& line) {
+		return readLineFrom(m_buffer, line, [this](char* buf, size_t cap) {
+			return readSome(buf, cap);
+		});
+	}
+
+	bool readExact(std::string& data, size_t len) {
+		return readExactFrom(m_buffer, data, len, [this](char* buf, size_t cap) {
+			return readSome(buf, cap);
+		});
+	}
+
+	bool writeAll(std::string_view data) {
+		while (!data.empty()) {
+			int len = send(m_sock, data.data(),
+			               static_cast<int>(std::min<size_t>(data.size(), 1 << 30)), 0);
+			if (len <= 0) {
+				return false;
+			}
+			data.remove_prefix(static_cast<size_t>(len));
+		}
+		return true;
+	}
+
+	void setTimeout(long long ms) {
+		DWORD timeout = static_cast<DWORD>(ms);
+		setsockopt(m_sock, SOL_SOCKET, SO_RCVTIMEO,
+		           reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+		setsockopt(m_sock, SOL_SOCKET, SO_SNDTIMEO,
+		           reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+	}
+
+	void shutdown() {
+		::shutdown(m_sock, SD_BOTH);
+	}
+};
+
+// 解析地址，失败时返回空指针并写入错误原因，结果需要用freeaddrinfo释放
+addrinfo* resolveTcpAddress(const std::string& addr, bool isPassive, std::string& errMsg) {
+	if (!initWinsock()) {
+		errMsg = "无法初始化Winsock";
+		return nullptr;
+	}
+	std::string host, port;
+	if (!splitTcpAddress(addr, host, port)) {
+		errMsg = "地址格式有误：" + addr;
+		return nullptr;
+	}
+	addrinfo hints;
+	ZeroMemory(&hints, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	hints.ai_flags = isPassive ? AI_PASSIVE : 0;
+	addrinfo* result = nullptr;
+	int err = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+	if (err != 0) {
+		errMsg = "无法解析地址" + addr + "，错误码：" + std::to_string(err);
+		return nullptr;
+	}
+	return result;
+}
+
+class TcpServer {
+private:
+	SOCKET m_sock = INVALID_SOCKET;
+
+public:
+	TcpServer() = default;
+	TcpServer(const TcpServer&) = delete;
+	TcpServer& operator=(const TcpServer&) = delete;
+
+	~TcpServer() {
+		if (m_sock != INVALID_SOCKET) {
+			closesocket(m_sock);
+		}
+	}
+
+	bool listen(const std::string& addr, std::string& errMsg) {
+		addrinfo* addrList = resolveTcpAddress(addr, true, errMsg);
+		if (addrList == nullptr) {
+			return false;
+		}
+		SOCKET sock = socket(addrList->ai_family, SOCK_STREAM, IPPROTO_TCP);
+		if (sock == INVALID_SOCKET) {
+			errMsg = "无法创建套接字，错误码：" + std::to_string(WSAGetLastError());
+			freeaddrinfo(addrList);
+			return false;
+		}
+		disableSocketInherit(sock);
+		bool isOK = bind(sock, addrList->ai_addr, static_cast<int>(addrList->ai_addrlen)) == 0
+		            && ::listen(sock, 16) == 0;
+		freeaddrinfo(addrList);
+		if (!isOK) {
+			errMsg = "无法监听" + addr + "，错误码：" + std::to_string(WSAGetLastError());
+			closesocket(sock);
+			return false;
+		}
+		m_sock = sock;
+		return true;
+	}
+
+	std::unique_ptr<TcpConnection> accept() {
+		SOCKET sock = ::accept(m_sock, NULL, NULL);
+		if (sock == INVALID_SOCKET) {
+			return nullptr;
+		}
+		disableSocketInherit(sock);
+		return std::make_unique<TcpConnection>(sock);
+	}
+};
+
+std::unique_ptr<TcpConnection> connectTcp(const std::string& addr, long long timeoutMs,
+        std::string& errMsg) {
+	addrinfo* addrList = resolveTcpAddress(addr, false, errMsg);
+	if (addrList == nullptr) {
+		return nullptr;
+	}
+	SOCKET sock = INVALID_SOCKET;
+	int err = 0;
+	for (addrinfo* p = addrList; p != nullptr && sock == INVALID_SOCKET; p = p->ai_next) {
+		sock = socket(p->ai_family, SOCK_STREAM, IPPROTO_TCP);
+		if (sock == INVALID_SOCKET) {
+			err = WSAGetLastError();
+			continue;
+		}
+		disableSocketInherit(sock);
+		// 非阻塞地连接，才能限制等待的时间
+		u_long isNonBlock = 1;
+		ioctlsocket(sock, FIONBIO, &isNonBlock);
+		if (connect(sock, p->ai_addr, static_cast<int>(p->ai_addrlen)) != 0) {
+			err = WSAGetLastError();
+			if (err == WSAEWOULDBLOCK) {
+				fd_set writeSet, errSet;
+				FD_ZERO(&writeSet);
+				FD_ZERO(&errSet);
+				FD_SET(sock, &writeSet);
+				FD_SET(sock, &errSet);
+				timeval tv;
+				tv.tv_sec = static_cast<long>(timeoutMs / 1000);
+				tv.tv_usec = static_cast<long>(timeoutMs % 1000 * 1000);
+				int ready = select(0, NULL, &writeSet, &errSet, &tv);
+				int errLen = sizeof(err);
+				if (ready == 0) {
+					err = WSAETIMEDOUT;
+				} else if (ready < 0 || getsockopt(sock, SOL_SOCKET, SO_ERROR,
+				                                   reinterpret_cast<char*>(&err), &errLen) != 0) {
+					err = WSAGetLastError();
+				}
+			}
+			if (err != 0) {
+				closesocket(sock);
+				sock = INVALID_SOCKET;
+			}
+		}
+	}
+	freeaddrinfo(addrList);
+	if (sock == INVALID_SOCKET) {
+		errMsg = "无法连接" + addr + "，错误码：" + std::to_string(err);
+		return nullptr;
+	}
+	u_long isNonBlock = 0;
+	ioctlsocket(sock, FIONBIO, &isNonBlock);
+	return std::make_unique<TcpConnection>(sock);
+}
+
+#endif /* _XY0797_TCPSOCKETWIN */
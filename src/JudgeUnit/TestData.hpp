@@ -0,0 +1,907 @@
+/**
+ * \file    	TestData.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		读取测试数据，支持普通文件、.gz文件与.zip压缩包中的文件，压缩的数据边读取边解压
+ */
+#ifndef _XY0797_TESTDATA
+#define _XY0797_TESTDATA 1
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cctype>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "../WindowsFileSysTool.hpp"
+#include "MappedFile.hpp"
+
+// DEFLATE(RFC 1951)解码器
+// 压缩数据整段位于内存中(通常是文件映射)，解压结果按调用者的缓冲区分段取出
+// 只保留32KB的历史窗口，解压结果不需要整个放在内存中
+class Inflater {
+private:
+	// 码长不超过该值的码直接查表解码
+	static const int FAST_BITS = 10;
+	static const int MAX_BITS = 15;
+	static const size_t WINDOW_SIZE = 32768;
+
+	// 范式Huffman码表
+	struct HuffmanTable {
+		// 以接下来FAST_BITS位为下标，低4位为码长，其余为符号，码长为0表示需要逐位解码
+		uint16_t fast[1 << FAST_BITS];
+		// 各码长的码数与按码排列的符号，用于逐位解码
+		uint16_t count[MAX_BITS + 1];
+		uint16_t symbol[288];
+
+		// 由各符号的码长构造码表，码长有误时返回false
+		bool build(const uint8_t* lengths, int symbolCnt) {
+			memset(count, 0, sizeof(count));
+			for (int i = 0; i < symbolCnt; ++i) {
+				++count[lengths[i]];
+			}
+			// 码数超出该码长能容纳的数量则无法构成前缀码
+			int left = 1;
+			for (int len = 1; len <= MAX_BITS; ++len) {
+				left = (left << 1) - count[len];
+				if (left < 0) {
+					return false;
+				}
+			}
+			uint16_t offset[MAX_BITS + 2];
+			uint16_t nextCode[MAX_BITS + 1];
+			offset[1] = 0;
+			nextCode[0] = 0;
+			int code = 0;
+			for (int len = 1; len <= MAX_BITS; ++len) {
+				offset[len + 1] = offset[len] + count[len];
+				code = (code + (len > 1 ? count[len - 1] : 0)) << 1;
+				nextCode[len] = static_cast<uint16_t>(code);
+			}
+			memset(fast, 0, sizeof(fast));
+			for (int i = 0; i < symbolCnt; ++i) {
+				int len = lengths[i];
+				if (len == 0) {
+					continue;
+				}
+				symbol[offset[len]++] = static_cast<uint16_t>(i);
+				int curCode = nextCode[len]++;
+				if (len > FAST_BITS) {
+					continue;
+				}
+				// 码在数据流中从高位开始存放，查表的下标需要反转
+				int reversed = 0;
+				for (int k = 0; k < len; ++k) {
+					reversed |= ((curCode >> k) & 1) << (len - 1 - k);
+				}
+				for (int k = reversed; k < (1 << FAST_BITS); k += 1 << len) {
+					fast[k] = static_cast<uint16_t>((i << 4) | len);
+				}
+			}
+			return true;
+		}
+	};
+
+	enum State {
+		// 读取块头
+		STATE_HEADER,
+		// 正在复制不压缩的块
+		STATE_STORED,
+		// 正在解码压缩的块
+		STATE_HUFFMAN,
+		// 最后一块已经结束
+		STATE_DONE
+	};
+
+	const unsigned char* m_in = nullptr;
+	const unsigned char* m_inEnd = nullptr;
+
+	// 已读入但未使用的位，低位在前
+	uint64_t m_bitBuf = 0;
+	int m_bitCnt = 0;
+
+	State m_state = STATE_HEADER;
+	bool m_isFinalBlock = false;
+
+	// 不压缩的块中剩余的字节数
+	size_t m_storedRemain = 0;
+
+	// 尚未复制完的重复串
+	size_t m_copyLen = 0;
+	size_t m_copyDist = 0;
+
+	// 历史窗口与已输出的总字节数
+	std::vector<unsigned char> m_window;
+	uint64_t m_outTotal = 0;
+
+	HuffmanTable m_litLenTable;
+	HuffmanTable m_distTable;
+
+	static void fail(const char* msg) {
+		throw std::runtime_error(std::string("压缩数据有误：") + msg);
+	}
+
+	void refill() {
+		while (m_bitCnt <= 56 && m_in < m_inEnd) {
+			m_bitBuf |= static_cast<uint64_t>(*m_in++) << m_bitCnt;
+			m_bitCnt += 8;
+		}
+	}
+
+	uint32_t getBits(int n) {
+		if (n == 0) {
+			return 0;
+		}
+		if (m_bitCnt < n) {
+			refill();
+			if (m_bitCnt < n) {
+				fail("数据不完整");
+			}
+		}
+		uint32_t val = static_cast<uint32_t>(m_bitBuf & ((1ull << n) - 1));
+		m_bitBuf >>= n;
+		m_bitCnt -= n;
+		return val;
+	}
+
+	int decodeSymbol(const HuffmanTable& table) {
+		if (m_bitCnt < MAX_BITS) {
+			refill();
+		}
+		// 数据末尾不足的位按0查表，实际码长超出剩余位数时才是错误
+		uint16_t entry = table.fast[m_bitBuf & ((1u << FAST_BITS) - 1)];
+		int len = entry & 15;
+		if (len > 0) {
+			if (len > m_bitCnt) {
+				fail("数据不完整");
+			}
+			m_bitBuf >>= len;
+			m_bitCnt -= len;
+			return entry >> 4;
+		}
+		// 长码逐位解码
+		int code = 0, first = 0, index = 0;
+		for (len = 1; len <= MAX_BITS; ++len) {
+			code |= static_cast<int>(getBits(1));
+			int cnt = table.count[len];
+			if (code - cnt < first) {
+				return table.symbol[index + (code - first)];
+			}
+			index += cnt;
+			first = (first + cnt) << 1;
+			code <<= 1;
+		}
+		fail("无效的Huffman码");
+		return -1;
+	}
+
+	void putByte(char* out, unsigned char ch) {
+		*out = static_cast<char>(ch);
+		m_window[m_outTotal & (WINDOW_SIZE - 1)] = ch;
+		++m_outTotal;
+	}
+
+	static const HuffmanTable& getFixedTable(bool isDist) {
+		static HuffmanTable litLenTable, distTable;
+		static std::once_flag flag;
+		std::call_once(flag, []() {
+			uint8_t lengths[288];
+			memset(lengths, 8, 144);
+			memset(lengths + 144, 9, 112);
+			memset(lengths + 256, 7, 24);
+			memset(lengths + 280, 8, 8);
+			litLenTable.build(lengths, 288);
+			memset(lengths, 5, 30);
+			distTable.build(lengths, 30);
+		});
+		return isDist ? distTable : litLenTable;
+	}
+
+	void readDynamicTables() {
+		static const uint8_t ORDER[19] = {
+			16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+		};
+		int litLenCnt = static_cast<int>(getBits(5)) + 257;
+		int distCnt = static_cast<int>(getBits(5)) + 1;
+		int codeLenCnt = static_cast<int>(getBits(4)) + 4;
+		if (litLenCnt > 286 || distCnt > 30) {
+			fail("码表过大");
+		}
+		uint8_t lengths[320] = {};
+		for (int i = 0; i < codeLenCnt; ++i) {
+			lengths[ORDER[i]] = static_cast<uint8_t>(getBits(3));
+		}
+		HuffmanTable codeLenTable;
+		if (!codeLenTable.build(lengths, 19)) {
+			fail("无效的码长码表");
+		}
+		memset(lengths, 0, sizeof(lengths));
+		int n = 0;
+		while (n < litLenCnt + distCnt) {
+			int sym = decodeSymbol(codeLenTable);
+			if (sym < 16) {
+				lengths[n++] = static_cast<uint8_t>(sym);
+				continue;
+			}
+			uint8_t val = 0;
+			int repeat;
+			if (sym == 16) {
+				if (n == 0) {
+					fail("无效的重复码长");
+				}
+				val = lengths[n - 1];
+				repeat = 3 + static_cast<int>(getBits(2));
+			} else if (sym == 17) {
+				repeat = 3 + static_cast<int>(getBits(3));
+			} else {
+				repeat = 11 + static_cast<int>(getBits(7));
+			}
+			if (n + repeat > litLenCnt + distCnt) {
+				fail("码长过多");
+			}
+			while (repeat-- > 0) {
+				lengths[n++] = val;
+			}
+		}
+		if (lengths[256] == 0) {
+			fail("缺少块结束符");
+		}
+		if (!m_litLenTable.build(lengths, litLenCnt)
+		        || !m_distTable.build(lengths + litLenCnt, distCnt)) {
+			fail("无效的码表");
+		}
+	}
+
+	// 读取块头，设置对应的状态
+	void readBlockHeader() {
+		m_isFinalBlock = getBits(1) != 0;
+		uint32_t type = getBits(2);
+		if (type == 0) {
+			// 丢弃到字节边界，缓冲的整字节退回输入中，块内容直接从输入复制
+			getBits(m_bitCnt & 7);
+			uint32_t len = getBits(16);
+			uint32_t nlen = getBits(16);
+			if ((len ^ 0xFFFF) != nlen) {
+				fail("不压缩的块长度有误");
+			}
+			m_in -= m_bitCnt / 8;
+			m_bitBuf = 0;
+			m_bitCnt = 0;
+			m_storedRemain = len;
+			m_state = STATE_STORED;
+		} else if (type == 1) {
+			m_litLenTable = getFixedTable(false);
+			m_distTable = getFixedTable(true);
+			m_state = STATE_HUFFMAN;
+		} else if (type == 2) {
+			readDynamicTables();
+			m_state = STATE_HUFFMAN;
+		} else {
+			fail("无效的块类型");
+		}
+	}
+
+	void onBlockEnd() {
+		m_state = m_isFinalBlock ? STATE_DONE : STATE_HEADER;
+	}
+
+public:
+	Inflater() : m_window(WINDOW_SIZE) {}
+
+	/*
+	 *	开始解压一段新的压缩数据，data须在解压期间保持有效
+	 */
+	void reset(const char* data, size_t len) {
+		m_in = reinterpret_cast<const unsigned char*>(data);
+		m_inEnd = m_in + len;
+		m_bitBuf = 0;
+		m_bitCnt = 0;
+		m_state = STATE_HEADER;
+		m_isFinalBlock = false;
+		m_storedRemain = 0;
+		m_copyLen = 0;
+		m_outTotal = 0;
+	}
+
+	/*
+	 *	解压最多cap字节到buf，返回实际解压的字节数，返回0表示压缩数据已经结束
+	 *  压缩数据有误或不完整时抛出std::runtime_error
+	 */
+	size_t read(char* buf, size_t cap) {
+		static const uint16_t LEN_BASE[29] = {
+			3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+			35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+		};
+		static const uint8_t LEN_EXTRA[29] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+			3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+		};
+		static const uint16_t DIST_BASE[30] = {
+			1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+			257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+		};
+		static const uint8_t DIST_EXTRA[30] = {
+			0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+			7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+		};
+		size_t n = 0;
+		while (n < cap) {
+			if (m_copyLen > 0) {
+				// 重复串可能与自身重叠，只能逐字节复制
+				size_t cnt = std::min(m_copyLen, cap - n);
+				for (size_t i = 0; i < cnt; ++i) {
+					putByte(buf + n + i, m_window[(m_outTotal - m_copyDist) & (WINDOW_SIZE - 1)]);
+				}
+				n += cnt;
+				m_copyLen -= cnt;
+				continue;
+			}
+			if (m_state == STATE_STORED) {
+				if (m_storedRemain == 0) {
+					onBlockEnd();
+					continue;
+				}
+				size_t cnt = std::min({ m_storedRemain, cap - n,
+				                        static_cast<size_t>(m_inEnd - m_in) });
+				if (cnt == 0) {
+					fail("数据不完整");
+				}
+				for (size_t i = 0; i < cnt; ++i) {
+					putByte(buf + n + i, m_in[i]);
+				}
+				m_in += cnt;
+				n += cnt;
+				m_storedRemain -= cnt;
+				continue;
+			}
+			if (m_state == STATE_HEADER) {
+				readBlockHeader();
+				continue;
+			}
+			if (m_state == STATE_DONE) {
+				break;
+			}
+			int sym = decodeSymbol(m_litLenTable);
+			if (sym < 256) {
+				putByte(buf + n, static_cast<unsigned char>(sym));
+				++n;
+			} else if (sym == 256) {
+				onBlockEnd();
+			} else {
+				sym -= 257;
+				if (sym >= 29) {
+					fail("无效的长度码");
+				}
+				m_copyLen = LEN_BASE[sym] + getBits(LEN_EXTRA[sym]);
+				int distSym = decodeSymbol(m_distTable);
+				if (distSym >= 30) {
+					fail("无效的距离码");
+				}
+				m_copyDist = DIST_BASE[distSym] + getBits(DIST_EXTRA[distSym]);
+				if (m_copyDist > m_outTotal) {
+					fail("距离超出已解压的数据");
+				}
+			}
+		}
+		return n;
+	}
+
+	bool isDone() const {
+		return m_state == STATE_DONE && m_copyLen == 0;
+	}
+
+	/*
+	 *	压缩数据结束后，之后的数据(例如gzip的文件尾)的起始位置
+	 */
+	const char* getRemainData() const {
+		return reinterpret_cast<const char*>(m_in - m_bitCnt / 8);
+	}
+
+	/*
+	 *	本段压缩数据已解压的总字节数
+	 */
+	uint64_t getOutTotal() const {
+		return m_outTotal;
+	}
+};
+
+// .zip压缩包中文件的位置与压缩方式
+struct ZipEntry {
+	// 0为不压缩，8为DEFLATE
+	uint16_t method = 0;
+	uint16_t flags = 0;
+	uint64_t localHeaderOffset = 0;
+	uint64_t compressedSize = 0;
+	uint64_t uncompressedSize = 0;
+};
+
+// .zip压缩包的目录，按文件名查询其中的文件
+struct ZipIndex {
+	// 文件名使用/分隔目录，与压缩包中的记录相同
+	std::map<std::string, ZipEntry> entries;
+};
+
+namespace INTERNAL_testdata {
+	uint32_t readLE16(const char* p) {
+		const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+		return u[0] | (u[1] << 8);
+	}
+
+	uint32_t readLE32(const char* p) {
+		const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+		return u[0] | (u[1] << 8) | (u[2] << 16) | (static_cast<uint32_t>(u[3]) << 24);
+	}
+
+	uint64_t readLE64(const char* p) {
+		return readLE32(p) | (static_cast<uint64_t>(readLE32(p + 4)) << 32);
+	}
+
+	// 解析压缩包的中央目录，支持zip64，失败时抛出std::runtime_error
+	std::shared_ptr<const ZipIndex> parseZipIndex(std::string_view data) {
+		const size_t EOCD_SIZE = 22;
+		if (data.size() < EOCD_SIZE) {
+			throw std::runtime_error("不是有效的zip文件");
+		}
+		// 目录结尾记录之后最多有65535字节的注释，从后向前查找
+		size_t eocd = data.npos;
+		size_t lowest = data.size() > EOCD_SIZE + 65535 ? data.size() - EOCD_SIZE - 65535 : 0;
+		for (size_t i = data.size() - EOCD_SIZE + 1; i-- > lowest;) {
+			if (readLE32(data.data() + i) == 0x06054b50) {
+				eocd = i;
+				break;
+			}
+		}
+		if (eocd == data.npos) {
+			throw std::runtime_error("不是有效的zip文件");
+		}
+		const char* p = data.data() + eocd;
+		uint64_t entryCnt = readLE16(p + 10);
+		uint64_t dirSize = readLE32(p + 12);
+		uint64_t dirOffset = readLE32(p + 16);
+		// zip64的目录结尾定位记录紧挨在目录结尾记录之前
+		if (eocd >= 20 && readLE32(p - 20) == 0x07064b50) {
+			uint64_t zip64Eocd = readLE64(p - 20 + 8);
+			if (data.size() < 56 || zip64Eocd > data.size() - 56
+			        || readLE32(data.data() + zip64Eocd) != 0x06064b50) {
+				throw std::runtime_error("zip64目录结尾记录有误");
+			}
+			const char* q = data.data() + zip64Eocd;
+			entryCnt = readLE64(q + 32);
+			dirSize = readLE64(q + 40);
+			dirOffset = readLE64(q + 48);
+		}
+		if (dirOffset > data.size() || dirSize > data.size() - dirOffset) {
+			throw std::runtime_error("zip目录超出文件范围");
+		}
+		auto index = std::make_shared<ZipIndex>();
+		const char* cur = data.data() + dirOffset;
+		const char* dirEnd = cur + dirSize;
+		for (uint64_t i = 0; i < entryCnt; ++i) {
+			if (dirEnd - cur < 46 || readLE32(cur) != 0x02014b50) {
+				throw std::runtime_error("zip目录记录有误");
+			}
+			ZipEntry entry;
+			entry.flags = static_cast<uint16_t>(readLE16(cur + 8));
+			entry.method = static_cast<uint16_t>(readLE16(cur + 10));
+			entry.compressedSize = readLE32(cur + 20);
+			entry.uncompressedSize = readLE32(cur + 24);
+			size_t nameLen = readLE16(cur + 28);
+			size_t extraLen = readLE16(cur + 30);
+			size_t commentLen = readLE16(cur + 32);
+			entry.localHeaderOffset = readLE32(cur + 42);
+			if (static_cast<size_t>(dirEnd - cur) < 46 + nameLen + extraLen + commentLen) {
+				throw std::runtime_error("zip目录记录有误");
+			}
+			std::string name(cur + 46, nameLen);
+			// 值为0xFFFFFFFF的字段的真实值依次存放在zip64扩展字段中
+			const char* extra = cur + 46 + nameLen;
+			const char* extraEnd = extra + extraLen;
+			while (extraEnd - extra >= 4) {
+				uint32_t tag = readLE16(extra);
+				uint32_t size = readLE16(extra + 2);
+				const char* field = extra + 4;
+				if (static_cast<uint32_t>(extraEnd - field) < size) {
+					break;
+				}
+				if (tag == 0x0001) {
+					const char* fieldEnd = field + size;
+					for (uint64_t* value : { &entry.uncompressedSize, &entry.compressedSize,
+					                         &entry.localHeaderOffset }) {
+						if (*value == 0xFFFFFFFFu && fieldEnd - field >= 8) {
+							*value = readLE64(field);
+							field += 8;
+						}
+					}
+				}
+				extra += 4 + size;
+			}
+			// 目录本身不是测试数据
+			if (!name.empty() && name.back() != '/') {
+				index->entries[name] = entry;
+			}
+			cur += 46 + nameLen + extraLen + commentLen;
+		}
+		return index;
+	}
+}
+
+/*
+ *	拆分压缩包中文件的路径，例如tests.zip/sub/1.in拆为tests.zip与sub/1.in
+ *  压缩包在路径中视为目录，路径不在压缩包中时返回false
+ */
+bool splitZipPath(const std::string& path, std::string& zipPath, std::string& entryName) {
+	for (size_t i = 0; i + 4 < path.size(); ++i) {
+		if (path[i + 4] != '/' && path[i + 4] != '\\') {
+			continue;
+		}
+		std::string ext = path.substr(i, 4);
+		std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+		if (ext != ".zip") {
+			continue;
+		}
+		std::string prefix = path.substr(0, i + 4);
+		if (!winfs::isFileExist(prefix) || winfs::isDir(prefix)) {
+			continue;
+		}
+		zipPath = prefix;
+		entryName = path.substr(i + 5);
+#ifdef _WIN32
+		std::replace(entryName.begin(), entryName.end(), '\\', '/');
+#endif
+		return true;
+	}
+	return false;
+}
+
+/*
+ *	读取压缩包的目录，同一压缩包只解析一次，失败时抛出std::runtime_error
+ *  压缩包的大小或修改时间变化后重新解析，长时间运行时不会使用过时的目录
+ *  可在多个线程中同时调用
+ */
+std::shared_ptr<const ZipIndex> getZipIndex(const std::string& zipPath) {
+	struct StampedIndex {
+		long long fileSize;
+		long long modifyTime;
+		std::shared_ptr<const ZipIndex> index;
+	};
+	static std::mutex mutex;
+	static std::map<std::string, StampedIndex> indexes;
+	long long fileSize = -1, modifyTime = -1;
+	winfs::getFileSizeAndTime(zipPath, fileSize, modifyTime);
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = indexes.find(zipPath);
+	if (it != indexes.end() && it->second.fileSize == fileSize
+	        && it->second.modifyTime == modifyTime) {
+		return it->second.index;
+	}
+	MappedFile file(zipPath);
+	auto index = INTERNAL_testdata::parseZipIndex(file.view());
+	indexes[zipPath] = StampedIndex{ fileSize, modifyTime, index };
+	return index;
+}
+
+/*
+ *	列出压缩包中的全部文件，返回可以直接用于TestDataStream的路径
+ */
+std::vector<std::string> getFilesOfZip(const std::string& zipPath) {
+	std::vector<std::string> res;
+	for (const auto& e : getZipIndex(zipPath)->entries) {
+		std::string name = e.first;
+#ifdef _WIN32
+		std::replace(name.begin(), name.end(), '/', '\\');
+#endif
+		res.push_back(zipPath + winfs::PATH_SEP + name);
+	}
+	return res;
+}
+
+/*
+ *	判断路径是否以指定后缀结尾，不区分大小写
+ */
+bool isPathEndWith(const std::string& path, const std::string& suffix) {
+	if (path.size() < suffix.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < suffix.size(); ++i) {
+		if (::tolower(static_cast<unsigned char>(path[path.size() - suffix.size() + i]))
+		        != ::tolower(static_cast<unsigned char>(suffix[i]))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ *	去除测试数据路径末尾的压缩格式后缀(.gz)
+ */
+std::string removeCompressExten(const std::string& path) {
+	if (isPathEndWith(path, ".gz")) {
+		return path.substr(0, path.size() - 3);
+	}
+	return path;
+}
+
+/*
+ *	判断测试数据是否为可以直接打开的普通文件
+ *  普通文件可以直接作为标准输入，也可以交给checker
+ */
+bool isPlainTestData(const std::string& path) {
+	std::string zipPath, entryName;
+	return removeCompressExten(path) == path && !splitZipPath(path, zipPath, entryName);
+}
+
+/*
+ *	判断测试数据是否存在，压缩包中的文件按压缩包的目录判断
+ */
+bool isTestDataExist(const std::string& path) {
+	std::string zipPath, entryName;
+	if (!splitZipPath(path, zipPath, entryName)) {
+		return winfs::isFileExist(path);
+	}
+	try {
+		auto index = getZipIndex(zipPath);
+		return index->entries.count(entryName) > 0;
+	} catch (std::runtime_error&) {
+		return false;
+	}
+}
+
+/*
+ *	测试数据的大小(字节)，只用于估计运行时间，无法获取时返回0
+ *  压缩包中的文件取解压后的大小，.gz等压缩文件取文件本身的大小
+ */
+long long getTestDataSize(const std::string& path) {
+	std::string zipPath, entryName;
+	if (splitZipPath(path, zipPath, entryName)) {
+		try {
+			auto index = getZipIndex(zipPath);
+			auto it = index->entries.find(entryName);
+			return it == index->entries.end() ? 0
+			       : static_cast<long long>(it->second.uncompressedSize);
+		} catch (std::runtime_error&) {
+			return 0;
+		}
+	}
+	long long fileSize, modifyTime;
+	return winfs::getFileSizeAndTime(path, fileSize, modifyTime) ? fileSize : 0;
+}
+
+/*
+ *	测试数据的大小与修改时间，压缩包中的文件取压缩包的
+ *  只用于判断文件是否变化，无法获取时两者都为-1
+ */
+std::string getTestDataStamp(const std::string& path) {
+	std::string zipPath, entryName;
+	long long fileSize = -1, modifyTime = -1;
+	winfs::getFileSizeAndTime(splitZipPath(path, zipPath, entryName) ? zipPath : path,
+	                          fileSize, modifyTime);
+	return std::to_string(fileSize) + ":" + std::to_string(modifyTime);
+}
+
+// 测试数据的读取流，按顺序分段取出解压后的内容
+// 支持普通文件、.gz文件(可以由多段拼接而成)与.zip压缩包中不压缩或DEFLATE压缩的文件
+// 不校验CRC，只校验解压后的大小
+class TestDataStream {
+private:
+	enum Kind {
+		KIND_PLAIN,
+		KIND_GZIP,
+		KIND_DEFLATE
+	};
+
+	MappedFile m_file;
+	Kind m_kind = KIND_PLAIN;
+
+	// 未解压的数据
+	std::string_view m_raw;
+
+	// 普通数据的读取位置
+	size_t m_plainPos = 0;
+
+	// 当前解压的数据段之后剩余的数据(gzip的文件尾与后续的段)
+	std::string_view m_rest;
+
+	// 解压后应有的大小，未知时为-1
+	int64_t m_expectedSize = -1;
+
+	uint64_t m_outTotal = 0;
+	bool m_isDone = false;
+	Inflater m_inflater;
+
+	static std::string getContainerPath(const std::string& path) {
+		std::string zipPath, entryName;
+		return splitZipPath(path, zipPath, entryName) ? zipPath : path;
+	}
+
+	// 解析一段gzip数据的头部，开始解压其后的压缩数据
+	void startGzipMember(std::string_view data) {
+		using namespace INTERNAL_testdata;
+		if (data.size() < 18 || static_cast<unsigned char>(data[0]) != 0x1f
+		        || static_cast<unsigned char>(data[1]) != 0x8b || data[2] != 8) {
+			throw std::runtime_error("不是有效的gzip文件");
+		}
+		unsigned char flags = static_cast<unsigned char>(data[3]);
+		size_t pos = 10;
+		// FEXTRA
+		if (flags & 4) {
+			if (data.size() < pos + 2) {
+				throw std::runtime_error("gzip头部不完整");
+			}
+			pos += 2 + readLE16(data.data() + pos);
+		}
+		// FNAME与FCOMMENT以\0结尾
+		for (int bit : { 8, 16 }) {
+			if (flags & bit) {
+				pos = data.find('\0', pos);
+				if (pos == data.npos) {
+					throw std::runtime_error("gzip头部不完整");
+				}
+				++pos;
+			}
+		}
+		// FHCRC
+		if (flags & 2) {
+			pos += 2;
+		}
+		if (pos > data.size()) {
+			throw std::runtime_error("gzip头部不完整");
+		}
+		m_inflater.reset(data.data() + pos, data.size() - pos);
+	}
+
+	// 一段gzip数据解压完毕，校验文件尾中的大小，之后还有数据时继续解压下一段
+	bool finishGzipMember() {
+		const char* trailer = m_inflater.getRemainData();
+		const char* end = m_raw.data() + m_raw.size();
+		if (end - trailer < 8) {
+			throw std::runtime_error("gzip文件尾不完整");
+		}
+		if (INTERNAL_testdata::readLE32(trailer + 4)
+		        != static_cast<uint32_t>(m_inflater.getOutTotal())) {
+			throw std::runtime_error("gzip数据的大小与记录不一致");
+		}
+		std::string_view rest(trailer + 8, end - trailer - 8);
+		// 部分工具会在末尾补0，不作为新的一段
+		if (rest.find_first_not_of('\0') == rest.npos) {
+			return false;
+		}
+		startGzipMember(rest);
+		return true;
+	}
+
+public:
+	/*
+	 *	打开测试数据，按路径判断格式，失败时抛出std::runtime_error
+	 *  压缩包中的文件使用压缩包路径加文件名表示，例如tests.zip/1.in
+	 */
+	explicit TestDataStream(const std::string& path) : m_file(getContainerPath(path)) {
+		using namespace INTERNAL_testdata;
+		std::string zipPath, entryName;
+		if (splitZipPath(path, zipPath, entryName)) {
+			auto index = getZipIndex(zipPath);
+			auto it = index->entries.find(entryName);
+			if (it == index->entries.end()) {
+				throw std::runtime_error("压缩包中没有该文件");
+			}
+			const ZipEntry& entry = it->second;
+			if (entry.flags & 1) {
+				throw std::runtime_error("不支持加密的压缩包");
+			}
+			if (entry.method != 0 && entry.method != 8) {
+				throw std::runtime_error("不支持的压缩方式，只支持不压缩与DEFLATE");
+			}
+			std::string_view data = m_file.view();
+			// 本地文件头中的文件名与扩展字段长度可能与目录中的不同
+			if (data.size() < 30 || entry.localHeaderOffset > data.size() - 30
+			        || readLE32(data.data() + entry.localHeaderOffset) != 0x04034b50) {
+				throw std::runtime_error("压缩包的本地文件头有误");
+			}
+			const char* header = data.data() + entry.localHeaderOffset;
+			uint64_t dataOffset = entry.localHeaderOffset + 30 + readLE16(header + 26)
+			                      + readLE16(header + 28);
+			if (dataOffset > data.size() || entry.compressedSize > data.size() - dataOffset) {
+				throw std::runtime_error("压缩包中的数据超出文件范围");
+			}
+			m_raw = data.substr(dataOffset, entry.compressedSize);
+			m_expectedSize = static_cast<int64_t>(entry.uncompressedSize);
+			if (entry.method == 8) {
+				m_kind = KIND_DEFLATE;
+				m_inflater.reset(m_raw.data(), m_raw.size());
+			}
+		} else {
+			m_raw = m_file.view();
+			if (isPathEndWith(path, ".gz")) {
+				m_kind = KIND_GZIP;
+				startGzipMember(m_raw);
+			}
+		}
+	}
+
+	TestDataStream(const TestDataStream&) = delete;
+	TestDataStream& operator=(const TestDataStream&) = delete;
+
+	/*
+	 *	读取最多cap字节到buf，返回实际读取的字节数，返回0表示数据已经结束
+	 *  数据有误时抛出std::runtime_error
+	 */
+	size_t read(char* buf, size_t cap) {
+		if (m_isDone || cap == 0) {
+			return 0;
+		}
+		size_t n = 0;
+		if (m_kind == KIND_PLAIN) {
+			n = std::min(cap, m_raw.size() - m_plainPos);
+			memcpy(buf, m_raw.data() + m_plainPos, n);
+			m_plainPos += n;
+		} else {
+			while (n == 0) {
+				n = m_inflater.read(buf, cap);
+				if (n > 0 || !m_inflater.isDone()) {
+					continue;
+				}
+				if (m_kind != KIND_GZIP || !finishGzipMember()) {
+					break;
+				}
+			}
+		}
+		m_outTotal += n;
+		if (n == 0) {
+			m_isDone = true;
+			if (m_expectedSize >= 0 && m_outTotal != static_cast<uint64_t>(m_expectedSize)) {
+				throw std::runtime_error("解压后的大小与压缩包中的记录不一致");
+			}
+		}
+		return n;
+	}
+
+	/*
+	 *	未解压的原始数据，内容相同的原始数据解压结果也相同
+	 */
+	std::string_view getRawView() const {
+		return m_raw;
+	}
+};
+
+// 整个读入的测试数据
+// 普通文件直接映射，压缩的测试数据只能完整解压到内存中
+class TestDataContent {
+private:
+	std::unique_ptr<MappedFile> m_file;
+	std::string m_text;
+	std::string_view m_view;
+
+public:
+	/*
+	 *	读入测试数据，失败时抛出std::runtime_error
+	 */
+	explicit TestDataContent(const std::string& path) {
+		if (isPlainTestData(path)) {
+			m_file.reset(new MappedFile(path));
+			m_view = m_file->view();
+			return;
+		}
+		TestDataStream stream(path);
+		size_t len;
+		do {
+			size_t oldSize = m_text.size();
+			m_text.resize(oldSize + 1024 * 1024);
+			len = stream.read(&m_text[oldSize], 1024 * 1024);
+			m_text.resize(oldSize + len);
+		} while (len > 0);
+		m_view = m_text;
+	}
+
+	TestDataContent(const TestDataContent&) = delete;
+	TestDataContent& operator=(const TestDataContent&) = delete;
+
+	std::string_view view() const {
+		return m_view;
+	}
+};
+
+#endif /* _XY0797_TESTDATA */
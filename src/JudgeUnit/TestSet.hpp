@@ -0,0 +1,119 @@
+/**
+ * \file    	TestSet.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		枚举测试集中的样例，确定各样例的答案文件与显示顺序
+ */
+#ifndef _XY0797_TESTSET
+#define _XY0797_TESTSET 1
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "../WindowsFileSysTool.hpp"
+#include "TestData.hpp"
+
+// 判断文件名是否为指定后缀的测试数据，包括其压缩版本
+bool isTestDataFileName(const std::string& fileName, const std::string& extension) {
+	return isPathEndWith(fileName, extension) || isPathEndWith(fileName, extension + ".gz");
+}
+
+// 判断文件名是否为指定后缀的zstd压缩的测试数据，这种格式无法读取，需要在选择测试集时拒绝
+bool isZstdTestDataFileName(const std::string& fileName, const std::string& extension) {
+	return isPathEndWith(fileName, extension + ".zst");
+}
+
+// 输入文件对应的答案文件，压缩的输入文件先去掉压缩格式后缀
+// 答案文件不存在时尝试其.gz版本，仍不存在时返回未压缩的路径，由评测报告错误
+std::string getAnsFilePathOf(const std::string& testCaseFilePath,
+                             const std::string& testCaseExtension,
+                             const std::string& ansExtension) {
+	std::string plainPath = removeCompressExten(testCaseFilePath);
+	size_t i1 = plainPath.rfind(testCaseExtension);
+	std::string ansPath = plainPath.substr(0, i1) + ansExtension;
+	if (!isTestDataExist(ansPath) && isTestDataExist(ansPath + ".gz")) {
+		return ansPath + ".gz";
+	}
+	return ansPath;
+}
+
+// 测试集是否需要按后缀枚举输入文件，文件夹与.zip压缩包需要，单个文件不需要
+bool isTestSetMultiCase(const std::string& testSetPath) {
+	return winfs::isDir(testSetPath) || isPathEndWith(testSetPath, ".zip");
+}
+
+// 枚举测试集中的输入文件，顺序不定
+// 文件夹与.zip压缩包中按后缀枚举，输入文件可以用.gz压缩，单个文件直接作为唯一的样例
+// 没有任何输入文件或含有zstd压缩的输入文件时抛出std::runtime_error
+std::vector<std::string> getTestCaseFiles(const std::string& testSetPath,
+        const std::string& testCaseExtension) {
+	std::vector<std::string> testCaseFiles;
+	if (!isTestSetMultiCase(testSetPath)) {
+		if (isPathEndWith(testSetPath, ".zst")) {
+			throw std::runtime_error("不支持zstd压缩的测试数据，请先解压：" + testSetPath);
+		}
+		testCaseFiles.push_back(testSetPath);
+		return testCaseFiles;
+	}
+	std::string zstdFile;
+	if (!winfs::isDir(testSetPath)) {
+		for (const auto& path : getFilesOfZip(testSetPath)) {
+			if (isTestDataFileName(path, testCaseExtension)) {
+				testCaseFiles.push_back(path);
+			} else if (isZstdTestDataFileName(path, testCaseExtension)) {
+				zstdFile = path;
+			}
+		}
+	} else {
+		testCaseFiles = winfs::getFilesOfDirectory(testSetPath, "*" + testCaseExtension + "*",
+		[&](const std::string & dirPath, const std::string & fileName) {
+			if (isZstdTestDataFileName(fileName, testCaseExtension)) {
+				zstdFile = dirPath + winfs::PATH_SEP + fileName;
+			}
+			return isTestDataFileName(fileName, testCaseExtension)
+			       ? dirPath + winfs::PATH_SEP + fileName : std::string();
+		});
+	}
+	if (!zstdFile.empty()) {
+		throw std::runtime_error("不支持zstd压缩的测试数据，请先解压：" + zstdFile);
+	}
+	if (testCaseFiles.empty()) {
+		throw std::runtime_error("路径无效或指定路径下无任何测试集文件！");
+	}
+	return testCaseFiles;
+}
+
+// 样例的名称，即去掉压缩格式后缀与输入文件后缀的文件名
+std::string getTestCaseName(const std::string& testCaseFilePath) {
+	return winfs::getNonExtenFileName(removeCompressExten(testCaseFilePath));
+}
+
+// 样例名称若为不超过long long范围的纯数字，把数字值写入num并返回true
+bool parseNumCaseName(const std::string& name, long long& num) {
+	if (name.empty() || name.length() > 19 || (name.length() == 19 && name[0] == '9')) {
+		return false;
+	}
+	for (char ch : name) {
+		if (ch < '0' || ch > '9') {
+			return false;
+		}
+	}
+	num = std::stoll(name);
+	return true;
+}
+
+// 样例的显示顺序：数字名称排在前面并按数值从小到大，其余按字典序
+bool isCaseNameLess(const std::string& a, const std::string& b) {
+	long long numA, numB;
+	bool isNumA = parseNumCaseName(a, numA);
+	bool isNumB = parseNumCaseName(b, numB);
+	if (isNumA && isNumB) {
+		return numA < numB;
+	}
+	if (isNumA || isNumB) {
+		return isNumA;
+	}
+	return a < b;
+}
+
+#endif /* _XY0797_TESTSET */
@@ -8,8 +8,20 @@
 #define _XY0797_TESTSTRINGCMP 1
 
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <cstring>
 #include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _XY0797_STRCMP_SSE2 1
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 // 差异部分前面字符数的最大容许值
 const int MAX_DIFF_PRE_SHOW_MAX = 30;
@@ -23,23 +35,224 @@ const int MAX_DIFF_SHOW_MAX = 80;
 // 超出容许值后展示的字符数
 const int MAX_DIFF_SHOW = 50;
 
-std::string m_TestERRStr;
+// 逐字节比较时每次交给memcmp的块大小
+const size_t CMP_BLOCK_SIZE = 4096;
 
-// 输出差异到m_TestERRStr里面
+// 达到该长度后分块交给多个线程比较，评测结束后的比较不再受限于单个核心
+const size_t PARALLEL_CMP_MIN_LEN = 64 * 1024 * 1024;
+
+// 并行比较时每块的大小，是CMP_BLOCK_SIZE的整数倍
+const size_t PARALLEL_CMP_CHUNK = 4 * 1024 * 1024;
+
+// 并行比较最多使用的线程数
+const size_t PARALLEL_CMP_MAX_THREAD = 8;
+
+// 并行比较之前先串行比较的长度，比较过程会在每处差异后重新进入
+// 差异较密时在这里就能找到，不会反复创建线程，并行时越过差异多比较的部分也不超过这个长度
+const size_t PARALLEL_CMP_PROBE_LEN = PARALLEL_CMP_CHUNK * PARALLEL_CMP_MAX_THREAD;
+
+// 最低的置位序号，mask不为0
+int lowestBitIndex(unsigned int mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// 单线程求两段内存的公共前缀长度
+// 先用memcmp按块跳过相同的部分，再在不同的块内找到第一个不同的字节
+size_t getCommonPrefixLenSerial(const char* a, size_t aLen, const char* b, size_t bLen) {
+	size_t len = std::min(aLen, bLen);
+	size_t i = 0;
+	while (len - i >= CMP_BLOCK_SIZE && memcmp(a + i, b + i, CMP_BLOCK_SIZE) == 0) {
+		i += CMP_BLOCK_SIZE;
+	}
+#ifdef _XY0797_STRCMP_SSE2
+	while (len - i >= 16) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		unsigned int mask = static_cast<unsigned int>(
+		                        _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xFFFFu;
+		if (mask != 0) {
+			return i + lowestBitIndex(mask);
+		}
+		i += 16;
+	}
+#endif
+	while (i < len && a[i] == b[i]) {
+		++i;
+	}
+	return i;
+}
+
+
+// 把长度为len的数据切分为PARALLEL_CMP_CHUNK大小的块，由多个线程按块序号从小到大领取
+// func(块序号, 块起点, 块长度)返回false表示不再需要序号更大的块，已领取的更小的块仍会处理完
+template <class Func>
+void forEachChunkParallel(size_t len, Func func) {
+	size_t chunkCnt = (len + PARALLEL_CMP_CHUNK - 1) / PARALLEL_CMP_CHUNK;
+	std::atomic<size_t> nextChunk(0);
+	std::atomic<size_t> stopChunk(chunkCnt);
+	auto worker = [&]() {
+		while (true) {
+			size_t chunk = nextChunk.fetch_add(1);
+			if (chunk >= stopChunk.load()) {
+				break;
+			}
+			size_t begin = chunk * PARALLEL_CMP_CHUNK;
+			if (!func(chunk, begin, std::min(PARALLEL_CMP_CHUNK, len - begin))) {
+				// 记录需要停止的最小块序号
+				size_t cur = stopChunk.load();
+				while (chunk < cur && !stopChunk.compare_exchange_weak(cur, chunk)) {
+				}
+			}
+		}
+	};
+	size_t threadCnt = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+	                                    std::min(chunkCnt, PARALLEL_CMP_MAX_THREAD));
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCnt; ++i) {
+		threads.emplace_back(worker);
+	}
+	// 当前线程也参与比较
+	worker();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+// 两段内存的公共前缀长度
+// 较长且开头的PARALLEL_CMP_PROBE_LEN字节相同时，剩余部分分块并行比较，
+// 取最靠前的不同块，再在该块内找到第一个不同的字节
+size_t getCommonPrefixLen(const char* a, size_t aLen, const char* b, size_t bLen) {
+	size_t len = std::min(aLen, bLen);
+	if (len < PARALLEL_CMP_MIN_LEN) {
+		return getCommonPrefixLenSerial(a, len, b, len);
+	}
+	size_t probeLen = getCommonPrefixLenSerial(a, PARALLEL_CMP_PROBE_LEN,
+	                                           b, PARALLEL_CMP_PROBE_LEN);
+	if (probeLen < PARALLEL_CMP_PROBE_LEN) {
+		return probeLen;
+	}
+	a += probeLen;
+	b += probeLen;
+	len -= probeLen;
+	std::atomic<size_t> firstDiffChunk(SIZE_MAX);
+	forEachChunkParallel(len, [&](size_t chunk, size_t begin, size_t chunkLen) {
+		if (memcmp(a + begin, b + begin, chunkLen) == 0) {
+			return true;
+		}
+		size_t cur = firstDiffChunk.load();
+		while (chunk < cur && !firstDiffChunk.compare_exchange_weak(cur, chunk)) {
+		}
+		return false;
+	});
+	size_t chunk = firstDiffChunk.load();
+	if (chunk == SIZE_MAX) {
+		return probeLen + len;
+	}
+	size_t begin = chunk * PARALLEL_CMP_CHUNK;
+	size_t chunkLen = std::min(PARALLEL_CMP_CHUNK, len - begin);
+	return probeLen + begin + getCommonPrefixLenSerial(a + begin, chunkLen, b + begin, chunkLen);
+}
+
+// 找到第一个换行符(\n或\r)，找不到返回end
+const char* findLineEnd(const char* p, const char* end) {
+#ifdef _XY0797_STRCMP_SSE2
+	const __m128i lf = _mm_set1_epi8('\n');
+	const __m128i cr = _mm_set1_epi8('\r');
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+		                        _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr))));
+		if (mask != 0) {
+			return p + lowestBitIndex(mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && *p != '\n' && *p != '\r') {
+		++p;
+	}
+	return p;
+}
+
+// 跳过lineEnd处的换行符，\r\n视为一个换行
+const char* skipLineBreak(const char* lineEnd, const char* end) {
+	if (lineEnd == end) {
+		return end;
+	}
+	if (*lineEnd == '\r' && lineEnd + 1 < end && lineEnd[1] == '\n') {
+		return lineEnd + 2;
+	}
+	return lineEnd + 1;
+}
+
+// 统计[p, chunkEnd)中的换行数，\r\n视为一个换行
+// \r是否与后面的\n组成一个换行要看end之前的内容，因此分块统计的结果可以直接相加
+long long countLineBreaks(const char* p, const char* chunkEnd, const char* end) {
+	long long cnt = 0;
+	while ((p = findLineEnd(p, chunkEnd)) != chunkEnd) {
+		if (*p == '\n' || p + 1 == end || p[1] != '\n') {
+			++cnt;
+		}
+		++p;
+	}
+	return cnt;
+}
+
+// 统计行数，与对统一换行符后的文本逐次调用std::getline得到的行数相同
+// 末尾的单个换行不会多出一行，较长时分块并行统计
+long long countLines(const char* p, const char* end) {
+	if (p == end) {
+		return 0;
+	}
+	size_t len = end - p;
+	long long cnt;
+	if (len < PARALLEL_CMP_MIN_LEN) {
+		cnt = countLineBreaks(p, end, end);
+	} else {
+		std::atomic<long long> totalCnt(0);
+		forEachChunkParallel(len, [&](size_t, size_t begin, size_t chunkLen) {
+			totalCnt += countLineBreaks(p + begin, p + begin + chunkLen, end);
+			return true;
+		});
+		cnt = totalCnt.load();
+	}
+	// 没有换行结尾的最后一行
+	if (end[-1] != '\n' && end[-1] != '\r') {
+		++cnt;
+	}
+	return cnt;
+}
+
+// 去除行末空格后的长度
+size_t getTrimmedLen(const char* lineBegin, const char* lineEnd) {
+	while (lineEnd > lineBegin && lineEnd[-1] == ' ') {
+		--lineEnd;
+	}
+	return lineEnd - lineBegin;
+}
+
+// 输出差异到diffMsg里面
 // 差异从索引i开始出现
 // (i可能是某一字符串的长度，但是不可能两个都是)
-void genDiffMsg(const std::string& stdAns, const std::string& testAns, int i) {
+void genDiffMsg(const std::string& stdAns, const std::string& testAns, int i,
+                std::string& diffMsg) {
 	int Alen = stdAns.length();
 	int Tlen = testAns.length();
 	// 显示标准答案
-	m_TestERRStr = "标准答案: \n";
+	diffMsg = "标准答案: \n";
 	// 输出差异前面的部分
 	if (i > MAX_DIFF_PRE_SHOW_MAX) {
-		m_TestERRStr += "\x1b[1;37;100m...还有" + std::to_string(i - MAX_DIFF_PRE_SHOW)
-		                + "个字符...\x1b[0m"
-		                + stdAns.substr(i - MAX_DIFF_PRE_SHOW, MAX_DIFF_PRE_SHOW);
+		diffMsg += "\x1b[1;37;100m...还有" + std::to_string(i - MAX_DIFF_PRE_SHOW)
+		           + "个字符...\x1b[0m"
+		           + stdAns.substr(i - MAX_DIFF_PRE_SHOW, MAX_DIFF_PRE_SHOW);
 	} else {
-		m_TestERRStr += stdAns.substr(0, i);
+		diffMsg += stdAns.substr(0, i);
 	}
 	// 输出差异部分
 	int ARemainLen = Alen - i;
@@ -50,23 +263,23 @@ void genDiffMsg(const std::string& stdAns, const std::string& testAns, int i) {
 	} else if (ARemainLen > MAX_DIFF_SHOW_MAX) {
 		// 差异部分过长
 		ARealShowLen = MAX_DIFF_SHOW;
-		m_TestERRStr += stdAns.substr(i, MAX_DIFF_SHOW) + "\x1b[1;37;100m...还有"
-		                + std::to_string(ARemainLen - MAX_DIFF_SHOW)
-		                + "个字符...\x1b[0m";
+		diffMsg += stdAns.substr(i, MAX_DIFF_SHOW) + "\x1b[1;37;100m...还有"
+		           + std::to_string(ARemainLen - MAX_DIFF_SHOW)
+		           + "个字符...\x1b[0m";
 	} else {
 		// 正常输出所有
 		ARealShowLen = ARemainLen;
-		m_TestERRStr += stdAns.substr(i, ARemainLen);
+		diffMsg += stdAns.substr(i, ARemainLen);
 	}
 	// 显示程序输出，并且高亮显示差异
-	m_TestERRStr += "\n程序输出：\n";
+	diffMsg += "\n程序输出：\n";
 	// 显示差异前面的
 	if (i > MAX_DIFF_PRE_SHOW_MAX) {
-		m_TestERRStr += "\x1b[1;37;100m...还有" + std::to_string(i - MAX_DIFF_PRE_SHOW)
-		                + "个字符...\x1b[0m"
-		                + testAns.substr(i - MAX_DIFF_PRE_SHOW, MAX_DIFF_PRE_SHOW);
+		diffMsg += "\x1b[1;37;100m...还有" + std::to_string(i - MAX_DIFF_PRE_SHOW)
+		           + "个字符...\x1b[0m"
+		           + testAns.substr(i - MAX_DIFF_PRE_SHOW, MAX_DIFF_PRE_SHOW);
 	} else {
-		m_TestERRStr += testAns.substr(0, i);
+		diffMsg += testAns.substr(0, i);
 	}
 	// 输出差异部分
 	int TRemainLen = Tlen - i;
@@ -75,13 +288,13 @@ void genDiffMsg(const std::string& stdAns, const std::string& testAns, int i) {
 		if (ARemainLen > MAX_DIFF_SHOW_MAX) {
 			// 差异部分过长
 			// 只输出ARealShowLen个红色空格
-			m_TestERRStr += "\x1b[1;37;41m" + std::string(ARealShowLen, ' ')
-			                + "\x1b[0m\x1b[1;37;100m..."
-			                "还缺失" + std::to_string(ARemainLen - ARealShowLen)
-			                + "个字符...\x1b[0m";
+			diffMsg += "\x1b[1;37;41m" + std::string(ARealShowLen, ' ')
+			           + "\x1b[0m\x1b[1;37;100m..."
+			           "还缺失" + std::to_string(ARemainLen - ARealShowLen)
+			           + "个字符...\x1b[0m";
 		} else {
 			// 输出ARealShowLen个红色空格
-			m_TestERRStr += "\x1b[1;37;41m" + std::string(ARealShowLen, ' ') + "\x1b[0m";
+			diffMsg += "\x1b[1;37;41m" + std::string(ARealShowLen, ' ') + "\x1b[0m";
 		}
 		return;
 	}
@@ -99,34 +312,34 @@ void genDiffMsg(const std::string& stdAns, const std::string& testAns, int i) {
 				// 没有比标答长，正常比较
 				if (ch == stdAns[i]) {
 					if (isred) {
-						m_TestERRStr += "\x1b[0m";
+						diffMsg += "\x1b[0m";
 						isred = false;
 					}
-					m_TestERRStr += ch;
+					diffMsg += ch;
 				} else {
 					if (!isred) {
-						m_TestERRStr += "\x1b[1;37;41m";
+						diffMsg += "\x1b[1;37;41m";
 						isred = true;
 					}
-					m_TestERRStr += ch;
+					diffMsg += ch;
 				}
 				++i;
 			} else {
 				// 比标答长，一定错
 				if (!isred) {
-					m_TestERRStr += "\x1b[1;37;41m";
+					diffMsg += "\x1b[1;37;41m";
 					isred = true;
 				}
-				m_TestERRStr += ch;
+				diffMsg += ch;
 			}
 		}
 		if (TRealShowLen < ARealShowLen) {
 			// 说明末尾缺少了字符
 			if (!isred) {
-				m_TestERRStr += "\x1b[1;37;41m";
+				diffMsg += "\x1b[1;37;41m";
 				isred = true;
 			}
-			m_TestERRStr += std::string(ARealShowLen - TRealShowLen, ' ');
+			diffMsg += std::string(ARealShowLen - TRealShowLen, ' ');
 			TRealShowLen = ARealShowLen;
 		}
 		// 执行到这里，两者实际显示长度一定相等
@@ -136,52 +349,53 @@ void genDiffMsg(const std::string& stdAns, const std::string& testAns, int i) {
 			if (TRemainLen <= MAX_DIFF_SHOW_MAX) {
 				// 末尾比标准答案多出的字符可完全展示出来
 				if (!isred) {
-					m_TestERRStr += "\x1b[1;37;41m";
+					diffMsg += "\x1b[1;37;41m";
 					isred = true;
 				}
-				m_TestERRStr += testAns.substr(i, TRemainLen - TRealShowLen);
+				diffMsg += testAns.substr(i, TRemainLen - TRealShowLen);
 				TRealShowLen = TRemainLen;
 			} else if (TRealShowLen < MAX_DIFF_SHOW) {
 				// 可显示到MAX_DIFF_SHOW
 				if (!isred) {
-					m_TestERRStr += "\x1b[1;37;41m";
+					diffMsg += "\x1b[1;37;41m";
 					isred = true;
 				}
-				m_TestERRStr += testAns.substr(i, MAX_DIFF_SHOW - TRealShowLen);
+				diffMsg += testAns.substr(i, MAX_DIFF_SHOW - TRealShowLen);
 				TRealShowLen = MAX_DIFF_SHOW;
 			}
 		}
 
 		if (isred) {
-			m_TestERRStr += "\x1b[0m";
+			diffMsg += "\x1b[0m";
 		}
 	}
 
 	// 判断折叠的问题
 	if (TRemainLen > TRealShowLen) {
 		// 需要折叠显示
-		m_TestERRStr += "\x1b[1;37;100m...还有"
-		                + std::to_string(TRemainLen - TRealShowLen)
-		                + "个字符...\x1b[0m";
+		diffMsg += "\x1b[1;37;100m...还有"
+		           + std::to_string(TRemainLen - TRealShowLen)
+		           + "个字符...\x1b[0m";
 		if (ARemainLen > TRemainLen) {
-			m_TestERRStr += " \x1b[1;37;41m...还缺失"
-			                + std::to_string(ARemainLen - TRemainLen)
-			                + "个字符...\x1b[0m";
+			diffMsg += " \x1b[1;37;41m...还缺失"
+			           + std::to_string(ARemainLen - TRemainLen)
+			           + "个字符...\x1b[0m";
 		}
 		return;
 	} else {
 		// TRemainLen已经展示完全了
 		if (ARemainLen > TRealShowLen) {
-			m_TestERRStr += "\x1b[1;37;100m...还缺失"
-			                + std::to_string(ARemainLen - TRealShowLen)
-			                + "个字符...\x1b[0m";
+			diffMsg += "\x1b[1;37;100m...还缺失"
+			           + std::to_string(ARemainLen - TRealShowLen)
+			           + "个字符...\x1b[0m";
 		}
 	}
 }
 
 
-// 比较是否相等，如果不相等会将差异以人类可读形式写在m_TestERRStr里面
-bool testStringCmp(const std::string& stdAns, const std::string& testAns) {
+// 比较是否相等，如果不相等会将差异以人类可读形式写在diffMsg里面
+bool testStringCmp(const std::string& stdAns, const std::string& testAns,
+                   std::string& diffMsg) {
 	bool isAEmpty = stdAns.empty();
 	bool isTEmpty = testAns.empty();
 	int Alen = stdAns.length();
@@ -190,31 +404,31 @@ bool testStringCmp(const std::string& stdAns, const std::string& testAns) {
 	// 有一个为空或都不为空
 	if (isAEmpty) {
 		// 程序输出有多余
-		m_TestERRStr = "标准答案: \n\x1b[1;37;100m   空   \x1b[0m\n程序输出：\n";
+		diffMsg = "标准答案: \n\x1b[1;37;100m   空   \x1b[0m\n程序输出：\n";
 		if (Tlen > MAX_DIFF_SHOW_MAX) {
 			// 差异部分过长
-			m_TestERRStr += "\x1b[1;37;41m"
-			                + testAns.substr(0, MAX_DIFF_SHOW)
-			                + "\x1b[0m\x1b[1;37;100m..."
-			                "还多余" + std::to_string(Tlen - MAX_DIFF_SHOW)
-			                + "个字符...\x1b[0m";
+			diffMsg += "\x1b[1;37;41m"
+			           + testAns.substr(0, MAX_DIFF_SHOW)
+			           + "\x1b[0m\x1b[1;37;100m..."
+			           "还多余" + std::to_string(Tlen - MAX_DIFF_SHOW)
+			           + "个字符...\x1b[0m";
 		} else {
 			// 全部输出
-			m_TestERRStr += "\x1b[1;37;41m" + testAns + "\x1b[0m";
+			diffMsg += "\x1b[1;37;41m" + testAns + "\x1b[0m";
 		}
 		return false;
 	} else if (isTEmpty) {
-		m_TestERRStr = "标准答案: \n";
+		diffMsg = "标准答案: \n";
 		if (Alen > MAX_DIFF_SHOW_MAX) {
 			// 差异部分过长
-			m_TestERRStr += stdAns.substr(0, MAX_DIFF_SHOW) + "\x1b[1;37;100m..."
-			                "还有" + std::to_string(Alen - MAX_DIFF_SHOW)
-			                + "个字符...\x1b[0m";
+			diffMsg += stdAns.substr(0, MAX_DIFF_SHOW) + "\x1b[1;37;100m..."
+			           "还有" + std::to_string(Alen - MAX_DIFF_SHOW)
+			           + "个字符...\x1b[0m";
 		} else {
 			// 全部输出
-			m_TestERRStr += "\x1b[1;37;41m" + stdAns + "\x1b[0m";
+			diffMsg += "\x1b[1;37;41m" + stdAns + "\x1b[0m";
 		}
-		m_TestERRStr += "\n程序输出：\n\x1b[1;37;41m   空   \x1b[0m";
+		diffMsg += "\n程序输出：\n\x1b[1;37;41m   空   \x1b[0m";
 		return false;
 	}
 	// 都不为空
@@ -222,7 +436,7 @@ bool testStringCmp(const std::string& stdAns, const std::string& testAns) {
 	while (i < Alen && i < Tlen) {
 		if (stdAns[i] != testAns[i]) {
 			// 中间WA了
-			genDiffMsg(stdAns, testAns, i);
+			genDiffMsg(stdAns, testAns, i, diffMsg);
 			return false;
 		}
 		++i;
@@ -231,108 +445,113 @@ bool testStringCmp(const std::string& stdAns, const std::string& testAns) {
 		return true; // 说明完全一致
 	}
 	// 尾部异常
-	genDiffMsg(stdAns, testAns, i);
+	genDiffMsg(stdAns, testAns, i, diffMsg);
 	return false;
 }
 
 // 去除末尾空格
 void trim(std::string& str) {
-	int endi = str.length() - 1;
-	while (endi >= 0) {
-		if (str[endi] == ' ') {
-			str.erase(endi, 1);
-			--endi;
-		} else {
-			return;
-		}
-	}
+	str.resize(getTrimmedLen(str.data(), str.data() + str.size()));
 }
 
-// 比较标准答案和程序输出的区别，返回是否正确
-// 如果不正确会将差异以人类可读形式写在m_TestERRStr里面
-bool compareAnsStr(const std::string &stdansStr,
-                   const std::string &myansStr, bool isStrict = false) {
-	std::istringstream standardStream(stdansStr);
-	std::istringstream testStream(myansStr);
-
-	int lencnt = 0;
-	std::string standardLine, testLine;
-	bool isStdAnsOK = !std::getline(standardStream, standardLine).fail();
-	bool isTestAnsOK = !std::getline(testStream, testLine).fail();
-	while (isStdAnsOK && isTestAnsOK) {
-		++lencnt;
-		if (isStrict) {
-			if (!testStringCmp(standardLine, testLine)) {
-				// 不一致
-				m_TestERRStr = "第一处差异在第" + std::to_string(lencnt)
-				               + "行\n" + m_TestERRStr;
-				return false;
-			}
-		} else {
-			// 去尾空格
-			trim(standardLine);
-			trim(testLine);
-			if (!testStringCmp(standardLine, testLine)) {
-				// 不一致
-				m_TestERRStr = "第一处差异在第" + std::to_string(lencnt)
-				               + "行\n" + m_TestERRStr;
-				return false;
-			}
-		}
-		isStdAnsOK = !std::getline(standardStream, standardLine).fail();
-		isTestAnsOK = !std::getline(testStream, testLine).fail();
+// 程序输出缺失了行时，生成差异信息到diffMsg里面
+// standardLine为标准答案中第一个缺失的行，diffLine为其行号
+void genLackLineMsg(const std::string& standardLine, long long diffLine,
+                    long long ansLineCnt, long long testLineCnt, std::string& diffMsg) {
+	diffMsg = "第一处差异在第" + std::to_string(diffLine)
+	          + "行\n标准答案: \n";
+	int ALen = standardLine.length();
+	if (ALen > MAX_DIFF_SHOW_MAX) {
+		diffMsg += standardLine.substr(0, MAX_DIFF_SHOW)
+		           + "\x1b[1;37;100m...还有"
+		           + std::to_string(ALen - MAX_DIFF_SHOW)
+		           + "个字符...\x1b[0m";
+	} else {
+		diffMsg += standardLine;
 	}
+	diffMsg += "\n程序输出：\n\x1b[1;37;41m   空   \x1b[0m\n";
+	diffMsg += "标准答案共" + std::to_string(ansLineCnt)
+	           + "行，程序输出共" + std::to_string(testLineCnt) + "行";
+}
 
-	// 检查两个输出是否同时到达结尾
-	if (!isStdAnsOK && !isTestAnsOK) {
-		// 一致
-		return true;
+// 程序输出多余了行时，生成差异信息到diffMsg里面
+// testLine为程序输出中第一个多余的行，diffLine为其行号
+// isTestCntLowerBound表示程序输出没有读完，testLineCnt只是下限
+void genExtraLineMsg(const std::string& testLine, long long diffLine,
+                     long long ansLineCnt, long long testLineCnt, std::string& diffMsg,
+                     bool isTestCntLowerBound = false) {
+	diffMsg = "第一处差异在第" + std::to_string(diffLine)
+	          + "行\n标准答案: \n\x1b[1;37;100m   空   \x1b[0m\n程序输出：\n";
+	int Tlen = testLine.length();
+	if (Tlen > MAX_DIFF_SHOW_MAX) {
+		diffMsg += "\x1b[1;37;41m" + testLine.substr(0, MAX_DIFF_SHOW)
+		           + "\x1b[0m\x1b[1;37;100m..."
+		           "还多余" + std::to_string(Tlen - MAX_DIFF_SHOW)
+		           + "个字符...\x1b[0m";
+	} else {
+		diffMsg += "\x1b[1;37;41m" + testLine + "\x1b[0m\n";
 	}
+	diffMsg += "标准答案共" + std::to_string(ansLineCnt)
+	           + (isTestCntLowerBound ? "行，程序输出至少" : "行，程序输出共")
+	           + std::to_string(testLineCnt) + "行";
+}
 
-	int difflen = lencnt + 1;
-	if (isStdAnsOK) {
-		// 程序输出缺失了行
-		int testAllLenCnt = lencnt;
-		std::string tmp;
-		++lencnt;
-		while (!std::getline(standardStream, tmp).fail()) {
-			++lencnt;
+// 比较标准答案和程序输出的区别，返回是否正确
+// 按行比较，\r\n与\r视为\n，非严格模式下忽略行末空格，末尾的单个换行不影响结果
+// 不需要事先统一换行符，也不复制行：两边逐字节相同的部分用memcmp整段跳过，
+// 只在不同处逐行比较，行号与差异信息也只在确定不一致后生成
+// 如果不正确会将差异以人类可读形式写在diffMsg里面
+bool compareAnsStr(std::string_view stdansStr, std::string_view myansStr,
+                   std::string& diffMsg, bool isStrict = false) {
+	const char* aBegin = stdansStr.data();
+	const char* aPos = aBegin;
+	const char* aEnd = aBegin + stdansStr.size();
+	const char* tPos = myansStr.data();
+	const char* tEnd = tPos + myansStr.size();
+	while (true) {
+		size_t sameLen = getCommonPrefixLen(aPos, aEnd - aPos, tPos, tEnd - tPos);
+		if (aPos + sameLen == aEnd && tPos + sameLen == tEnd) {
+			// 一致
+			return true;
 		}
-		m_TestERRStr = "第一处差异在第" + std::to_string(difflen)
-		               + "行\n标准答案: \n";
-		int ALen = standardLine.length();
-		if (ALen > MAX_DIFF_SHOW_MAX) {
-			m_TestERRStr += standardLine.substr(0, MAX_DIFF_SHOW)
-			                + "\x1b[1;37;100m...还有"
-			                + std::to_string(ALen - MAX_DIFF_SHOW)
-			                + "个字符...\x1b[0m";
-		} else {
-			m_TestERRStr += standardLine;
+		// 退回到相同部分中最后一个\n之后，两边都位于行首
+		size_t skipLen = sameLen;
+		while (skipLen > 0 && aPos[skipLen - 1] != '\n') {
+			--skipLen;
 		}
-		m_TestERRStr += "\n程序输出：\n\x1b[1;37;41m   空   \x1b[0m\n";
-		m_TestERRStr += "标准答案共" + std::to_string(lencnt)
-		                + "行，程序输出共" + std::to_string(testAllLenCnt) + "行";
-	} else {
-		// 程序输出多余了行
-		int ansAllLenCnt = lencnt;
-		std::string tmp;
-		++lencnt;
-		while (!std::getline(testStream, tmp).fail()) {
-			++lencnt;
+		aPos += skipLen;
+		tPos += skipLen;
+		if (aPos == aEnd || tPos == tEnd) {
+			break;
 		}
-		m_TestERRStr = "第一处差异在第" + std::to_string(difflen)
-		               + "行\n标准答案: \n\x1b[1;37;100m   空   \x1b[0m\n程序输出：\n";
-		int Tlen = testLine.length();
-		if (Tlen > MAX_DIFF_SHOW_MAX) {
-			m_TestERRStr += "\x1b[1;37;41m" + testLine.substr(0, MAX_DIFF_SHOW)
-			                + "\x1b[0m\x1b[1;37;100m..."
-			                "还多余" + std::to_string(Tlen - MAX_DIFF_SHOW)
-			                + "个字符...\x1b[0m";
-		} else {
-			m_TestERRStr += "\x1b[1;37;41m" + testLine + "\x1b[0m\n";
+		// 逐行比较不同处所在的行
+		const char* aLineEnd = findLineEnd(aPos, aEnd);
+		const char* tLineEnd = findLineEnd(tPos, tEnd);
+		size_t aLen = isStrict ? aLineEnd - aPos : getTrimmedLen(aPos, aLineEnd);
+		size_t tLen = isStrict ? tLineEnd - tPos : getTrimmedLen(tPos, tLineEnd);
+		if (aLen != tLen || memcmp(aPos, tPos, aLen) != 0) {
+			// 不一致
+			testStringCmp(std::string(aPos, aLen), std::string(tPos, tLen), diffMsg);
+			diffMsg = "第一处差异在第" + std::to_string(countLines(aBegin, aPos) + 1)
+			          + "行\n" + diffMsg;
+			return false;
 		}
-		m_TestERRStr += "标准答案共" + std::to_string(ansAllLenCnt)
-		                + "行，程序输出共" + std::to_string(lencnt) + "行";
+		aPos = skipLineBreak(aLineEnd, aEnd);
+		tPos = skipLineBreak(tLineEnd, tEnd);
+	}
+
+	// 两边已经比较过的行数相同，其中一边没有行了
+	long long lencnt = countLines(aBegin, aPos);
+	if (aPos != aEnd) {
+		// 程序输出缺失了行
+		std::string standardLine(aPos, findLineEnd(aPos, aEnd));
+		genLackLineMsg(standardLine, lencnt + 1, lencnt + countLines(aPos, aEnd),
+		               lencnt, diffMsg);
+	} else {
+		// 程序输出多余了行
+		std::string testLine(tPos, findLineEnd(tPos, tEnd));
+		genExtraLineMsg(testLine, lencnt + 1, lencnt, lencnt + countLines(tPos, tEnd),
+		                diffMsg);
 	}
 	return false;
 }
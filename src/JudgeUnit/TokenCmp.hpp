@@ -0,0 +1,198 @@
+/**
+ * \file    	TokenCmp.hpp
+ * \author  	XY0797
+ * \date    	2026.10.17
+ * \brief		按单词比较程序输出与标准答案，忽略空白字符的差异，浮点数可以有误差
+ */
+#ifndef _XY0797_TOKENCMP
+#define _XY0797_TOKENCMP 1
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include "TestStringCmp.hpp"
+
+// 能按浮点数比较的单词的最大长度，更长的单词只按字符比较
+const size_t TOKEN_NUMBER_MAX_LEN = 64;
+
+// 浮点数比较的容许误差，两项都为0时单词必须完全一致
+struct TokenCmpEps {
+	// 绝对误差
+	double absEps = 0;
+	// 相对误差(相对于标准答案)
+	double relEps = 0;
+};
+
+// 空白字符：空格、\t、\n、\v、\f、\r
+bool isTokenSpace(char ch) {
+	return ch == ' ' || static_cast<unsigned char>(ch - '\t') < 5;
+}
+
+#ifdef _XY0797_STRCMP_SSE2
+// 16个字节中空白字符的位掩码
+unsigned int getSpaceMask(__m128i v) {
+	__m128i isBlank = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+	// \t到\r是连续的5个字符，均小于0x80，有符号比较即可
+	__m128i isCtrl = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+	                               _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+	return static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(isBlank, isCtrl)));
+}
+#endif
+
+// 从p开始找到第一个满足isSpace == wantSpace的字符，找不到返回end
+// 支持SSE2时每次检查16个字节
+const char* scanTokenSpace(const char* p, const char* end, bool wantSpace) {
+#ifdef _XY0797_STRCMP_SSE2
+	unsigned int flipMask = wantSpace ? 0u : 0xFFFFu;
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		unsigned int mask = getSpaceMask(v) ^ flipMask;
+		if (mask != 0) {
+			return p + lowestBitIndex(mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && isTokenSpace(*p) != wantSpace) {
+		++p;
+	}
+	return p;
+}
+
+// 把单词解析为浮点数，整个单词都是数字才算成功
+bool parseTokenNumber(std::string_view token, double& value) {
+	if (token.empty() || token.size() > TOKEN_NUMBER_MAX_LEN) {
+		return false;
+	}
+	// strtod需要以\0结尾，单词很短，复制到栈上即可
+	char buffer[TOKEN_NUMBER_MAX_LEN + 1];
+	memcpy(buffer, token.data(), token.size());
+	buffer[token.size()] = 0;
+	char* parseEnd;
+	value = strtod(buffer, &parseEnd);
+	return parseEnd == buffer + token.size();
+}
+
+// 两个单词是否相等，浮点数按容许误差比较
+bool isTokenEqual(std::string_view stdToken, std::string_view testToken,
+                  const TokenCmpEps& eps) {
+	if (stdToken == testToken) {
+		return true;
+	}
+	if (eps.absEps <= 0 && eps.relEps <= 0) {
+		return false;
+	}
+	double expected, found;
+	if (!parseTokenNumber(stdToken, expected) || !parseTokenNumber(testToken, found)) {
+		return false;
+	}
+	if (std::isnan(expected) || std::isnan(found)) {
+		return std::isnan(expected) && std::isnan(found);
+	}
+	if (std::isinf(expected) || std::isinf(found)) {
+		return expected == found;
+	}
+	double diff = std::fabs(expected - found);
+	return diff <= eps.absEps || diff <= eps.relEps * std::fabs(expected);
+}
+
+// 单词过长时截断显示
+std::string getTokenShowStr(std::string_view token) {
+	if (token.size() > static_cast<size_t>(MAX_DIFF_SHOW_MAX)) {
+		return std::string(token.substr(0, MAX_DIFF_SHOW)) + "\x1b[1;37;100m...还有"
+		       + std::to_string(token.size() - MAX_DIFF_SHOW) + "个字符...\x1b[0m";
+	}
+	return std::string(token);
+}
+
+// 计算位置所在的行号，只在生成差异信息时调用
+long long getTokenLineNum(std::string_view str, size_t pos) {
+	return 1 + std::count(str.begin(), str.begin() + std::min(pos, str.size()), '\n');
+}
+
+// 统计一段文本中的单词数
+long long countTokens(const char* p, const char* end) {
+	long long cnt = 0;
+	while ((p = scanTokenSpace(p, end, false)) != end) {
+		++cnt;
+		p = scanTokenSpace(p, end, true);
+	}
+	return cnt;
+}
+
+// 按单词比较标准答案和程序输出，返回是否正确
+// 单词之间的空白字符种类与数量不影响结果，两项误差都为0时单词必须完全一致
+// 比较过程中不分配内存，如果不正确会将差异以人类可读形式写在diffMsg里面
+// 两边逐字节相同的部分切分出的单词也相同，整段跳过，只在不同处逐个单词比较
+// 单词序号与行号只在生成差异信息时统计
+bool compareTokens(std::string_view stdAns, std::string_view testAns,
+                   const TokenCmpEps& eps, std::string& diffMsg) {
+	const char* aBegin = stdAns.data();
+	const char* aPos = aBegin;
+	const char* aEnd = aPos + stdAns.size();
+	const char* tBegin = testAns.data();
+	const char* tPos = tBegin;
+	const char* tEnd = tPos + testAns.size();
+	while (true) {
+		size_t sameLen = getCommonPrefixLen(aPos, aEnd - aPos, tPos, tEnd - tPos);
+		if (aPos + sameLen == aEnd && tPos + sameLen == tEnd) {
+			return true;
+		}
+		// 退回到单词的边界，跨过相同部分末尾的单词仍需比较
+		size_t skipLen = sameLen;
+		while (skipLen > 0 && !isTokenSpace(aPos[skipLen - 1])) {
+			--skipLen;
+		}
+		aPos = scanTokenSpace(aPos + skipLen, aEnd, false);
+		tPos = scanTokenSpace(tPos + skipLen, tEnd, false);
+		if (aPos == aEnd || tPos == tEnd) {
+			break;
+		}
+		const char* aTokenEnd = scanTokenSpace(aPos, aEnd, true);
+		const char* tTokenEnd = scanTokenSpace(tPos, tEnd, true);
+		std::string_view stdToken(aPos, aTokenEnd - aPos);
+		std::string_view testToken(tPos, tTokenEnd - tPos);
+		if (!isTokenEqual(stdToken, testToken, eps)) {
+			diffMsg = "第" + std::to_string(countTokens(aBegin, aPos) + 1)
+			          + "个单词不同(标准答案第"
+			          + std::to_string(getTokenLineNum(stdAns, aPos - aBegin))
+			          + "行，程序输出第"
+			          + std::to_string(getTokenLineNum(testAns, tPos - tBegin))
+			          + "行)\n标准答案: \n" + getTokenShowStr(stdToken)
+			          + "\n程序输出：\n\x1b[1;37;41m" + getTokenShowStr(testToken) + "\x1b[0m";
+			return false;
+		}
+		aPos = aTokenEnd;
+		tPos = tTokenEnd;
+	}
+	if (aPos == aEnd && tPos == tEnd) {
+		return true;
+	}
+	// 单词数量不同，统计双方的单词总数
+	long long tokenCnt = countTokens(aBegin, aPos);
+	long long ansTokenCnt = tokenCnt + countTokens(aPos, aEnd);
+	long long testTokenCnt = tokenCnt + countTokens(tPos, tEnd);
+	if (aPos != aEnd) {
+		std::string_view stdToken(aPos, scanTokenSpace(aPos, aEnd, true) - aPos);
+		diffMsg = "程序输出缺少单词，第一个缺少的是第" + std::to_string(tokenCnt + 1)
+		          + "个单词(标准答案第"
+		          + std::to_string(getTokenLineNum(stdAns, aPos - aBegin))
+		          + "行)\n标准答案: \n" + getTokenShowStr(stdToken)
+		          + "\n程序输出：\n\x1b[1;37;41m   空   \x1b[0m\n";
+	} else {
+		std::string_view testToken(tPos, scanTokenSpace(tPos, tEnd, true) - tPos);
+		diffMsg = "程序输出多余单词，第一个多余的是第" + std::to_string(tokenCnt + 1)
+		          + "个单词(程序输出第"
+		          + std::to_string(getTokenLineNum(testAns, tPos - tBegin))
+		          + "行)\n标准答案: \n\x1b[1;37;100m   空   \x1b[0m\n程序输出：\n\x1b[1;37;41m"
+		          + getTokenShowStr(testToken) + "\x1b[0m\n";
+	}
+	diffMsg += "标准答案共" + std::to_string(ansTokenCnt)
+	           + "个单词，程序输出共" + std::to_string(testTokenCnt) + "个单词";
+	return false;
+}
+
+#endif /* _XY0797_TOKENCMP */
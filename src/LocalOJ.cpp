@@ -4,13 +4,31 @@
  * \date    	2024.8.6
  * \brief		程序入口
  */
+#ifdef _WIN32
+// winsock2.h必须在windows.h之前包含，否则windows.h引入的旧版winsock.h会与其冲突
+#include <winsock2.h>
+#endif
 #include <iostream>
 #include <string>
 #include <vector>
 #include <exception>
+#include <stdexcept>
 #include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <numeric>
+#include <memory>
 #include "ArtFont.hpp"
+#include "JudgeOptions.hpp"
 #include "JudgeUnit/Judge.hpp"
+#include "JudgeUnit/JudgePool.hpp"
+#include "JudgeUnit/BenchStats.hpp"
+#include "JudgeUnit/JudgeCache.hpp"
+#include "JudgeUnit/TestSet.hpp"
+#include "JudgeUnit/JudgeDaemon.hpp"
+#include "JudgeUnit/JudgeWorker.hpp"
+#include "JudgeUnit/JudgeCluster.hpp"
 #include "WindowsFileSysTool.hpp"
 #include "EnableWindowsConsoleColor.hpp"
 
@@ -26,14 +44,38 @@ int getNumBits(int num) {
 	return bits;
 }
 
+// 去除拖进终端的路径两侧的引号
+// Windows终端使用双引号，Linux终端使用单引号并可能在末尾附加空格
+void stripPathQuotes(std::string& path) {
+	while (!path.empty() && path.back() == ' ') {
+		path.pop_back();
+	}
+	if (path.size() >= 2 && (path[0] == '"' || path[0] == '\'')
+	        && path.back() == path[0]) {
+		path.pop_back();
+		path.erase(path.begin());
+	}
+}
+
 std::string m_TestCaseExtension = ".in";
 std::string m_AnsExtension = ".out";
 
+// 输入文件对应的答案文件
 std::string getAnsFilePath(const std::string& testCaseFilePath) {
-	size_t i1 = testCaseFilePath.rfind(m_TestCaseExtension);
-	return testCaseFilePath.substr(0, i1) + m_AnsExtension;
+	return getAnsFilePathOf(testCaseFilePath, m_TestCaseExtension, m_AnsExtension);
 }
 
+// A/B对比模式下程序B的结果，程序A的结果保存在JudgeInfo本身
+struct ABResult {
+	// 程序B最后一次运行的统计
+	RunStats stats;
+	// 程序B多次运行的CPU时间与真实时间统计(us)
+	SampleStats benchCPU;
+	SampleStats benchWall;
+	// 两个程序CPU用时差异的显著性(双侧p值)
+	double pValue = 1;
+};
+
 struct JudgeInfo {
 	// 测试集输入文件的全路径
 	std::string fullTestCasePath;
@@ -45,15 +87,26 @@ struct JudgeInfo {
 	int timeLimit;
 	// 测试集输入文件的文件名
 	std::string name;
-	// 文件名是否为纯数字
-	bool isNumName;
-	// 文件名如果是数字，这里存储数字值
-	long long NumName;
 	// 评测结果ID
-	// 1：未评测，0：AC，-1：启动失败，-2：WA，-3：TLE
+	// 1：未评测，0：AC，-1：启动失败，-2：WA，-3：TLE，-4：OLE，-5：MLE
 	int resID;
 	// 评测的结果信息
 	std::string ERRmsg;
+	// 程序消耗的CPU时间、真实时间与峰值内存
+	RunStats stats;
+	// 基准测试模式下多次运行的CPU时间与真实时间统计(us)
+	SampleStats benchCPU;
+	SampleStats benchWall;
+	// A/B对比模式下程序B的结果
+	ABResult ab;
+	// checker消耗的资源，未运行checker时为0
+	RunStats checkerStats;
+	// 等待checker检查的输出临时文件，为空表示没有待检查的输出
+	std::string outputFilePath;
+	// 评测结果缓存的键，为空表示不使用缓存
+	std::string cacheKey;
+	// 结果是否直接取自缓存
+	bool isCached = false;
 
 	// 传入.in文件的完整路径
 	JudgeInfo(const std::string& TestCaseFileFullPath,
@@ -62,91 +115,948 @@ struct JudgeInfo {
 		  fullAnsPath(getAnsFilePath(TestCaseFileFullPath)),
 		  exeFilePath(ExeFileFullPath),
 		  timeLimit(TimeLimit),
-		  name(winfs::getNonExtenFileName(TestCaseFileFullPath)),
-		  isNumName(false),
-		  resID(1) {
-		// 检测数字文件名
-		for (char ch : name) {
-			if (ch >= '0' && ch <= '9') {
-				isNumName = true;
+		  name(getTestCaseName(TestCaseFileFullPath)),
+		  resID(1) {}
+	// 用于排序
+	bool operator<(const JudgeInfo& o) const {
+		return isCaseNameLess(name, o.name);
+	}
+};
+
+std::vector<JudgeInfo> m_JudgeInfoList;
+
+// 指定--checker-lib时加载的checker插件
+CheckerPlugin m_CheckerPlugin;
+
+// 指定--digest时使用的标准答案摘要索引
+AnsDigestIndex m_AnsDigestIndex;
+
+// 评测结果缓存，总是读取以便按上一次的结果调度
+JudgeCache m_JudgeCache;
+
+// 是否使用并更新评测结果缓存，基准测试、A/B对比与统计性能计数器时不使用
+bool m_IsCacheEnabled = false;
+
+// 是否直接使用缓存中的结果，只在重复上一次的评测且未指定--force时使用
+bool m_IsCacheReused = false;
+
+// 缓存键中与样例无关的部分
+std::string m_CacheBaseStr;
+
+// 批量评测的待测程序，输入的程序路径为文件夹时评测其中所有程序，为空表示只评测一个程序
+std::vector<std::string> m_BatchExeList;
+
+// 批量评测的结果，第i个程序的第j个样例位于i*样例数+j，样例的顺序与m_JudgeInfoList相同
+std::vector<JudgeInfo> m_BatchJudgeInfoList;
+
+// 批量评测时各样例预先读入的测试数据，与m_JudgeInfoList一一对应，读入失败的为空
+std::vector<std::unique_ptr<LoadedTestCase>> m_LoadedTestCases;
+
+// 指定--workers时评测样例的评测机集群
+JudgeCluster m_JudgeCluster;
+
+// 生成缓存键中与样例无关的部分：待测程序与checker的内容，以及影响结果的评测配置
+// 无法读取程序时抛出std::runtime_error
+std::string makeCacheBaseStr(const std::string& exeFilePath) {
+	std::string baseStr = formatHash64(calcFileHash64(exeFilePath))
+	                      + " ol=" + std::to_string(m_Options.outputLimitMB)
+	                      + " ml=" + std::to_string(m_Options.memoryLimitMB)
+	                      + " stream=" + std::to_string(m_Options.isStreamCmp)
+	                      + " line-diff=" + std::to_string(m_Options.isLineDiff)
+	                      + " pipe=" + std::to_string(m_Options.isPipeInput)
+	                      + " token=" + std::to_string(m_Options.isTokenCmp)
+	                      + " eps=" + std::to_string(m_Options.absEps)
+	                      + "," + std::to_string(m_Options.relEps);
+	if (!m_Options.checkerPath.empty()) {
+		baseStr += " checker=" + formatHash64(calcFileHash64(m_Options.checkerPath));
+	}
+	if (!m_Options.checkerLibPath.empty()) {
+		baseStr += " checker-lib=" + formatHash64(calcFileHash64(m_Options.checkerLibPath));
+	}
+	return baseStr;
+}
+
+// 测试数据在缓存键中的部分：路径、大小与修改时间
+// 不读取文件内容，未命中缓存的评测不会因此多读一遍测试数据，无法获取时抛出std::runtime_error
+std::string getTestDataKeyStr(const std::string& path) {
+	std::string stamp = getTestDataStamp(path);
+	if (stamp.compare(0, 3, "-1:") == 0) {
+		throw std::runtime_error("无法获取测试数据的修改时间：" + path);
+	}
+	return path + "@" + stamp;
+}
+
+// 生成样例的缓存键，由输入与答案的文件信息、限时以及与样例无关的部分决定
+std::string getCacheKey(const JudgeInfo& e) {
+	std::string keyStr = m_CacheBaseStr
+	                     + " in=" + getTestDataKeyStr(e.fullTestCasePath)
+	                     + " ans=" + getTestDataKeyStr(e.fullAnsPath)
+	                     + " tl=" + std::to_string(e.timeLimit);
+	return formatHash64(calcHash64(keyStr));
+}
+
+// 计算样例的缓存键，命中缓存时直接使用上一次的结果并返回true
+bool applyCachedResult(JudgeInfo& e) {
+	try {
+		e.cacheKey = getCacheKey(e);
+	} catch (const std::exception& ex) {
+		// 文件不存在时正常评测，由评测报告错误
+		return false;
+	}
+	CachedResult result;
+	if (!m_IsCacheReused || !m_JudgeCache.find(e.cacheKey, result)) {
+		return false;
+	}
+	e.resID = result.resID;
+	e.ERRmsg = result.resMsg;
+	e.stats = result.stats;
+	e.checkerStats = result.checkerStats;
+	e.isCached = true;
+	return true;
+}
+
+// 记录样例的评测结果
+void recordCachedResult(const JudgeInfo& e) {
+	if (e.cacheKey.empty() || e.resID == 1) {
+		return;
+	}
+	CachedResult result;
+	result.casePath = e.fullTestCasePath;
+	result.resID = e.resID;
+	result.resMsg = e.ERRmsg;
+	result.stats.cpuTimeUs = e.stats.cpuTimeUs;
+	result.stats.wallTimeUs = e.stats.wallTimeUs;
+	result.stats.peakMemory = e.stats.peakMemory;
+	result.checkerStats.cpuTimeUs = e.checkerStats.cpuTimeUs;
+	result.checkerStats.wallTimeUs = e.checkerStats.wallTimeUs;
+	m_JudgeCache.update(e.cacheKey, result);
+}
+
+// 按命令行选项生成与样例无关的评测配置
+TestConfig makeBaseTestConfig() {
+	TestConfig config;
+	// 按行对齐需要完整的输出，不能提前结束WA的程序
+	config.isStreamCmp = m_Options.isStreamCmp && !m_Options.isLineDiff;
+	config.isLineDiff = m_Options.isLineDiff;
+	config.outputLimit = m_Options.outputLimitMB * 1024ll * 1024ll;
+	config.isFileInput = !m_Options.isPipeInput;
+	config.isPerf = m_Options.isPerf;
+	config.checkerPath = m_Options.checkerPath;
+	config.isTokenCmp = m_Options.isTokenCmp;
+	config.eps.absEps = m_Options.absEps;
+	config.eps.relEps = m_Options.relEps;
+	if (m_CheckerPlugin.isLoaded()) {
+		config.checkerPlugin = &m_CheckerPlugin;
+	}
+	if (m_AnsDigestIndex.isLoaded()) {
+		config.digestIndex = &m_AnsDigestIndex;
+	}
+	if (m_Options.memoryLimitMB > 0) {
+		config.memoryLimit = m_Options.memoryLimitMB * 1024ll * 1024ll;
+	}
+	return config;
+}
+
+// 生成单个样例的评测配置
+TestConfig makeTestConfig(const JudgeInfo& e, int cpuIndex) {
+	TestConfig config = makeBaseTestConfig();
+	config.timeLimit = e.timeLimit;
+	config.cpuIndex = cpuIndex;
+	return config;
+}
+
+// 运行一次样例，返回评测结果ID
+int runOnce(const JudgeInfo& e, const TestConfig& config,
+            std::string& resMsg, RunStats& stats) {
+	try {
+		return runTest(e.fullTestCasePath, e.fullAnsPath,
+		               e.exeFilePath, config, resMsg, stats);
+	} catch (const std::exception& ex) {
+		resMsg = std::string("评测时遇到异常：") + ex.what();
+		return -1;
+	}
+}
+
+// 对已经AC的样例进行基准测试：预热后计时运行多次并统计
+// 任何一次运行未通过都会改为该次的评测结果
+void benchOne(JudgeInfo& e, const TestConfig& config) {
+	std::vector<long long> cpuSamples, wallSamples;
+	std::string resMsg;
+	RunStats stats;
+	int totalRuns = m_Options.benchWarmup + m_Options.benchRuns;
+	for (int i = 0; i < totalRuns; ++i) {
+		int resID = runOnce(e, config, resMsg, stats);
+		if (resID != 0) {
+			e.resID = resID;
+			e.ERRmsg = "基准测试的第" + std::to_string(i + 1) + "次运行未通过：\n" + resMsg;
+			e.stats = stats;
+			return;
+		}
+		if (i >= m_Options.benchWarmup) {
+			cpuSamples.push_back(stats.cpuTimeUs);
+			wallSamples.push_back(stats.wallTimeUs);
+			e.stats.peakMemory = std::max(e.stats.peakMemory, stats.peakMemory);
+			// 性能计数器取最后一次运行的值
+			e.stats.perf = stats.perf;
+		}
+	}
+	e.benchCPU = calcSampleStats(cpuSamples);
+	e.benchWall = calcSampleStats(wallSamples);
+}
+
+// 未指定--bench时A/B对比模式每个程序的计时运行次数
+const int AB_DEFAULT_RUNS = 10;
+
+// A/B对比单个样例：两个程序都AC后，在同一核心上按ABBA顺序交替运行
+// 交替运行使机器状态的缓慢变化对两个程序的影响相互抵消
+void abOne(JudgeInfo& e, const TestConfig& config) {
+	JudgeInfo eB = e;
+	eB.exeFilePath = m_Options.abExePath;
+	std::string resMsg;
+	RunStats stats;
+	// 先确认两个程序都能AC
+	e.resID = runOnce(e, config, resMsg, e.stats);
+	if (e.resID != 0) {
+		e.ERRmsg = "程序A：" + resMsg;
+		return;
+	}
+	e.resID = runOnce(eB, config, resMsg, e.ab.stats);
+	if (e.resID != 0) {
+		e.ERRmsg = "程序B：" + resMsg;
+		return;
+	}
+	int runs = m_Options.benchRuns > 0 ? m_Options.benchRuns : AB_DEFAULT_RUNS;
+	std::vector<long long> cpuA, wallA, cpuB, wallB;
+	for (int i = 0; i < m_Options.benchWarmup + runs; ++i) {
+		bool isMeasured = i >= m_Options.benchWarmup;
+		for (int k = 0; k < 2; ++k) {
+			bool isA = (k == 0) == (i % 2 == 0);
+			JudgeInfo& cur = isA ? e : eB;
+			int resID = runOnce(cur, config, resMsg, stats);
+			if (resID != 0) {
+				e.resID = resID;
+				e.ERRmsg = std::string(isA ? "程序A" : "程序B") + "的第"
+				           + std::to_string(i + 1) + "轮运行未通过：\n" + resMsg;
+				return;
+			}
+			if (isMeasured) {
+				(isA ? cpuA : cpuB).push_back(stats.cpuTimeUs);
+				(isA ? wallA : wallB).push_back(stats.wallTimeUs);
+			}
+		}
+	}
+	e.benchCPU = calcSampleStats(cpuA);
+	e.benchWall = calcSampleStats(wallA);
+	e.ab.benchCPU = calcSampleStats(cpuB);
+	e.ab.benchWall = calcSampleStats(wallB);
+	e.ab.pValue = calcMannWhitneyP(cpuA, cpuB);
+}
+
+// 使用checker时只运行待测程序，输出保存在临时文件中留给checkOne检查
+void runSolutionOnce(JudgeInfo& e, const TestConfig& config) {
+	try {
+		e.resID = runSolution(e.fullTestCasePath, e.exeFilePath, config,
+		                      e.ERRmsg, e.stats, e.outputFilePath);
+	} catch (const std::exception& ex) {
+		e.ERRmsg = std::string("评测时遇到异常：") + ex.what();
+		e.resID = -1;
+	}
+}
+
+// 用checker检查待测程序的输出，在检查线程中执行，与后续样例的运行重叠
+void checkOne(JudgeInfo& e) {
+	if (e.outputFilePath.empty()) {
+		return;
+	}
+	try {
+		e.resID = runChecker(m_Options.checkerPath, e.fullTestCasePath, e.outputFilePath,
+		                     e.fullAnsPath, e.ERRmsg, e.checkerStats);
+	} catch (const std::exception& ex) {
+		e.ERRmsg = std::string("运行checker时遇到异常：") + ex.what();
+		e.resID = -1;
+	}
+	std::remove(e.outputFilePath.c_str());
+	e.outputFilePath.clear();
+}
+
+// 评测单个样例，在工作线程中执行
+void judgeOne(JudgeInfo& e, int cpuIndex) {
+	if (m_IsCacheEnabled && applyCachedResult(e)) {
+		return;
+	}
+	TestConfig config = makeTestConfig(e, cpuIndex);
+	if (!m_Options.abExePath.empty()) {
+		abOne(e, config);
+		return;
+	}
+	if (!m_Options.checkerPath.empty()) {
+		runSolutionOnce(e, config);
+		// 基准测试需要先确定AC，只能直接检查
+		if (e.resID == 0 && m_Options.benchRuns > 0) {
+			checkOne(e);
+			if (e.resID == 0) {
+				benchOne(e, config);
+			}
+		}
+		return;
+	}
+	e.resID = runOnce(e, config, e.ERRmsg, e.stats);
+	if (e.resID == 0 && m_Options.benchRuns > 0) {
+		benchOne(e, config);
+	}
+}
+
+// 由评测机集群评测单个样例，在工作线程中执行
+void judgeRemoteOne(JudgeInfo& e) {
+	if (m_IsCacheEnabled && applyCachedResult(e)) {
+		return;
+	}
+	try {
+		e.resID = m_JudgeCluster.judge(e.fullTestCasePath, e.fullAnsPath, e.exeFilePath,
+		                               makeTestConfig(e, -1), e.ERRmsg, e.stats);
+	} catch (const std::exception& ex) {
+		e.ERRmsg = std::string("评测时遇到异常：") + ex.what();
+		e.resID = -1;
+	}
+}
+
+// 是否有基准测试结果
+bool hasBenchStats(const JudgeInfo& e) {
+	return e.resID == 0 && e.benchWall.cnt > 0;
+}
+
+// 基准测试结果是否波动过大
+bool isBenchUnstable(const JudgeInfo& e) {
+	return hasBenchStats(e) && (e.benchCPU.isUnstable() || e.benchWall.isUnstable());
+}
+
+// 生成一组耗时统计的信息
+std::string getSampleStatsMsg(const SampleStats& st) {
+	return "最小 " + formatTimeUs(st.min)
+	       + "  中位数 " + formatTimeUs(st.median)
+	       + "  p95 " + formatTimeUs(st.p95)
+	       + "  标准差 " + formatTimeUs(std::llround(st.stddev))
+	       + (st.isUnstable() ? "  \x1b[1;31m波动过大\x1b[22;0m" : "");
+}
+
+// A/B对比模式下程序B相对程序A的加速比(CPU用时中位数之比)
+double getABSpeedup(const JudgeInfo& e) {
+	if (e.ab.benchCPU.median <= 0) {
+		return 0;
+	}
+	return static_cast<double>(e.benchCPU.median)
+	       / static_cast<double>(e.ab.benchCPU.median);
+}
+
+// 生成A/B对比信息
+std::string getABMsg(const JudgeInfo& e) {
+	char speedupStr[32];
+	snprintf(speedupStr, sizeof(speedupStr), "%.3f", getABSpeedup(e));
+	return "A/B对比(各" + std::to_string(e.benchWall.cnt) + "次)：\n"
+	       "  程序A CPU用时 " + getSampleStatsMsg(e.benchCPU) + "\n"
+	       "  程序B CPU用时 " + getSampleStatsMsg(e.ab.benchCPU) + "\n"
+	       "  加速比(A/B) " + speedupStr + " " + getSignificanceMark(e.ab.pValue);
+}
+
+// 生成基准测试信息
+std::string getBenchMsg(const JudgeInfo& e) {
+	if (!m_Options.abExePath.empty()) {
+		return getABMsg(e);
+	}
+	return "基准测试(" + std::to_string(e.benchWall.cnt) + "次)：\n"
+	       "  CPU用时  " + getSampleStatsMsg(e.benchCPU) + "\n"
+	       "  真实用时 " + getSampleStatsMsg(e.benchWall) + "\n"
+	       "  峰值内存 " + formatMemory(e.stats.peakMemory)
+	       + (isBenchUnstable(e) ? "\n  \x1b[1;31m结果波动过大，不可信，"
+	          "请减少并行评测线程数或关闭其它程序后重试\x1b[22;0m" : "");
+}
+
+// 生成checker的用时信息，未运行checker时为空
+std::string getCheckerStatsMsg(const JudgeInfo& e) {
+	if (e.checkerStats.wallTimeUs <= 0) {
+		return "";
+	}
+	return "\ncheckerCPU用时：" + formatTimeUs(e.checkerStats.cpuTimeUs)
+	       + "，checker真实用时：" + formatTimeUs(e.checkerStats.wallTimeUs);
+}
+
+// 生成用时与内存信息
+std::string getStatsMsg(const JudgeInfo& e) {
+	return "CPU用时：" + formatTimeUs(e.stats.cpuTimeUs)
+	       + "，真实用时：" + formatTimeUs(e.stats.wallTimeUs)
+	       + "，峰值内存：" + formatMemory(e.stats.peakMemory)
+	       + getCheckerStatsMsg(e);
+}
+
+// 计数值转为文本，无法获取时为"不可用"
+std::string formatPerfCount(long long cnt) {
+	return cnt < 0 ? "不可用" : std::to_string(cnt);
+}
+
+// 生成性能计数器信息
+// IPC(每周期指令数)低且缓存未命中多说明程序受内存访问拖累，IPC高说明程序受计算量限制
+std::string getPerfMsg(const JudgeInfo& e) {
+	const PerfCounters& perf = e.stats.perf;
+	std::string ipcStr = "不可用";
+	if (perf.instructions >= 0 && perf.cycles > 0) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%.2f", static_cast<double>(perf.instructions)
+		         / static_cast<double>(perf.cycles));
+		ipcStr = buf;
+	}
+	return "性能计数器(仅用户态)：\n"
+	       "  指令数 " + formatPerfCount(perf.instructions)
+	       + "  周期数 " + formatPerfCount(perf.cycles) + "  IPC " + ipcStr + "\n"
+	       "  缓存未命中 " + formatPerfCount(perf.cacheMisses)
+	       + "  分支预测失败 " + formatPerfCount(perf.branchMisses) + "\n"
+	       "  缺页 " + formatPerfCount(perf.pageFaults)
+	       + "  上下文切换 " + formatPerfCount(perf.contextSwitches);
+}
+
+// 显示单个样例的评测结果，按排序后的顺序在主线程中执行
+void showJudgeOne(const JudgeInfo& e) {
+	std::cout << std::endl
+	          << "评测结果\x1b[1;37;44m "
+	          << e.name << m_TestCaseExtension << " \x1b[0m："
+	          << (e.isCached ? "(结果来自缓存)" : "") << std::endl;
+	// 1：未评测，0：AC，-1：启动失败，-2：WA，-3：TLE，-4：OLE，-5：MLE
+	switch (e.resID) {
+		case 0:
+			std::cout << artAC << std::endl;
+			if (!e.ERRmsg.empty()) {
+				std::cout << "checker信息：" << e.ERRmsg << std::endl;
+			}
+			if (hasBenchStats(e)) {
+				std::cout << getBenchMsg(e) << std::endl;
 			} else {
-				isNumName = false;
-				break;
+				std::cout << getStatsMsg(e) << std::endl;
+			}
+			break;
+		case -1:
+			std::cout << artStartFailed << std::endl;
+			std::cout << "报错信息：" << std::endl << e.ERRmsg << std::endl;
+			break;
+		case -2:
+			std::cout << artWA << std::endl;
+			std::cout << "错误原因：" << std::endl << e.ERRmsg << std::endl;
+			std::cout << getStatsMsg(e) << std::endl;
+			break;
+		case -3:
+			std::cout << artTLE << std::endl;
+			std::cout << std::endl << e.ERRmsg << std::endl;
+			std::cout << getStatsMsg(e) << std::endl;
+			break;
+		case -4:
+			std::cout << artOLE << std::endl;
+			std::cout << std::endl << e.ERRmsg << std::endl;
+			std::cout << getStatsMsg(e) << std::endl;
+			break;
+		case -5:
+			std::cout << artMLE << std::endl;
+			std::cout << std::endl << e.ERRmsg << std::endl;
+			std::cout << getStatsMsg(e) << std::endl;
+			break;
+	}
+}
+
+// 按调度策略生成样例的执行顺序，m_JudgeInfoList已经按文件名排序
+std::vector<size_t> getJudgeOrder() {
+	std::vector<size_t> order(m_JudgeInfoList.size());
+	std::iota(order.begin(), order.end(), 0);
+	if (m_Options.judgeOrder == ORDER_FAILED_FIRST) {
+		// 上一次未通过的样例最先，其次是没有记录的样例，最后是上一次AC的样例
+		std::vector<int> rank(order.size());
+		for (size_t i = 0; i < order.size(); ++i) {
+			int lastResID;
+			if (!m_JudgeCache.findLastResID(m_JudgeInfoList[i].fullTestCasePath, lastResID)) {
+				rank[i] = 1;
+			} else {
+				rank[i] = lastResID == 0 ? 2 : 0;
 			}
 		}
-		// 超longlong范围的不当成数字
-		if (isNumName) {
-			if (name.length() > 19) {
-				isNumName = false;
-			} else if (name.length() == 19) {
-				isNumName = (name[0] != '9');
+		std::stable_sort(order.begin(), order.end(), [&rank](size_t a, size_t b) {
+			return rank[a] < rank[b];
+		});
+	} else if (m_Options.judgeOrder == ORDER_LPT) {
+		// 输入越大的样例通常运行越久，先开始运行的话最后不会只剩一个长样例在跑
+		std::vector<long long> inputSize(order.size());
+		for (size_t i = 0; i < order.size(); ++i) {
+			inputSize[i] = getTestDataSize(m_JudgeInfoList[i].fullTestCasePath);
+		}
+		std::stable_sort(order.begin(), order.end(), [&inputSize](size_t a, size_t b) {
+			return inputSize[a] > inputSize[b];
+		});
+	}
+	return order;
+}
+
+// 并行评测所有样例，结果按排序后的顺序显示
+// 分布式评测时每个工作线程负责评测机的一个并行数，只等待评测机的结果
+void doJudge() {
+	bool isRemote = !m_Options.workerAddrList.empty();
+	JudgePool pool(isRemote ? m_JudgeCluster.getSlotCnt() : m_Options.workerCnt,
+	               m_Options.pinCPU && !isRemote);
+	std::cout << std::endl << (isRemote ? "评测机总并行数：" : "并行评测线程数：")
+	          << pool.getWorkerCnt() << std::endl;
+	pool.setExecOrder(getJudgeOrder());
+	if (m_Options.judgeOrder == ORDER_FAILED_FIRST) {
+		// 优先评测的样例往往先于前面的样例完成，未通过时立即提示，不必等到按顺序显示
+		pool.setOnEarlyDone([](size_t i) {
+			const JudgeInfo& e = m_JudgeInfoList[i];
+			if (e.resID != 0) {
+				std::cout << "\x1b[1;31m提前得到结果：" << e.name << m_TestCaseExtension
+				          << " " << getResName(e.resID) << "\x1b[22;0m" << std::endl;
 			}
+		});
+	}
+	// 使用checker时，检查与后续样例的运行同时进行
+	std::function<void(size_t)> checkTask;
+	if (!m_Options.checkerPath.empty()) {
+		checkTask = [](size_t i) {
+			checkOne(m_JudgeInfoList[i]);
+		};
+	}
+	pool.run(m_JudgeInfoList.size(),
+	[isRemote](size_t i, int cpuIndex) {
+		if (isRemote) {
+			judgeRemoteOne(m_JudgeInfoList[i]);
+		} else {
+			judgeOne(m_JudgeInfoList[i], cpuIndex);
 		}
-		// 是数字就字符串转longlong
-		if (isNumName) {
-			NumName = std::stoll(name);
+	},
+	checkTask,
+	[](size_t i) {
+		recordCachedResult(m_JudgeInfoList[i]);
+		showJudgeOne(m_JudgeInfoList[i]);
+	});
+}
+
+// 含有逗号或引号的CSV字段需要加上引号，其中的引号写两次
+std::string quoteCSVField(const std::string& field) {
+	if (field.find_first_of(",\"\n") == std::string::npos) {
+		return field;
+	}
+	std::string quoted = "\"";
+	for (char ch : field) {
+		if (ch == '"') {
+			quoted += '"';
 		}
+		quoted += ch;
 	}
-	// 用于排序
-	bool operator<(const JudgeInfo& o) const {
-		if (isNumName && o.isNumName) {
-			// 都是数字，小的排前面
-			return NumName < o.NumName;
+	return quoted + "\"";
+}
+
+// 把基准测试结果与性能计数器保存为CSV文件，时间单位为微秒，内存单位为字节
+// 性能计数器无法获取时为-1
+bool saveBenchInfo(const std::string& benchInfoPath) {
+	std::ofstream fout(benchInfoPath);
+	if (!fout.is_open()) {
+		return false;
+	}
+	fout << "name,result,runs,"
+	     "cpu_min_us,cpu_median_us,cpu_p95_us,cpu_stddev_us,"
+	     "wall_min_us,wall_median_us,wall_p95_us,wall_stddev_us,"
+	     "peak_memory_bytes,unstable,"
+	     "instructions,cycles,cache_misses,branch_misses,page_faults,context_switches,"
+	     "checker_cpu_us\n";
+	for (const auto& e : m_JudgeInfoList) {
+		std::string name = quoteCSVField(e.name + m_TestCaseExtension);
+		const SampleStats& cpu = e.benchCPU;
+		const SampleStats& wall = e.benchWall;
+		const PerfCounters& perf = e.stats.perf;
+		fout << name << ',' << getResName(e.resID) << ',' << wall.cnt << ','
+		     << cpu.min << ',' << cpu.median << ',' << cpu.p95 << ','
+		     << std::llround(cpu.stddev) << ','
+		     << wall.min << ',' << wall.median << ',' << wall.p95 << ','
+		     << std::llround(wall.stddev) << ','
+		     << e.stats.peakMemory << ',' << (isBenchUnstable(e) ? 1 : 0) << ','
+		     << perf.instructions << ',' << perf.cycles << ','
+		     << perf.cacheMisses << ',' << perf.branchMisses << ','
+		     << perf.pageFaults << ',' << perf.contextSwitches << ','
+		     << e.checkerStats.cpuTimeUs << '\n';
+	}
+	return static_cast<bool>(fout);
+}
+
+// 按终端显示宽度补齐到width列，UTF-8中的多字节字符按两列计算
+std::string padDisplay(const std::string& str, size_t width, bool isLeftAlign) {
+	size_t displayWidth = 0;
+	for (size_t i = 0; i < str.size(); ++i) {
+		unsigned char ch = static_cast<unsigned char>(str[i]);
+		if (ch < 0x80) {
+			++displayWidth;
+		} else if (ch >= 0xC0) {
+			displayWidth += 2;
+		}
+	}
+	if (displayWidth >= width) {
+		return str;
+	}
+	std::string pad(width - displayWidth, ' ');
+	return isLeftAlign ? str + pad : pad + str;
+}
+
+// 打印A/B对比的汇总表
+void printABTable() {
+	std::cout << std::endl << "A/B对比(CPU用时中位数，加速比=A/B，"
+	          "显著性：*** p<0.001，** p<0.01，* p<0.05)：" << std::endl;
+	std::cout << padDisplay("样例", 20, true) << padDisplay("程序A", 14, false)
+	          << padDisplay("程序B", 14, false) << padDisplay("加速比", 10, false)
+	          << std::endl;
+	double logSum = 0;
+	int cnt = 0, fasterCnt = 0, slowerCnt = 0;
+	for (const auto& e : m_JudgeInfoList) {
+		std::string name = padDisplay(e.name + m_TestCaseExtension, 20, true);
+		if (!hasBenchStats(e)) {
+			std::cout << name << padDisplay(getResName(e.resID), 14, false) << std::endl;
+			continue;
 		}
-		if (isNumName || o.isNumName) {
-			// 数字排前面
-			return isNumName;
+		double speedup = getABSpeedup(e);
+		std::string mark = getSignificanceMark(e.ab.pValue);
+		char speedupStr[32];
+		snprintf(speedupStr, sizeof(speedupStr), "%.3f", speedup);
+		std::cout << name << padDisplay(formatTimeUs(e.benchCPU.median), 14, false)
+		          << padDisplay(formatTimeUs(e.ab.benchCPU.median), 14, false)
+		          << padDisplay(speedupStr, 10, false) << " " << mark << std::endl;
+		if (speedup > 0) {
+			logSum += std::log(speedup);
+			++cnt;
+		}
+		if (!mark.empty()) {
+			if (speedup > 1) {
+				++fasterCnt;
+			} else if (speedup < 1) {
+				++slowerCnt;
+			}
 		}
-		// 都不是数字就正常字典序
-		return name < o.name;
 	}
-};
+	if (cnt == 0) {
+		std::cout << "没有两个程序都AC的样例，无法比较" << std::endl;
+		return;
+	}
+	char geoMeanStr[32];
+	snprintf(geoMeanStr, sizeof(geoMeanStr), "%.3f", std::exp(logSum / cnt));
+	std::cout << "加速比几何平均：" << geoMeanStr << "，程序B显著更快的样例" << fasterCnt
+	          << "个，显著更慢的样例" << slowerCnt << "个，无显著差异的样例"
+	          << cnt - fasterCnt - slowerCnt << "个" << std::endl;
+}
 
-std::vector<JudgeInfo> m_JudgeInfoList;
-size_t ACcnt = 0;
+// 枚举文件夹下的待测程序，按文件名排序，没有可执行的程序时抛出std::runtime_error
+std::vector<std::string> getBatchExeList(const std::string& dirPath) {
+	std::vector<std::string> exeList;
+	try {
+		exeList = winfs::getFilesOfDirectory(dirPath, "*",
+		[](const std::string & dirPath, const std::string & fileName) {
+			std::string path = dirPath + winfs::PATH_SEP + fileName;
+			return winfs::isExecutableFile(path) ? path : std::string();
+		});
+	} catch (const std::exception& ex) {
+		// 空文件夹同样按没有程序处理
+	}
+	if (exeList.empty()) {
+		throw std::runtime_error("文件夹下没有可执行的待测程序！");
+	}
+	std::sort(exeList.begin(), exeList.end());
+	return exeList;
+}
 
-void doJudge() {
-	for (auto& e : m_JudgeInfoList) {
-		std::cout << std::endl
-		          << "正在评测\x1b[1;37;44m "
-		          << e.name << m_TestCaseExtension << " \x1b[0m："
+// 并行读入所有样例的测试数据，只读入一次，供所有待测程序共用
+// 读入失败的样例评测时再打开文件，由评测报告错误
+void loadTestCases() {
+	m_LoadedTestCases.clear();
+	m_LoadedTestCases.resize(m_JudgeInfoList.size());
+	JudgePool pool(m_Options.workerCnt, false);
+	pool.run(m_JudgeInfoList.size(),
+	[](size_t i, int) {
+		try {
+			m_LoadedTestCases[i] = std::make_unique<LoadedTestCase>(
+			                           m_JudgeInfoList[i].fullTestCasePath,
+			                           m_JudgeInfoList[i].fullAnsPath);
+		} catch (const std::exception& ex) {
+			m_LoadedTestCases[i].reset();
+		}
+	},
+	[](size_t) {});
+}
+
+// 批量评测单个程序的单个样例，在工作线程中执行
+void judgeBatchOne(JudgeInfo& e, size_t caseIndex, int cpuIndex) {
+	TestConfig config = makeTestConfig(e, cpuIndex);
+	config.loadedCase = m_LoadedTestCases[caseIndex].get();
+	e.resID = runOnce(e, config, e.ERRmsg, e.stats);
+}
+
+// 批量评测中第exeIndex个程序通过的样例数
+size_t getBatchACCnt(size_t exeIndex) {
+	size_t caseCnt = m_JudgeInfoList.size();
+	auto rowBegin = m_BatchJudgeInfoList.begin() + exeIndex * caseCnt;
+	return std::count_if(rowBegin, rowBegin + caseCnt, [](const JudgeInfo & e) {
+		return e.resID == 0;
+	});
+}
+
+// 批量评测文件夹下的所有程序，所有(程序,样例)组合一起并行评测
+// 每个程序的样例按调度策略排列，一个程序的样例全部完成时显示其通过情况
+void doBatchJudge() {
+	size_t caseCnt = m_JudgeInfoList.size();
+	std::cout << std::endl << "正在读入测试数据..." << std::endl;
+	loadTestCases();
+	m_BatchJudgeInfoList.clear();
+	m_BatchJudgeInfoList.reserve(m_BatchExeList.size() * caseCnt);
+	for (const auto& exePath : m_BatchExeList) {
+		for (const auto& e : m_JudgeInfoList) {
+			m_BatchJudgeInfoList.push_back(e);
+			m_BatchJudgeInfoList.back().exeFilePath = exePath;
+		}
+	}
+	std::vector<size_t> caseOrder = getJudgeOrder();
+	std::vector<size_t> execOrder;
+	execOrder.reserve(m_BatchJudgeInfoList.size());
+	for (size_t i = 0; i < m_BatchExeList.size(); ++i) {
+		for (size_t j : caseOrder) {
+			execOrder.push_back(i * caseCnt + j);
+		}
+	}
+	JudgePool pool(m_Options.workerCnt, m_Options.pinCPU);
+	std::cout << "批量评测" << m_BatchExeList.size() << "个程序，每个程序"
+	          << caseCnt << "个样例，并行评测线程数：" << pool.getWorkerCnt() << std::endl;
+	pool.setExecOrder(std::move(execOrder));
+	pool.run(m_BatchJudgeInfoList.size(),
+	[caseCnt](size_t i, int cpuIndex) {
+		judgeBatchOne(m_BatchJudgeInfoList[i], i % caseCnt, cpuIndex);
+	},
+	[caseCnt](size_t i) {
+		if (i % caseCnt != caseCnt - 1) {
+			return;
+		}
+		size_t exeIndex = i / caseCnt;
+		size_t ACcnt = getBatchACCnt(exeIndex);
+		std::cout << '[' << exeIndex + 1 << '/' << m_BatchExeList.size() << "] "
+		          << (ACcnt == caseCnt ? "\x1b[1;32m" : "\x1b[1;31m")
+		          << winfs::getFileNameWithExten(m_BatchExeList[exeIndex])
+		          << "\x1b[22;0m 通过情况：" << ACcnt << '/' << caseCnt << std::endl;
+	});
+	// 评测完成后不再需要测试数据
+	m_LoadedTestCases.clear();
+}
+
+// 结果矩阵中的单元格，宽度固定为5列
+// 均为白字，绿底AC，红底WA，灰底TLE，紫底OLE，黄底MLE，蓝底无法启动评测
+std::string getBatchCellStr(int resID) {
+	switch (resID) {
+		case 0:
+			return "\x1b[1;37;42m AC  \x1b[0m";
+		case -2:
+			return "\x1b[1;37;41m WA  \x1b[0m";
+		case -3:
+			return "\x1b[1;37;100m TLE \x1b[0m";
+		case -4:
+			return "\x1b[1;37;45m OLE \x1b[0m";
+		case -5:
+			return "\x1b[1;37;43m MLE \x1b[0m";
+		case 1:
+			return "  -  ";
+		default:
+			return "\x1b[1;37;44m ERR \x1b[0m";
+	}
+}
+
+// 打印批量评测的结果矩阵，每行一个程序，每列一个样例，最后一行为各样例的通过人数
+void printBatchTable() {
+	size_t caseCnt = m_JudgeInfoList.size();
+	std::cout << std::endl << "各列对应的样例：" << std::endl;
+	int strLineLen = 0;
+	for (size_t j = 0; j < caseCnt; ++j) {
+		std::string colStr = std::to_string(j + 1) + ":"
+		                     + m_JudgeInfoList[j].name + m_TestCaseExtension + "  ";
+		if (strLineLen > 0 && strLineLen + colStr.size() > 80) {
+			std::cout << std::endl;
+			strLineLen = 0;
+		}
+		std::cout << colStr;
+		strLineLen += colStr.size();
+	}
+	std::cout << std::endl << std::endl;
+	size_t nameWidth = 8;
+	for (const auto& exePath : m_BatchExeList) {
+		nameWidth = std::max(nameWidth, winfs::getFileNameWithExten(exePath).size());
+	}
+	nameWidth = std::min<size_t>(nameWidth, 30);
+	int exeNumIDMAXLen = getNumBits(m_BatchExeList.size());
+	std::string headStr = std::string(exeNumIDMAXLen + 1, ' ')
+	                      + padDisplay("程序", nameWidth, true);
+	for (size_t j = 0; j < caseCnt; ++j) {
+		headStr += padDisplay(std::to_string(j + 1), 5, false);
+	}
+	std::cout << headStr << "  通过" << std::endl;
+	for (size_t i = 0; i < m_BatchExeList.size(); ++i) {
+		std::string exeNumIDStr = std::to_string(i + 1);
+		std::cout << std::string(exeNumIDMAXLen - exeNumIDStr.size(), '0')
+		          << exeNumIDStr << ':'
+		          << padDisplay(winfs::getFileNameWithExten(m_BatchExeList[i]),
+		                        nameWidth, true);
+		for (size_t j = 0; j < caseCnt; ++j) {
+			std::cout << getBatchCellStr(m_BatchJudgeInfoList[i * caseCnt + j].resID);
+		}
+		std::cout << "  " << getBatchACCnt(i) << '/' << caseCnt << std::endl;
+	}
+	std::string footStr = std::string(exeNumIDMAXLen + 1, ' ')
+	                      + padDisplay("通过人数", nameWidth, true);
+	for (size_t j = 0; j < caseCnt; ++j) {
+		size_t ACcnt = 0;
+		for (size_t i = 0; i < m_BatchExeList.size(); ++i) {
+			ACcnt += m_BatchJudgeInfoList[i * caseCnt + j].resID == 0;
+		}
+		footStr += padDisplay(std::to_string(ACcnt), 5, false);
+	}
+	std::cout << footStr << std::endl;
+	size_t allACCnt = 0;
+	for (size_t i = 0; i < m_BatchExeList.size(); ++i) {
+		allACCnt += getBatchACCnt(i) == caseCnt;
+	}
+	std::cout << std::endl << "批量评测完成，全部通过的程序："
+	          << allACCnt << '/' << m_BatchExeList.size() << std::endl;
+}
+
+// 把批量评测的结果矩阵保存为CSV文件，每行一个程序，每列一个样例的结果
+// 最后两列为通过的样例数与CPU用时之和(微秒)
+bool saveBatchInfo(const std::string& batchInfoPath) {
+	std::ofstream fout(batchInfoPath);
+	if (!fout.is_open()) {
+		return false;
+	}
+	size_t caseCnt = m_JudgeInfoList.size();
+	fout << "program";
+	for (const auto& e : m_JudgeInfoList) {
+		fout << ',' << quoteCSVField(e.name + m_TestCaseExtension);
+	}
+	fout << ",ac_count,total_cpu_us\n";
+	for (size_t i = 0; i < m_BatchExeList.size(); ++i) {
+		fout << quoteCSVField(winfs::getFileNameWithExten(m_BatchExeList[i]));
+		long long cpuSum = 0;
+		for (size_t j = 0; j < caseCnt; ++j) {
+			const JudgeInfo& e = m_BatchJudgeInfoList[i * caseCnt + j];
+			fout << ',' << getResName(e.resID);
+			cpuSum += e.stats.cpuTimeUs;
+		}
+		fout << ',' << getBatchACCnt(i) << ',' << cpuSum << '\n';
+	}
+	return static_cast<bool>(fout);
+}
+
+// 显示批量评测的结果矩阵，可按序号查看单个程序未通过的样例
+void showBatchResult() {
+	std::string batchInfoPath = winfs::getCurEXEParentDirectoryPath()
+	                            + winfs::PATH_SEP + "lstbatchinfo.csv";
+	if (saveBatchInfo(batchInfoPath)) {
+		std::cout << "批量评测结果已保存到：" << batchInfoPath << std::endl;
+	} else {
+		std::cerr << "\x1b[1;31m批量评测结果保存失败！\x1b[22;0m" << std::endl;
+	}
+	size_t caseCnt = m_JudgeInfoList.size();
+	while (true) {
+		printBatchTable();
+		std::cout << "输入0退出程序，输入:左边的序号查看该程序未通过的样例：" << std::endl;
+		int ch;
+		if (!(std::cin >> ch)) {
+			std::cin.clear();
+			ch = -1;
+		}
+		std::cin.ignore();
+		if (ch == 0) {
+			return;
+		}
+		if (ch < 1 || ch > static_cast<int>(m_BatchExeList.size())) {
+			std::cerr << "\x1b[1;31m输入的选择无效！\x1b[22;0m" << std::endl;
+			continue;
+		}
+		size_t exeIndex = static_cast<size_t>(ch - 1);
+		std::cout << std::endl << "程序\x1b[1;37;44m "
+		          << winfs::getFileNameWithExten(m_BatchExeList[exeIndex])
+		          << " \x1b[0m通过情况：" << getBatchACCnt(exeIndex) << '/' << caseCnt
 		          << std::endl;
-		// 1：未评测，0：AC，-1：启动失败，-2：WA，-3：TLE
-		e.resID = runTest(e.fullTestCasePath, e.fullAnsPath,
-		                  e.exeFilePath, e.timeLimit);
-		switch (e.resID) {
-			case 0:
-				++ACcnt;
-				std::cout << artAC << std::endl;
-				e.ERRmsg = m_TestERRStr;
-				m_TestERRStr.clear();
-				std::cout << "用时：" << e.ERRmsg << "ms" << std::endl;
-				break;
-			case -1:
-				std::cout << artStartFailed << std::endl;
-				e.ERRmsg = m_TestERRStr;
-				m_TestERRStr.clear();
-				std::cout << "报错信息：" << std::endl << e.ERRmsg << std::endl;
-				break;
-			case -2:
-				std::cout << artWA << std::endl;
-				e.ERRmsg = m_TestERRStr;
-				m_TestERRStr.clear();
-				std::cout << "错误原因：" << std::endl << e.ERRmsg << std::endl;
-				break;
-			case -3:
-				std::cout << artTLE << std::endl;
-				e.ERRmsg = m_TestERRStr;
-				m_TestERRStr.clear();
-				std::cout << std::endl << e.ERRmsg << std::endl;
-				break;
+		for (size_t j = 0; j < caseCnt; ++j) {
+			const JudgeInfo& e = m_BatchJudgeInfoList[exeIndex * caseCnt + j];
+			if (e.resID != 0) {
+				showJudgeOne(e);
+			}
 		}
+		std::cout << "按回车返回概览界面" << std::endl;
+		std::cin.get();
+	}
+}
+
+// 存储上一次评测信息，按交互输入的顺序每行一项，重复评测时依次读取
+// 测试集为文件夹或.zip压缩包时才有输入文件的后缀
+void saveLstJudgeInfo(const std::string& lstJudgeInfoPath, const std::string& infilepath,
+                      const std::string& exefilepath, int timeLimit) {
+	std::ofstream fout(lstJudgeInfoPath);
+	if (fout.is_open()) {
+		fout << infilepath << '\n';
+		fout << exefilepath << '\n';
+		fout << timeLimit << '\n';
+		fout << m_AnsExtension << '\n';
+		if (isTestSetMultiCase(infilepath)) {
+			fout << m_TestCaseExtension << '\n';
+		}
+		fout.close();
+	}
+}
+
+// 作为守护进程运行，各任务的评测配置取自命令行选项，只在无法监听时返回
+int runDaemon() {
+	JudgeDaemon daemon(makeBaseTestConfig(), m_Options.workerCnt, m_Options.pinCPU);
+	std::string errMsg;
+	daemon.serve(m_Options.daemonPath, errMsg);
+	std::cerr << "\x1b[1;31m守护进程启动失败：" << errMsg << "\x1b[22;0m" << std::endl;
+	return 1;
+}
+
+// 作为分布式评测的评测机运行，缓存的测试数据放在本程序所在目录下，只在无法监听时返回
+int runWorker() {
+	std::string cacheDirPath = winfs::getCurEXEParentDirectoryPath() + winfs::PATH_SEP
+	                           + "workercache";
+	std::string errMsg;
+	try {
+		JudgeWorker worker(m_Options.workerCnt, m_Options.pinCPU, cacheDirPath,
+		                   m_Options.workerToken);
+		worker.serve(m_Options.workerListenAddr, errMsg);
+	} catch (const std::exception& ex) {
+		errMsg = ex.what();
 	}
+	std::cerr << "\x1b[1;31m评测机启动失败：" << errMsg << "\x1b[22;0m" << std::endl;
+	return 1;
 }
 
-int main() {
+// 连接所有评测机，一台都无法连接时返回false
+bool connectWorkers() {
+	std::cout << std::endl;
+	for (const auto& addr : m_Options.workerAddrList) {
+		std::string errMsg;
+		int slotCnt = m_JudgeCluster.addWorker(addr, m_Options.workerToken, errMsg);
+		if (slotCnt > 0) {
+			std::cout << "已连接评测机" << addr << "，并行数：" << slotCnt << std::endl;
+		} else {
+			std::cerr << "\x1b[1;31m无法使用评测机" << addr << "：" << errMsg
+			          << "\x1b[22;0m" << std::endl;
+		}
+	}
+	return m_JudgeCluster.getSlotCnt() > 0;
+}
+
+int main(int argc, char* argv[]) {
+	{
+		std::string errMsg;
+		if (!parseJudgeOptions(argc, argv, errMsg)) {
+			if (!errMsg.empty()) {
+				std::cerr << "\x1b[1;31m" << errMsg << "\x1b[22;0m" << std::endl;
+			}
+			printJudgeOptionsHelp();
+			return errMsg.empty() ? 0 : 1;
+		}
+	}
 	std::string lstJudgeInfoPath =
-	    winfs::getCurEXEParentDirectoryPath() + "\\lstjudgeinfo.txt";
+	    winfs::getCurEXEParentDirectoryPath() + winfs::PATH_SEP + "lstjudgeinfo.txt";
 	std::cout << "本程序可以作为一个本地的oj使用，指定测试集和程序文件，自动判题"
 	          << std::endl
 	          << "by XY0797"
@@ -157,6 +1067,40 @@ int main() {
 		          "这将导致本程序的彩色显示变成乱码！" << std::endl;
 	}
 
+	// 评测机的内存限制由协调端指定，启动时同样需要提示
+	if ((m_Options.memoryLimitMB > 0 || !m_Options.workerListenAddr.empty())
+	        && !isMemoryLimitReliable()) {
+		std::cout << "\x1b[1;33m警告：无法创建限制内存的cgroup，内存限制只能通过限制地址空间实现，"
+		          "超限的内存申请会失败并显示为运行错误，无法判定为MLE\x1b[22;0m" << std::endl;
+	}
+
+	stripPathQuotes(m_Options.checkerPath);
+	if (!m_Options.checkerPath.empty() && !winfs::isFileExist(m_Options.checkerPath)) {
+		std::cerr << "\x1b[1;31mchecker不存在！\x1b[22;0m" << std::endl;
+		return 1;
+	}
+	stripPathQuotes(m_Options.checkerLibPath);
+	if (!m_Options.checkerLibPath.empty()) {
+		std::string errMsg;
+		if (!m_CheckerPlugin.load(m_Options.checkerLibPath, errMsg)) {
+			std::cerr << "\x1b[1;31m" << errMsg << "\x1b[22;0m" << std::endl;
+			return 1;
+		}
+	}
+	stripPathQuotes(m_Options.abExePath);
+	if (!m_Options.abExePath.empty() && !winfs::isFileExist(m_Options.abExePath)) {
+		std::cerr << "\x1b[1;31mA/B对比的程序B不存在！\x1b[22;0m" << std::endl;
+		return 1;
+	}
+
+	// 守护进程与评测机模式不进行交互
+	if (!m_Options.daemonPath.empty()) {
+		return runDaemon();
+	}
+	if (!m_Options.workerListenAddr.empty()) {
+		return runWorker();
+	}
+
 	bool isRepeat = false;
 	if (winfs::isFileExist(lstJudgeInfoPath)) {
 		std::string tmpStr;
@@ -180,18 +1124,15 @@ int main() {
 
 	std::string infilepath;
 	std::cout << "请输入测试集\x1b[1;37;42m输入文件\x1b[0m的文件路径"
-	          "(可以直接拖进来,文件夹也行)：" << std::endl;
+	          "(可以直接拖进来,文件夹与.zip压缩包也行)：" << std::endl;
 	if (isRepeat) {
 		std::getline(fin, infilepath);
 		std::cout << infilepath << std::endl;
 	} else {
 		std::getline(std::cin, infilepath);
 	}
-	if (!infilepath.empty() && infilepath[0] == '"') {
-		infilepath.pop_back();
-		infilepath.erase(infilepath.begin());
-	}
-	if (!winfs::isFileExist(infilepath)) {
+	stripPathQuotes(infilepath);
+	if (!isTestDataExist(infilepath)) {
 		std::cerr << "\x1b[1;31m测试集文件/文件夹 不存在！\x1b[22;0m" << std::endl;
 		std::cout << "按回车退出" << std::endl;
 		std::cin.get();
@@ -200,24 +1141,36 @@ int main() {
 
 	std::string exefilepath;
 	std::cout << "请输入\x1b[1;37;42mEXE文件\x1b[0m的文件路径"
-	          "(可以直接拖进来)：" << std::endl;
+	          "(可以直接拖进来,文件夹则批量评测其中所有程序)：" << std::endl;
 	if (isRepeat) {
 		std::getline(fin, exefilepath);
 		std::cout << exefilepath << std::endl;
 	} else {
 		std::getline(std::cin, exefilepath);
 	}
-	if (!exefilepath.empty() && exefilepath[0] == '"') {
-		exefilepath.pop_back();
-		exefilepath.erase(exefilepath.begin());
-	}
+	stripPathQuotes(exefilepath);
 	if (!winfs::isFileExist(exefilepath)) {
 		std::cerr << "\x1b[1;31mEXE文件 不存在！\x1b[22;0m" << std::endl;
 		std::cout << "按回车退出" << std::endl;
 		std::cin.get();
 		return 0;
 	}
-
+	if (winfs::isDir(exefilepath)) {
+		if (m_Options.benchRuns > 0 || !m_Options.abExePath.empty() || m_Options.isPerf
+		        || !m_Options.workerAddrList.empty()) {
+			std::cerr << "\x1b[1;31m批量评测不能与--bench、--ab、--perf或--workers同时使用！"
+			          "\x1b[22;0m" << std::endl;
+			return 1;
+		}
+		try {
+			m_BatchExeList = getBatchExeList(exefilepath);
+		} catch (const std::exception& ex) {
+			std::cerr << "\x1b[1;31m" << ex.what() << "\x1b[22;0m" << std::endl;
+			std::cout << "按回车退出" << std::endl;
+			std::cin.get();
+			return 0;
+		}
+	}
 	std::string timeLimitStr;
 	int timeLimit;
 	std::cout << "请输入程序的\x1b[1;37;42m时间限制\x1b[0m"
@@ -254,9 +1207,8 @@ int main() {
 	}
 
 	try {
-		std::vector<std::string> testCaseFiles;
-		// strList存储测试样例的输入文件路径
-		if (winfs::isDir(infilepath)) {
+		// .zip压缩包与文件夹一样，枚举其中的输入文件
+		if (isTestSetMultiCase(infilepath)) {
 			std::cout << "请输入测试集"
 			          "\x1b[1;37;42m输入文件\x1b[0m的\x1b[1;37;42m后缀\x1b[0m"
 			          "(直接回车则使用默认的.in)：" << std::endl;
@@ -269,40 +1221,103 @@ int main() {
 			if (m_TestCaseExtension.empty()) {
 				m_TestCaseExtension = ".in";
 			}
-			testCaseFiles = winfs::getFilesOfDirectory(infilepath,
-			                "*" + m_TestCaseExtension);
 		} else {
-			m_TestCaseExtension = winfs::getFileExtenWithDot(infilepath);
-			testCaseFiles.push_back(infilepath);
+			m_TestCaseExtension =
+			    winfs::getFileExtenWithDot(removeCompressExten(infilepath));
 		}
 		// 创建评测列表
-		for (const auto& e : testCaseFiles) {
+		for (const auto& e : getTestCaseFiles(infilepath, m_TestCaseExtension)) {
 			m_JudgeInfoList.push_back(JudgeInfo(e, exefilepath, timeLimit));
 		}
 		std::sort(m_JudgeInfoList.begin(), m_JudgeInfoList.end());
+		// 标准答案摘要索引放在测试集所在目录下
+		std::string testSetDirPath = winfs::isDir(infilepath) ? infilepath
+		                             : winfs::getFilesParentDirectory(infilepath);
+		if (m_Options.isDigest) {
+			m_AnsDigestIndex.load((testSetDirPath.empty() ? "." : testSetDirPath)
+			                      + winfs::PATH_SEP + ANS_DIGEST_INDEX_NAME);
+		}
+		// 批量评测每个程序只评测一次，不使用评测结果缓存
+		if (!m_BatchExeList.empty()) {
+			doBatchJudge();
+			if (m_Options.isDigest && !m_AnsDigestIndex.save()) {
+				std::cerr << "\x1b[1;31m标准答案摘要索引保存失败！\x1b[22;0m" << std::endl;
+			}
+			saveLstJudgeInfo(lstJudgeInfoPath, infilepath, exefilepath, timeLimit);
+			showBatchResult();
+			return 0;
+		}
+		// 评测结果缓存与上一次评测信息放在一起
+		m_JudgeCache.load(winfs::getCurEXEParentDirectoryPath() + winfs::PATH_SEP
+		                  + "lstjudgecache.txt");
+		if (m_Options.benchRuns == 0 && m_Options.abExePath.empty() && !m_Options.isPerf) {
+			try {
+				m_CacheBaseStr = makeCacheBaseStr(exefilepath);
+				m_IsCacheEnabled = true;
+				m_IsCacheReused = isRepeat && !m_Options.isForce;
+			} catch (const std::exception& ex) {
+				// 程序无法读取时不使用缓存，由评测报告错误
+			}
+		}
 		// 开始评测
+		if (!m_Options.workerAddrList.empty() && !connectWorkers()) {
+			std::cerr << "\x1b[1;31m没有可用的评测机！\x1b[22;0m" << std::endl;
+			std::cout << "按回车退出" << std::endl;
+			std::cin.get();
+			return 0;
+		}
 		doJudge();
+		if (m_Options.isDigest && !m_AnsDigestIndex.save()) {
+			std::cerr << "\x1b[1;31m标准答案摘要索引保存失败！\x1b[22;0m" << std::endl;
+		}
 		// 评测完成
+		size_t ACcnt = std::count_if(m_JudgeInfoList.begin(), m_JudgeInfoList.end(),
+		[](const JudgeInfo & e) {
+			return e.resID == 0;
+		});
 		std::cout << std::endl << "评测完成，通过情况："
 		          << ACcnt << '/' << m_JudgeInfoList.size() << std::endl;
-		// 存储上一次评测信息
-		{
-			std::ofstream fout(lstJudgeInfoPath);
-			if (fout.is_open()) {
-				fout << infilepath << '\n';
-				fout << exefilepath << '\n';
-				fout << timeLimit << '\n';
-				fout << m_AnsExtension << '\n';
-				if (winfs::isDir(infilepath)) {
-					fout << m_TestCaseExtension << '\n';
-				}
-				fout.close();
+		if (m_IsCacheEnabled) {
+			size_t cachedCnt = std::count_if(m_JudgeInfoList.begin(), m_JudgeInfoList.end(),
+			[](const JudgeInfo & e) {
+				return e.isCached;
+			});
+			if (cachedCnt > 0) {
+				std::cout << "其中" << cachedCnt << "个样例未变化，直接使用了上一次的结果，"
+				          "指定--force可重新评测全部样例" << std::endl;
 			}
+			if (!m_JudgeCache.save()) {
+				std::cerr << "\x1b[1;31m评测结果缓存保存失败！\x1b[22;0m" << std::endl;
+			}
+		}
+		// A/B对比模式下打印汇总表
+		if (!m_Options.abExePath.empty()) {
+			printABTable();
 		}
+		// 保存基准测试结果与性能计数器
+		if ((m_Options.benchRuns > 0 || m_Options.isPerf) && m_Options.abExePath.empty()) {
+			size_t unstableCnt = std::count_if(m_JudgeInfoList.begin(),
+			                                   m_JudgeInfoList.end(), isBenchUnstable);
+			if (unstableCnt > 0) {
+				std::cout << "\x1b[1;31m有" << unstableCnt
+				          << "个样例的基准测试结果波动过大\x1b[22;0m" << std::endl;
+			}
+			std::string benchInfoPath = winfs::getCurEXEParentDirectoryPath()
+			                            + winfs::PATH_SEP + "lstbenchinfo.csv";
+			if (saveBenchInfo(benchInfoPath)) {
+				std::cout << "评测统计已保存到：" << benchInfoPath << std::endl;
+			} else {
+				std::cerr << "\x1b[1;31m评测统计保存失败！\x1b[22;0m" << std::endl;
+			}
+		}
+		// 存储上一次评测信息
+		saveLstJudgeInfo(lstJudgeInfoPath, infilepath, exefilepath, timeLimit);
 		// 显示样例评测结果概览
-		// 均为白字，绿底AC，红底WA，灰底TLE，蓝底无法启动评测
+		// 均为白字，绿底AC，红底WA，灰底TLE，紫底OLE，黄底MLE，蓝底无法启动评测
 		std::cout << "\x1b[1;37;42m  AC  \x1b[0m   \x1b[1;37;41m  WA  \x1b[0m"
 		          "   \x1b[1;37;100m  TLE  \x1b[0m"
+		          "   \x1b[1;37;45m  OLE  \x1b[0m"
+		          "   \x1b[1;37;43m  MLE  \x1b[0m"
 		          "   \x1b[1;37;44m 无法启动评测 \x1b[0m"
 		          << std::endl << std::endl;
 ShowJudgeRes:
@@ -317,7 +1332,7 @@ ShowJudgeRes:
 			strLineLen += caseNumIDStr.length() + e.name.length()
 			              + m_TestCaseExtension.length() + 2;
 			std::cout << caseNumIDStr;
-			// 1：未评测，0：AC，-1：启动失败，-2：WA，-3：TLE
+			// 1：未评测，0：AC，-1：启动失败，-2：WA，-3：TLE，-4：OLE，-5：MLE
 			switch (e.resID) {
 				case 0:
 					std::cout << "\x1b[1;37;42m " << e.name << m_TestCaseExtension
@@ -335,6 +1350,14 @@ ShowJudgeRes:
 					std::cout << "\x1b[1;37;100m " << e.name << m_TestCaseExtension
 					          << " \x1b[0m\t";
 					break;
+				case -4:
+					std::cout << "\x1b[1;37;45m " << e.name << m_TestCaseExtension
+					          << " \x1b[0m\t";
+					break;
+				case -5:
+					std::cout << "\x1b[1;37;43m " << e.name << m_TestCaseExtension
+					          << " \x1b[0m\t";
+					break;
 			}
 			if (strLineLen >= 40) {
 				std::cout << std::endl;
@@ -363,8 +1386,11 @@ ShowJudgeRes:
 				          << m_JudgeInfoList[ch].name << m_TestCaseExtension
 				          << " \x1b[0m" << std::endl
 				          << artAC << std::endl
-				          << "用时："
-				          << m_JudgeInfoList[ch].ERRmsg << "ms" << std::endl;
+				          << (m_JudgeInfoList[ch].ERRmsg.empty() ? ""
+				              : "checker信息：" + m_JudgeInfoList[ch].ERRmsg + "\n")
+				          << (hasBenchStats(m_JudgeInfoList[ch])
+				              ? getBenchMsg(m_JudgeInfoList[ch])
+				              : getStatsMsg(m_JudgeInfoList[ch])) << std::endl;
 				break;
 			case -1:
 				std::cout << "\x1b[1;37;44m "
@@ -380,15 +1406,37 @@ ShowJudgeRes:
 				          << " \x1b[0m" << std::endl
 				          << artWA << std::endl
 				          << "错误原因：" << std::endl
-				          << m_JudgeInfoList[ch].ERRmsg << std::endl;
+				          << m_JudgeInfoList[ch].ERRmsg << std::endl
+				          << getStatsMsg(m_JudgeInfoList[ch]) << std::endl;
 				break;
 			case -3:
 				std::cout << "\x1b[1;37;100m "
 				          << m_JudgeInfoList[ch].name << m_TestCaseExtension
 				          << " \x1b[0m" << std::endl
 				          << artTLE << std::endl
-				          << std::endl << m_JudgeInfoList[ch].ERRmsg << std::endl;
+				          << std::endl << m_JudgeInfoList[ch].ERRmsg << std::endl
+				          << getStatsMsg(m_JudgeInfoList[ch]) << std::endl;
+				break;
+			case -4:
+				std::cout << "\x1b[1;37;45m "
+				          << m_JudgeInfoList[ch].name << m_TestCaseExtension
+				          << " \x1b[0m" << std::endl
+				          << artOLE << std::endl
+				          << std::endl << m_JudgeInfoList[ch].ERRmsg << std::endl
+				          << getStatsMsg(m_JudgeInfoList[ch]) << std::endl;
 				break;
+			case -5:
+				std::cout << "\x1b[1;37;43m "
+				          << m_JudgeInfoList[ch].name << m_TestCaseExtension
+				          << " \x1b[0m" << std::endl
+				          << artMLE << std::endl
+				          << std::endl << m_JudgeInfoList[ch].ERRmsg << std::endl
+				          << getStatsMsg(m_JudgeInfoList[ch]) << std::endl;
+				break;
+		}
+		// 成功启动的程序显示性能计数器
+		if (m_Options.isPerf && m_JudgeInfoList[ch].resID != -1) {
+			std::cout << getPerfMsg(m_JudgeInfoList[ch]) << std::endl;
 		}
 		std::cout << "按回车返回概览界面" << std::endl;
 		std::cin.get();
@@ -2,7 +2,7 @@
  * \file    	WindowsFileSysTool.hpp
  * \author  	XY0797
  * \date    	2024.8.6
- * \brief		提供Windows下的文件系统工具函数
+ * \brief		提供文件系统工具函数，支持Windows与POSIX(Linux)
  */
 #ifndef _XY0797_WINDOWSFILESYSTOOL
 #define _XY0797_WINDOWSFILESYSTOOL 1
@@ -10,8 +10,17 @@
 #include <string>
 #include <regex>
 #include <vector>
+#include <cstdlib>
+#include <cctype>
 #include <functional>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <dirent.h>
+#include <fnmatch.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
 
 // 不得修改和读取该命名空间的内容
 // 请使用winfs提供的函数读取
@@ -21,26 +30,44 @@ namespace INTERNAL_winfs_DO_NOT_READ_OR_EDIT {
 }
 
 namespace winfs {
+#ifdef _WIN32
+	// 路径分隔符
+	const std::string PATH_SEP = "\\";
+#else
+	const std::string PATH_SEP = "/";
+#endif
+
 	// 判断一个文件是否存在
 	// 支持判断目录是否存在，末尾有无\皆可
 	bool isFileExist(const std::string& filePath) {
 		if (filePath.empty()) {
 			return false;
 		}
+#ifdef _WIN32
 		DWORD attributes = GetFileAttributes(filePath.c_str());
 		return attributes != INVALID_FILE_ATTRIBUTES;
+#else
+		struct stat st;
+		return stat(filePath.c_str(), &st) == 0;
+#endif
 	}
 
-	// 判断一个windows路径是否为目录
+	// 判断一个路径是否为目录
+	// Windows下按路径的形式判断，POSIX下查询文件系统
 	bool isDir(const std::string& pathStr) {
 		if (pathStr == ".") {
 			return true;
 		}
+#ifdef _WIN32
 		size_t i1 = pathStr.rfind("\\");
 		if (i1 == pathStr.npos) {
 			return false;
 		}
 		return (pathStr.find(".", i1) == pathStr.npos);
+#else
+		struct stat st;
+		return stat(pathStr.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
 	}
 
 	// 获取文件全路径的父目录，返回不带\的目录路径，失败返回空文本
@@ -123,6 +150,108 @@ namespace winfs {
 		return filePath.substr(i1 + 1, filePath.length() - i1 - 1);
 	}
 
+	// 相对路径转为基于当前工作目录的绝对路径，失败时原样返回
+	std::string getAbsolutePath(const std::string& filePath) {
+#ifdef _WIN32
+		char pathBuffer[MAX_PATH];
+		DWORD len = GetFullPathNameA(filePath.c_str(), MAX_PATH, pathBuffer, NULL);
+		if (len == 0 || len >= MAX_PATH) {
+			return filePath;
+		}
+		return std::string(pathBuffer, len);
+#else
+		if (filePath.empty() || filePath[0] == '/') {
+			return filePath;
+		}
+		char cwdBuffer[4096];
+		if (getcwd(cwdBuffer, sizeof(cwdBuffer)) == NULL) {
+			return filePath;
+		}
+		return std::string(cwdBuffer) + "/" + filePath;
+#endif
+	}
+
+	// 获取文件的大小(字节)与最后修改时间，失败返回false
+	// 修改时间只用于判断文件是否变化，单位与起点因平台而异
+	bool getFileSizeAndTime(const std::string& filePath, long long& fileSize,
+	                        long long& modifyTime) {
+#ifdef _WIN32
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		if (!GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &data)) {
+			return false;
+		}
+		fileSize = (static_cast<long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+		modifyTime = (static_cast<long long>(data.ftLastWriteTime.dwHighDateTime) << 32)
+		             | data.ftLastWriteTime.dwLowDateTime;
+#else
+		struct stat st;
+		if (stat(filePath.c_str(), &st) != 0) {
+			return false;
+		}
+		fileSize = static_cast<long long>(st.st_size);
+		modifyTime = static_cast<long long>(st.st_mtim.tv_sec) * 1000000000ll
+		             + st.st_mtim.tv_nsec;
+#endif
+		return true;
+	}
+
+	// 判断一个文件是否为可执行程序
+	// Windows下按.exe后缀判断，POSIX下要求是有执行权限的普通文件
+	bool isExecutableFile(const std::string& filePath) {
+#ifdef _WIN32
+		std::string exten = getNonDotFileExten(filePath);
+		for (char& ch : exten) {
+			ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+		}
+		return exten == "exe" && isFileExist(filePath);
+#else
+		struct stat st;
+		return stat(filePath.c_str(), &st) == 0 && S_ISREG(st.st_mode)
+		       && access(filePath.c_str(), X_OK) == 0;
+#endif
+	}
+
+	// 在系统临时目录下创建一个空的临时文件，返回其全路径，失败返回空文本
+	// 文件不会被自动删除，用完后需要调用者删除
+	std::string createTempFile() {
+#ifdef _WIN32
+		char dirBuffer[MAX_PATH];
+		char pathBuffer[MAX_PATH];
+		DWORD len = GetTempPathA(MAX_PATH, dirBuffer);
+		if (len == 0 || len >= MAX_PATH
+		        || GetTempFileNameA(dirBuffer, "loj", 0, pathBuffer) == 0) {
+			return std::string();
+		}
+		return pathBuffer;
+#else
+		const char* tmpDir = getenv("TMPDIR");
+		std::string pathStr = std::string(tmpDir != NULL && tmpDir[0] ? tmpDir : "/tmp")
+		                      + "/localoj_XXXXXX";
+		int fd = mkstemp(&pathStr[0]);
+		if (fd < 0) {
+			return std::string();
+		}
+		close(fd);
+		return pathStr;
+#endif
+	}
+
+	// 创建目录，目录已经存在时同样返回true，不会创建上级目录
+	bool createDir(const std::string& dirPath) {
+#ifdef _WIN32
+		if (CreateDirectoryA(dirPath.c_str(), NULL)) {
+			return true;
+		}
+		DWORD attributes = GetFileAttributesA(dirPath.c_str());
+		return attributes != INVALID_FILE_ATTRIBUTES
+		       && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+		struct stat st;
+		return mkdir(dirPath.c_str(), 0755) == 0
+		       || (stat(dirPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode));
+#endif
+	}
+
 	using StringCombineFunction =
 	    std::function < std::string(const std::string&, const std::string&) >;
 
@@ -136,8 +265,12 @@ namespace winfs {
 	        StringCombineFunction func =
 	            /* 实现默认行为 */
 	            [](const std::string& a, const std::string& b)
-	            -> std::string {return a + "\\" + b;}
+	            -> std::string {return a + PATH_SEP + b;}
 	                                            ) {
+		// 创建一个 vector 存储所有的文件路径
+		std::vector<std::string> inFiles;
+
+#ifdef _WIN32
 		// 构造查找模式
 		std::string searchPattern;
 		// 根据末尾字符采用不同方法拼接
@@ -154,9 +287,6 @@ namespace winfs {
 			                       ForwardSlash_Regex, "\n");
 		}
 
-		// 创建一个 vector 存储所有的文件路径
-		std::vector<std::string> inFiles;
-
 		// 初始化 FindFile 搜索句柄
 		HANDLE hFind = INVALID_HANDLE_VALUE;
 		WIN32_FIND_DATAA findData;
@@ -178,6 +308,32 @@ namespace winfs {
 		} else {
 			throw std::runtime_error("路径无效或指定路径下无任何测试集文件！");
 		}
+#else
+		// 逐项读取目录，用通配符匹配文件名
+		DIR* dir = opendir(directoryPath.c_str());
+		if (dir == NULL) {
+			throw std::runtime_error("路径无效或指定路径下无任何测试集文件！");
+		}
+		bool isFound = false;
+		while (dirent* entry = readdir(dir)) {
+			std::string fileName = entry->d_name;
+			if (fileName == "." || fileName == ".."
+			        || fnmatch(searchFileName.c_str(), fileName.c_str(), 0) != 0) {
+				continue;
+			}
+			isFound = true;
+			// 调用func获取最终压入的字符串
+			std::string finalPath = func(directoryPath, fileName);
+			if (!finalPath.empty()) {
+				// 非空才压入
+				inFiles.push_back(finalPath);
+			}
+		}
+		closedir(dir);
+		if (!isFound) {
+			throw std::runtime_error("路径无效或指定路径下无任何测试集文件！");
+		}
+#endif
 
 		return inFiles;
 	}
@@ -187,12 +343,20 @@ namespace winfs {
 	// 获取当前进程的EXE路径
 	const std::string& getCurEXEPath() {
 		if (curEXEPath.empty()) {
+#ifdef _WIN32
 			curEXEPath.assign(_pgmptr);
+#else
+			char pathBuffer[4096];
+			ssize_t len = readlink("/proc/self/exe", pathBuffer, sizeof(pathBuffer) - 1);
+			if (len > 0) {
+				curEXEPath.assign(pathBuffer, len);
+			}
+#endif
 		}
 		return curEXEPath;
 	}
 
-	// 获取当前进程的EXE所在目录路径，不以\结尾
+	// 获取当前进程的EXE所在目录路径，不以路径分隔符结尾
 	const std::string& getCurEXEParentDirectoryPath() {
 		if (curEXEParentDirectoryPath.empty()) {
 			curEXEParentDirectoryPath.assign(getFilesParentDirectory(getCurEXEPath()));